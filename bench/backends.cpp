@@ -0,0 +1,90 @@
+/// Throughput of the arithmetic of the native and limb backends, to choose
+/// the backend for the widths in use. Without native integers, the limb
+/// backend is compared to plain limb arrays.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "apintext/aliases.hpp"
+#include "common/random.hpp"
+
+using namespace apintext;
+using test::next;
+
+namespace {
+#ifdef APINTEXT_NATIVE_INT
+using Reference = NativeBackend;
+constexpr char const* referenceName = "native ns";
+#else
+struct Reference {
+  template <uint32_t w, bool s> using repr = LimbInt<w, s>;
+};
+constexpr char const* referenceName = "array ns";
+#endif
+
+constexpr std::size_t count = 1 << 12;
+constexpr int rounds = 64;
+
+template <uint32_t w, typename B> std::vector<ap_repr<w, false, B>> inputs() {
+  using repr_t = ap_repr<w, false, B>;
+  std::vector<repr_t> res(count);
+  for (auto& value : res) {
+    value = repr_t { 0 };
+    for (uint32_t i = 0; i < (w + 63) / 64; ++i) {
+      if constexpr (w > 64)
+        value = value << 64;
+      value = value | static_cast<repr_t>(next());
+    }
+    // Nonzero divisors
+    value = value | repr_t { 1 };
+  }
+  return res;
+}
+
+/// Nanoseconds per operation
+template <typename T, typename Op>
+double measure(std::vector<T> const& a, std::vector<T> const& b, Op op) {
+  T acc { 0 };
+  auto const start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    for (std::size_t i = 0; i < count; ++i)
+      acc = acc ^ op(a[i], b[(i + r) % count]);
+  auto const stop = std::chrono::steady_clock::now();
+  // Keep the computation alive
+  volatile bool sink = (acc == T { 0 });
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+         (count * rounds);
+}
+
+template <uint32_t w, typename Op>
+void row(char const* name, Op op) {
+  auto const na = inputs<w, Reference>();
+  auto const nb = inputs<w, Reference>();
+  auto const la = inputs<w, LimbBackend>();
+  auto const lb = inputs<w, LimbBackend>();
+  std::printf("%6u %4s %10.2f %10.2f\n", w, name, measure(na, nb, op),
+              measure(la, lb, op));
+}
+
+template <uint32_t w> void widthRows() {
+  row<w>("add", [](auto const& a, auto const& b) { return a + b; });
+  row<w>("mul", [](auto const& a, auto const& b) { return a * b; });
+  row<w>("div", [](auto const& a, auto const& b) { return a / b; });
+  row<w>("shl", [](auto const& a, auto const& b) {
+    return a << static_cast<uint32_t>(b) % w;
+  });
+}
+} // namespace
+
+int main() {
+  std::printf("%6s %4s %10s %10s\n", "width", "op", referenceName, "limb ns");
+  widthRows<64>();
+  widthRows<128>();
+  widthRows<256>();
+  widthRows<512>();
+  widthRows<1024>();
+  return 0;
+}
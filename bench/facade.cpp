@@ -0,0 +1,117 @@
+/// Cost of the ap_int facade compared to the same computations written with
+/// plain values and expressions. Both columns should be about the same, the
+/// facade lowering to the same expression nodes.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "apintext/ap_int.hpp"
+#include "common/random.hpp"
+
+using namespace apintext;
+using compat::ap_int;
+using compat::ap_uint;
+
+namespace {
+constexpr std::size_t count = 1 << 12;
+constexpr int rounds = 256;
+
+template <uint32_t w> std::vector<Value<w, false>> inputs() {
+  std::vector<Value<w, false>> res(count);
+  for (auto& value : res)
+    value = test::uniformValue<w, false>();
+  return res;
+}
+
+/// Nanoseconds per element of op(a[i], b[i]), which updates a[i]
+template <typename T, typename Op>
+double measure(std::vector<T> a, std::vector<T> const& b, Op op) {
+  auto const start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    for (std::size_t i = 0; i < count; ++i)
+      op(a[i], b[(i + r) % count]);
+  auto const stop = std::chrono::steady_clock::now();
+  // Keep the computation alive
+  bool acc = false;
+  for (auto const& value : a)
+    acc ^= (value.compute() == res_t<T> { 0 });
+  volatile bool sink = acc;
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+         (count * rounds);
+}
+
+template <uint32_t w, typename FacadeOp, typename ValueOp>
+void row(char const* name, FacadeOp facadeOp, ValueOp valueOp) {
+  auto const a = inputs<w>();
+  auto const b = inputs<w>();
+  std::vector<ap_uint<w>> const fa(a.begin(), a.end());
+  std::vector<ap_uint<w>> const fb(b.begin(), b.end());
+  std::printf("%6u %8s %10.2f %10.2f\n", w, name,
+              measure(fa, fb, facadeOp), measure(a, b, valueOp));
+}
+
+template <uint32_t w> void widthRows() {
+  constexpr int hi = w - 5;
+  constexpr int lo = w / 3;
+  using field_t = Value<hi - lo + 1, false>;
+  row<w>(
+      "arith",
+      [](auto& a, auto const& b) {
+        a = a * ap_uint<16> { b } + (b >> 3);
+      },
+      [](auto& a, auto const& b) {
+        // Intermediate results are stored as the facade does
+        Value<w + 16, false> const prod = a * Value<16, false> { b };
+        Value<w, false> const shifted { b.compute() >> 3 };
+        a = prod + shifted;
+      });
+  row<w>(
+      "slice",
+      [](auto& a, auto const& b) {
+        a.template range<hi, lo>() =
+            a.template range<hi, lo>() + b.template range<hi, lo>();
+      },
+      [](auto& a, auto const& b) {
+        // Read-modify-write of the field, as the facade does
+        field_t const sum = slice<hi, lo>(a) + slice<hi, lo>(b);
+        constexpr auto mask = ~(~res_t<Value<w, false>> { 0 } << (hi - lo + 1))
+                              << lo;
+        auto const shifted = res_t<Value<w, false>> {
+          Value<w, false> { sum }.compute() } << lo;
+        a = Value<w, false> { (a.compute() & ~mask) | (shifted & mask) };
+      });
+  row<w>(
+      "bits",
+      [](auto& a, auto const& b) {
+        a.template bit<3>() = b.template bit<7>() ^ a.template bit<w - 1>();
+      },
+      [](auto& a, auto const& b) {
+        constexpr auto mask = res_t<Value<w, false>> { 1 } << 3;
+        bool const bit = (getBit<7>(b) ^ getBit<w - 1>(a)).compute() != 0;
+        a = Value<w, false> { bit ? (a.compute() | mask)
+                                  : (a.compute() & ~mask) };
+      });
+  row<w>(
+      "reduce",
+      [](auto& a, auto const& b) {
+        a.template bit<0>() = b.template range<hi, lo>().xor_reduce();
+      },
+      [](auto& a, auto const& b) {
+        using repr_t = res_t<Value<w, false>>;
+        bool const bit = xorReduce(slice<hi, lo>(b)).compute() != 0;
+        a = Value<w, false> { (a.compute() & ~repr_t { 1 }) |
+                              repr_t { bit ? 1 : 0 } };
+      });
+}
+} // namespace
+
+int main() {
+  std::printf("%6s %8s %10s %10s\n", "width", "op", "facade ns", "value ns");
+  widthRows<48>();
+  widthRows<128>();
+  widthRows<200>();
+  return 0;
+}
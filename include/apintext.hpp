@@ -1,7 +1,27 @@
 #ifndef APINTEXT_HPP
 #define APINTEXT_HPP
 #include "apintext/aliases.hpp"
+#include "apintext/ap_int.hpp"
 #include "apintext/arith_prop.hpp"
+#include "apintext/batch.hpp"
+#include "apintext/bitslice.hpp"
+#include "apintext/charconv.hpp"
+#include "apintext/constant_time.hpp"
+#include "apintext/cost.hpp"
+#include "apintext/dataflow.hpp"
+#include "apintext/dyn_int.hpp"
 #include "apintext/expression.hpp"
+#include "apintext/float.hpp"
+#include "apintext/gf2.hpp"
+#include "apintext/incremental.hpp"
+#include "apintext/newton.hpp"
+#include "apintext/parallel.hpp"
+#include "apintext/random.hpp"
+#include "apintext/select.hpp"
+#include "apintext/serialization.hpp"
+#include "apintext/sort.hpp"
+#include "apintext/table.hpp"
+#include "apintext/traversal.hpp"
 #include "apintext/value.hpp"
+#include "apintext/verification.hpp"
 #endif
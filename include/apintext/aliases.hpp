@@ -4,9 +4,59 @@
 #include <cstdint>
 #include <type_traits>
 
+#include "limb_int.hpp"
+
+/// Spelling of the native arbitrary width integers, if the compiler has
+/// them: _BitInt for recent clang, _ExtInt for older ones. Clang 14 and 15
+/// cap _BitInt at 128 bits on most targets, while their deprecated _ExtInt
+/// still accepts any width, so _ExtInt is kept in that case. GCC only
+/// provides _BitInt in C.
+#if defined(__clang__) && defined(__BITINT_MAXWIDTH__) &&                      \
+    __BITINT_MAXWIDTH__ > 128
+#define APINTEXT_NATIVE_INT(width) _BitInt(width)
+#define APINTEXT_NATIVE_MAXWIDTH __BITINT_MAXWIDTH__
+#elif defined(__clang__)
+#define APINTEXT_NATIVE_INT(width) _ExtInt(width)
+#define APINTEXT_NATIVE_MAXWIDTH 16777215
+#endif
+
 namespace apintext {
-template <uint32_t width, bool signedness>
-using ap_repr = typename std::conditional<signedness, signed _ExtInt(width),
-                                          unsigned _ExtInt(width)>::type;
+#ifdef APINTEXT_NATIVE_INT
+/// Representation of the values as native integers, whose arithmetic is
+/// lowered by the compiler
+struct NativeBackend {
+  template <uint32_t width, bool signedness>
+  using repr =
+      typename std::conditional<signedness,
+                                signed APINTEXT_NATIVE_INT(width),
+                                unsigned APINTEXT_NATIVE_INT(width)>::type;
+};
+#endif
+
+/// Representation of the values as machine words up to 128 bits, and as
+/// arrays of 64-bit limbs above, whose arithmetic is implemented by the
+/// limb kernels
+struct LimbBackend {
+  template <uint32_t width, bool signedness>
+  using repr = std::conditional_t<(width <= 128), SmallInt<width, signedness>,
+                                  LimbInt<width, signedness>>;
+};
+
+/// The backend used by the values is chosen by defining APINTEXT_BACKEND
+/// to one of the backend policies before including the library. It
+/// defaults to the native integers when they can be wider than 128 bits,
+/// and to the limbs otherwise.
+#ifndef APINTEXT_BACKEND
+#if defined(APINTEXT_NATIVE_INT) && APINTEXT_NATIVE_MAXWIDTH > 128
+#define APINTEXT_BACKEND NativeBackend
+#else
+#define APINTEXT_BACKEND LimbBackend
+#endif
+#endif
+
+using DefaultBackend = APINTEXT_BACKEND;
+
+template <uint32_t width, bool signedness, typename Backend = DefaultBackend>
+using ap_repr = typename Backend::template repr<width, signedness>;
 } // namespace apintext
 #endif
@@ -0,0 +1,690 @@
+#ifndef AP_INT_HPP
+#define AP_INT_HPP
+
+#include <bit>
+#include <cassert>
+#include <charconv>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "aliases.hpp"
+#include "charconv.hpp"
+#include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
+#include "value.hpp"
+
+namespace apintext {
+/// Replacement for the ap_int / ap_uint types of the Xilinx HLS headers,
+/// built on the expression nodes of this library.
+///
+/// Operators between facade types and integers return facade values in the
+/// format of the corresponding expression (widths grow as needed, e.g.
+/// ap_int<8> + ap_uint<8> is an ap_int<10>), and assigning them to
+/// narrower values truncates, as with the vendor types. Bit and range
+/// selections return proxies which can be read, assigned and used as
+/// operands, which read them by value. range<hi, lo>() and bit<idx>()
+/// select bits known at compile time, with the width of the selection.
+/// Unlike the vendor types, strings too wide for the format throw
+/// std::out_of_range and negative strings given to ap_uint throw
+/// std::invalid_argument, instead of wrapping around.
+/// Defining APINTEXT_AP_INT_GLOBAL exports ap_int and ap_uint in the global
+/// namespace.
+namespace compat {
+template <int W, bool S> class ApInt;
+template <int W, bool S> class ApBitRef;
+template <int W, bool S> class ApRangeRef;
+template <int Hi, int Lo, int W, bool S> class ApSliceRef;
+
+template <int W> using ap_int = ApInt<W, true>;
+template <int W> using ap_uint = ApInt<W, false>;
+
+namespace detail {
+template <typename T> struct IsFacade : std::false_type {};
+template <int W, bool S> struct IsFacade<ApInt<W, S>> : std::true_type {};
+template <int W, bool S> struct IsFacade<ApBitRef<W, S>> : std::true_type {};
+template <int W, bool S>
+struct IsFacade<ApRangeRef<W, S>> : std::true_type {};
+template <int Hi, int Lo, int W, bool S>
+struct IsFacade<ApSliceRef<Hi, Lo, W, S>> : std::true_type {};
+} // namespace detail
+
+template <typename T>
+concept FacadeType = detail::IsFacade<T>::value;
+
+/// Operands accepted by the operators of the facade types
+template <typename T>
+concept FacadeOperand = FacadeType<T> || std::integral<T>;
+
+namespace detail {
+template <FacadeOperand T> constexpr auto asExpr(T const& operand) {
+  if constexpr (std::same_as<T, bool>) {
+    return ConstantExpr<1, false> { static_cast<ap_repr<1, false>>(operand) };
+  } else if constexpr (std::integral<T>) {
+    return toExpr(operand);
+  } else if constexpr (requires { operand.expr(); }) {
+    // Proxies are read by value, so that they are not captured
+    return operand.expr();
+  } else {
+    return operand;
+  }
+}
+
+template <typename T> using expr_t = decltype(asExpr(std::declval<T>()));
+
+template <template <ExprType, ExprType> class Node, typename L, typename R>
+constexpr auto arithmetic(L const& lhs, R const& rhs) {
+  using node_t = Node<expr_t<L>, expr_t<R>>;
+  return ApInt<static_cast<int>(node_t::width), node_t::signedness> {
+    node_t { asExpr(lhs), asExpr(rhs) }
+  };
+}
+
+/// Bitwise operations are performed on the bits of the operands extended
+/// to the smallest format holding both
+template <typename Operation, typename L, typename R>
+constexpr auto bitwise(L const& lhs, R const& rhs) {
+  using format = TightOverset<expr_t<L>, expr_t<R>>;
+  using operand_t = Value<format::width, false>;
+  return ApInt<static_cast<int>(format::width), format::signedness> {
+    BitwiseLogicExpr<operand_t, operand_t, Operation> {
+        operand_t { asExpr(lhs) }, operand_t { asExpr(rhs) } }
+  };
+}
+
+constexpr uint64_t reverseBits(uint64_t x) {
+  x = ((x >> 1) & 0x5555555555555555) | ((x & 0x5555555555555555) << 1);
+  x = ((x >> 2) & 0x3333333333333333) | ((x & 0x3333333333333333) << 2);
+  x = ((x >> 4) & 0x0F0F0F0F0F0F0F0F) | ((x & 0x0F0F0F0F0F0F0F0F) << 4);
+  return __builtin_bswap64(x);
+}
+} // namespace detail
+
+/// Operators of the facade types. They are hidden friends of each type, so
+/// that they are preferred to the generic expression operators, and return
+/// facade values.
+///
+/// Operations whose left operand is a facade type are defined by this type,
+/// the others (integer on the left) by the type of the right operand.
+template <typename Self> struct FacadeOperators {
+  template <FacadeOperand R>
+  friend constexpr auto operator+(Self const& lhs, R const& rhs) {
+    return detail::arithmetic<ExprSum>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator+(L const& lhs, Self const& rhs) {
+    return detail::arithmetic<ExprSum>(lhs, rhs);
+  }
+
+  template <FacadeOperand R>
+  friend constexpr auto operator-(Self const& lhs, R const& rhs) {
+    return detail::arithmetic<ExprSub>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator-(L const& lhs, Self const& rhs) {
+    return detail::arithmetic<ExprSub>(lhs, rhs);
+  }
+
+  template <FacadeOperand R>
+  friend constexpr auto operator*(Self const& lhs, R const& rhs) {
+    return detail::arithmetic<ExprProd>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator*(L const& lhs, Self const& rhs) {
+    return detail::arithmetic<ExprProd>(lhs, rhs);
+  }
+
+  template <FacadeOperand R>
+  friend constexpr auto operator/(Self const& lhs, R const& rhs) {
+    return detail::arithmetic<ExprDiv>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator/(L const& lhs, Self const& rhs) {
+    return detail::arithmetic<ExprDiv>(lhs, rhs);
+  }
+
+  template <FacadeOperand R>
+  friend constexpr auto operator%(Self const& lhs, R const& rhs) {
+    return detail::arithmetic<ExprMod>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator%(L const& lhs, Self const& rhs) {
+    return detail::arithmetic<ExprMod>(lhs, rhs);
+  }
+
+  template <FacadeOperand R>
+  friend constexpr auto operator&(Self const& lhs, R const& rhs) {
+    return detail::bitwise<BitwiseAND>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator&(L const& lhs, Self const& rhs) {
+    return detail::bitwise<BitwiseAND>(lhs, rhs);
+  }
+
+  template <FacadeOperand R>
+  friend constexpr auto operator|(Self const& lhs, R const& rhs) {
+    return detail::bitwise<BitwiseOR>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator|(L const& lhs, Self const& rhs) {
+    return detail::bitwise<BitwiseOR>(lhs, rhs);
+  }
+
+  template <FacadeOperand R>
+  friend constexpr auto operator^(Self const& lhs, R const& rhs) {
+    return detail::bitwise<BitwiseXOR>(lhs, rhs);
+  }
+  template <std::integral L>
+  friend constexpr auto operator^(L const& lhs, Self const& rhs) {
+    return detail::bitwise<BitwiseXOR>(lhs, rhs);
+  }
+
+  /// Other comparisons are rewritten from these two
+  template <FacadeOperand R>
+  friend constexpr bool operator==(Self const& lhs, R const& rhs) {
+    return apintext::operator==(detail::asExpr(lhs), detail::asExpr(rhs));
+  }
+  template <FacadeOperand R>
+  friend constexpr auto operator<=>(Self const& lhs, R const& rhs) {
+    return apintext::operator<=>(detail::asExpr(lhs), detail::asExpr(rhs));
+  }
+};
+
+/// Proxy for a single bit of an ApInt, as returned by operator[], which
+/// reads the bit through a DynGetBitExpr
+template <int W, bool S>
+class ApBitRef : public FacadeOperators<ApBitRef<W, S>> {
+ public:
+  static constexpr uint32_t width = 1;
+  static constexpr bool signedness = false;
+
+ private:
+  ApInt<W, S>* owner;
+  int idx;
+
+ public:
+  constexpr ApBitRef(ApInt<W, S>& owner, int idx)
+      : owner { &owner }
+      , idx { idx } {}
+  constexpr ApBitRef(ApBitRef const&) = default;
+
+  /// The bit read by value, for expressions which outlive the proxy
+  constexpr auto expr() const {
+    return dynGetBit(*owner, static_cast<uint32_t>(idx));
+  }
+  constexpr ap_repr<1, false> compute() const { return expr().compute(); }
+
+  constexpr operator bool() const { return get(); }
+  constexpr bool get() const { return compute() != ap_repr<1, false> { 0 }; }
+  constexpr bool operator~() const { return !get(); }
+  constexpr bool operator!() const { return !get(); }
+  constexpr void flip() { owner->invert(idx); }
+
+  /// The bit is set when the assigned value is not null
+  template <FacadeOperand T> constexpr ApBitRef& operator=(T const& val) {
+    auto const expr = detail::asExpr(val);
+    owner->set_bit(idx, expr.compute() != res_t<decltype(expr)> { 0 });
+    return *this;
+  }
+  constexpr ApBitRef& operator=(ApBitRef const& other) {
+    return *this = other.get();
+  }
+};
+
+/// Proxy for the bits [lo, hi] of an ApInt selected at runtime, as returned
+/// by range(hi, lo). The length of the range is only known at runtime, so
+/// it reads as an unsigned value of the width of the ApInt, through a
+/// DynSliceExpr whose bits above the range are cleared.
+template <int W, bool S>
+class ApRangeRef : public FacadeOperators<ApRangeRef<W, S>> {
+ public:
+  static constexpr uint32_t width = W;
+  static constexpr bool signedness = false;
+
+ private:
+  ApInt<W, S>* owner;
+  int hi;
+  int lo;
+
+ public:
+  constexpr ApRangeRef(ApInt<W, S>& owner, int hi, int lo)
+      : owner { &owner }
+      , hi { hi }
+      , lo { lo } {
+    assert(0 <= lo && lo <= hi && hi < W);
+  }
+  constexpr ApRangeRef(ApRangeRef const&) = default;
+
+  /// The selected bits read by value, for expressions which outlive the
+  /// proxy
+  constexpr auto expr() const {
+    return ApInt<W, false> { compute() };
+  }
+  constexpr ap_repr<W, false> compute() const {
+    return dynSlice<W>(*owner, static_cast<uint32_t>(lo)).compute() &
+           ApInt<W, S>::lowMask(length());
+  }
+
+  constexpr int length() const { return hi - lo + 1; }
+
+  template <FacadeOperand T> constexpr ApRangeRef& operator=(T const& val) {
+    owner->setRange(hi, lo, Value<W, false> { detail::asExpr(val) }.compute());
+    return *this;
+  }
+  constexpr ApRangeRef& operator=(ApRangeRef const& other) {
+    owner->setRange(hi, lo, other.compute());
+    return *this;
+  }
+
+  constexpr int to_int() const { return getAs<int>(*this); }
+  constexpr unsigned to_uint() const { return getAs<unsigned>(*this); }
+  constexpr int64_t to_int64() const { return getAs<int64_t>(*this); }
+  constexpr uint64_t to_uint64() const { return getAs<uint64_t>(*this); }
+  constexpr bool and_reduce() const {
+    // Only the selected bits are considered
+    return compute() == ApInt<W, S>::lowMask(length());
+  }
+  constexpr bool or_reduce() const { return orReduce(*this).compute() != 0; }
+  constexpr bool xor_reduce() const { return xorReduce(*this).compute() != 0; }
+};
+
+/// Proxy for the bits [Lo, Hi] of an ApInt selected at compile time, as
+/// returned by range<Hi, Lo>() and bit<Idx>(). It reads as an unsigned
+/// value of Hi - Lo + 1 bits through a SliceExpr (a GetBitExpr for single
+/// bits), so that it lowers like the slice of a plain Value.
+template <int Hi, int Lo, int W, bool S>
+class ApSliceRef : public FacadeOperators<ApSliceRef<Hi, Lo, W, S>> {
+  static_assert(0 <= Lo && Lo <= Hi && Hi < W, "Slice out of ap_int bounds");
+
+ public:
+  static constexpr uint32_t width = Hi - Lo + 1;
+  static constexpr bool signedness = false;
+
+ private:
+  ApInt<W, S>* owner;
+
+ public:
+  constexpr ApSliceRef(ApInt<W, S>& owner)
+      : owner { &owner } {}
+  constexpr ApSliceRef(ApSliceRef const&) = default;
+
+  /// The selected bits read by value, for expressions which outlive the
+  /// proxy
+  constexpr auto expr() const {
+    if constexpr (Hi == Lo)
+      return getBit<Lo>(*owner);
+    else
+      return slice<Hi, Lo>(*owner);
+  }
+  constexpr ap_repr<width, false> compute() const { return expr().compute(); }
+
+  static constexpr int length() { return width; }
+
+  template <FacadeOperand T> constexpr ApSliceRef& operator=(T const& val) {
+    owner->template setSlice<Hi, Lo>(
+        Value<width, false> { detail::asExpr(val) }.compute());
+    return *this;
+  }
+  constexpr ApSliceRef& operator=(ApSliceRef const& other) {
+    owner->template setSlice<Hi, Lo>(other.compute());
+    return *this;
+  }
+
+  constexpr int to_int() const { return getAs<int>(expr()); }
+  constexpr unsigned to_uint() const { return getAs<unsigned>(expr()); }
+  constexpr int64_t to_int64() const { return getAs<int64_t>(expr()); }
+  constexpr uint64_t to_uint64() const { return getAs<uint64_t>(expr()); }
+  constexpr bool and_reduce() const {
+    return andReduce(expr()).compute() != 0;
+  }
+  constexpr bool or_reduce() const { return orReduce(expr()).compute() != 0; }
+  constexpr bool xor_reduce() const {
+    return xorReduce(expr()).compute() != 0;
+  }
+};
+
+template <int W, bool S> class ApInt : public FacadeOperators<ApInt<W, S>> {
+  static_assert(W > 0, "ap_int width should be positive");
+
+ public:
+  static constexpr uint32_t width = W;
+  static constexpr bool signedness = S;
+
+ private:
+  using repr_t = ap_repr<W, S>;
+  using bits_t = ap_repr<W, false>;
+  repr_t repr;
+
+  friend class ApBitRef<W, S>;
+  friend class ApRangeRef<W, S>;
+  template <int, int, int, bool> friend class ApSliceRef;
+
+  constexpr bits_t bits() const { return static_cast<bits_t>(repr); }
+  constexpr void setBits(bits_t const& newBits) {
+    repr = static_cast<repr_t>(newBits);
+  }
+
+  /// length ones in the low bits
+  static constexpr bits_t lowMask(int length) {
+    constexpr bits_t allOnes = ~bits_t { 0 };
+    return (length >= W) ? allOnes : ~(allOnes << length);
+  }
+
+  constexpr bits_t getRange(int hi, int lo) const {
+    return (bits() >> lo) & lowMask(hi - lo + 1);
+  }
+
+  constexpr void setRange(int hi, int lo, bits_t const& src) {
+    bits_t const mask = lowMask(hi - lo + 1) << lo;
+    setBits((bits() & ~mask) | ((src << lo) & mask));
+  }
+
+  template <int Hi, int Lo>
+  constexpr void setSlice(ap_repr<Hi - Lo + 1, false> const& src) {
+    setRange(Hi, Lo, Value<W, false> { Value<Hi - Lo + 1, false> { src } }
+                         .compute());
+  }
+
+  constexpr ApInt shiftedLeft(int64_t shift) const {
+    if (shift < 0)
+      return shiftedRight(-shift);
+    return ApInt { static_cast<repr_t>((shift >= W) ? bits_t { 0 }
+                                                    : bits() << shift) };
+  }
+
+  constexpr ApInt shiftedRight(int64_t shift) const {
+    if (shift < 0)
+      return shiftedLeft(-shift);
+    if (shift >= W)
+      return ApInt { S ? repr_t { repr >> (W - 1) } : repr_t { 0 } };
+    return ApInt { static_cast<repr_t>(repr >> shift) };
+  }
+
+ public:
+  constexpr ApInt()
+      : repr { 0 } {}
+
+  constexpr ApInt(repr_t const& src_repr)
+      : repr { src_repr } {}
+
+  /// Conversion from other facade values and expressions, truncated or
+  /// extended according to the signedness of the source
+  template <ExprType ET>
+  constexpr ApInt(ET const& expr)
+      : repr { Value<W, S> { expr }.compute() } {}
+
+  template <std::integral I>
+  constexpr ApInt(I const& val)
+      : ApInt { detail::asExpr(val) } {}
+
+  /// Parse a number with an optional sign and 0b, 0o or 0x prefix.
+  /// Values too wide for W bits throw std::out_of_range, instead of being
+  /// truncated as by the vendor headers, and negative values of unsigned
+  /// formats std::invalid_argument.
+  ApInt(char const* str, int radix = 10) {
+    std::string_view text { str };
+    bool const negative = !text.empty() && text.front() == '-';
+    if (negative)
+      text.remove_prefix(1);
+    if (text.size() > 2 && text[0] == '0') {
+      int const prefixRadix = (text[1] == 'b' || text[1] == 'B')   ? 2
+                              : (text[1] == 'o' || text[1] == 'O') ? 8
+                              : (text[1] == 'x' || text[1] == 'X') ? 16
+                                                                   : 0;
+      if (prefixRadix != 0) {
+        radix = prefixRadix;
+        text.remove_prefix(2);
+      }
+    }
+    // The sign is put back before the digits, for from_chars to check the
+    // range of the signed value and reject negative unsigned ones
+    std::string digits;
+    digits.reserve(text.size() + 1);
+    if (negative)
+      digits.push_back('-');
+    digits.append(text);
+    Value<W, S> value;
+    auto const res = from_chars(digits.data(), digits.data() + digits.size(),
+                                value, radix);
+    if (res.ec == std::errc::result_out_of_range)
+      throw std::out_of_range("Number too wide for ap_int");
+    if (res.ec != std::errc {} || res.ptr != digits.data() + digits.size())
+      throw std::invalid_argument("Invalid ap_int string");
+    repr = value.compute();
+  }
+
+  constexpr repr_t compute() const { return repr; }
+  constexpr repr_t const& stored() const { return repr; }
+
+  constexpr int length() const { return W; }
+
+  //************** Arithmetic and logic in place ***************************//
+
+  template <FacadeOperand T> constexpr ApInt& operator+=(T const& rhs) {
+    return *this = *this + rhs;
+  }
+  template <FacadeOperand T> constexpr ApInt& operator-=(T const& rhs) {
+    return *this = *this - rhs;
+  }
+  template <FacadeOperand T> constexpr ApInt& operator*=(T const& rhs) {
+    return *this = *this * rhs;
+  }
+  template <FacadeOperand T> constexpr ApInt& operator/=(T const& rhs) {
+    return *this = *this / rhs;
+  }
+  template <FacadeOperand T> constexpr ApInt& operator%=(T const& rhs) {
+    return *this = *this % rhs;
+  }
+  template <FacadeOperand T> constexpr ApInt& operator&=(T const& rhs) {
+    return *this = *this & rhs;
+  }
+  template <FacadeOperand T> constexpr ApInt& operator|=(T const& rhs) {
+    return *this = *this | rhs;
+  }
+  template <FacadeOperand T> constexpr ApInt& operator^=(T const& rhs) {
+    return *this = *this ^ rhs;
+  }
+
+  constexpr ApInt& operator++() { return *this += 1; }
+  constexpr ApInt& operator--() { return *this -= 1; }
+  constexpr ApInt operator++(int) {
+    ApInt const res { *this };
+    ++*this;
+    return res;
+  }
+  constexpr ApInt operator--(int) {
+    ApInt const res { *this };
+    --*this;
+    return res;
+  }
+
+  constexpr ApInt operator+() const { return *this; }
+  constexpr ApInt<W + 1, true> operator-() const {
+    using wide_t = ap_repr<W + 1, true>;
+    return ApInt<W + 1, true> { static_cast<wide_t>(
+        -Value<W + 1, true> { *this }.compute()) };
+  }
+  constexpr ApInt operator~() const {
+    return ApInt { static_cast<repr_t>(~bits()) };
+  }
+  constexpr bool operator!() const { return repr == repr_t { 0 }; }
+
+  //************** Shifts, keeping the width *******************************//
+
+  /// Shifts by a negative amount shift in the other direction
+  template <std::integral I> constexpr ApInt operator<<(I shift) const {
+    return shiftedLeft(static_cast<int64_t>(shift));
+  }
+  template <std::integral I> constexpr ApInt operator>>(I shift) const {
+    return shiftedRight(static_cast<int64_t>(shift));
+  }
+  template <int W2, bool S2>
+  constexpr ApInt operator<<(ApInt<W2, S2> const& shift) const {
+    return shiftedLeft(shift.to_int64());
+  }
+  template <int W2, bool S2>
+  constexpr ApInt operator>>(ApInt<W2, S2> const& shift) const {
+    return shiftedRight(shift.to_int64());
+  }
+  template <typename T> constexpr ApInt& operator<<=(T const& shift) {
+    return *this = *this << shift;
+  }
+  template <typename T> constexpr ApInt& operator>>=(T const& shift) {
+    return *this = *this >> shift;
+  }
+
+  //************** Bit and range selection *********************************//
+
+  constexpr ApBitRef<W, S> operator[](int idx) {
+    assert(0 <= idx && idx < W);
+    return { *this, idx };
+  }
+  constexpr bool operator[](int idx) const { return get_bit(idx); }
+
+  constexpr ApRangeRef<W, S> range(int hi, int lo) {
+    return { *this, hi, lo };
+  }
+  constexpr ApRangeRef<W, S> range() { return { *this, W - 1, 0 }; }
+  constexpr ApRangeRef<W, S> operator()(int hi, int lo) {
+    return range(hi, lo);
+  }
+  constexpr ApInt<W, false> range(int hi, int lo) const {
+    assert(0 <= lo && lo <= hi && hi < W);
+    return ApInt<W, false> { getRange(hi, lo) };
+  }
+  constexpr ApInt<W, false> range() const { return range(W - 1, 0); }
+  constexpr ApInt<W, false> operator()(int hi, int lo) const {
+    return range(hi, lo);
+  }
+
+  /// Selections with bounds known at compile time, of their exact width
+  template <int Hi, int Lo> constexpr ApSliceRef<Hi, Lo, W, S> range() {
+    return { *this };
+  }
+  template <int Hi, int Lo>
+  constexpr ApInt<Hi - Lo + 1, false> range() const {
+    return ApInt<Hi - Lo + 1, false> { slice<Hi, Lo>(*this) };
+  }
+  template <int Idx> constexpr ApSliceRef<Idx, Idx, W, S> bit() {
+    return { *this };
+  }
+  template <int Idx> constexpr bool bit() const {
+    return getBit<Idx>(*this).compute() != ap_repr<1, false> { 0 };
+  }
+
+  constexpr bool get_bit(int idx) const {
+    return ((bits() >> idx) & bits_t { 1 }) != bits_t { 0 };
+  }
+  constexpr bool test(int idx) const { return get_bit(idx); }
+  constexpr void set_bit(int idx, bool val) {
+    bits_t const mask = bits_t { 1 } << idx;
+    setBits(val ? (bits() | mask) : (bits() & ~mask));
+  }
+  constexpr void set(int idx) { set_bit(idx, true); }
+  constexpr void clear(int idx) { set_bit(idx, false); }
+  constexpr void invert(int idx) { setBits(bits() ^ (bits_t { 1 } << idx)); }
+  constexpr void b_not() { setBits(~bits()); }
+
+  constexpr void reverse() {
+    constexpr std::size_t N = apintext::detail::limbCount(W);
+    auto const limbs = apintext::detail::toLimbs<W>(bits());
+    apintext::detail::limbs_t<N> reversed;
+    for (std::size_t i = 0; i < N; ++i)
+      reversed[N - 1 - i] = detail::reverseBits(limbs[i]);
+    setBits(static_cast<bits_t>(
+        apintext::detail::fromLimbs<64 * N>(reversed) >> (64 * N - W)));
+  }
+
+  constexpr bool iszero() const { return repr == repr_t { 0 }; }
+  /// Sign bit of signed values, false for unsigned ones
+  constexpr bool sign() const { return S && get_bit(W - 1); }
+
+  constexpr int countLeadingZeros() const {
+    constexpr std::size_t N = apintext::detail::limbCount(W);
+    auto const limbs = apintext::detail::toLimbs<W>(bits());
+    int zeros = 0;
+    for (std::size_t i = N; i-- > 0;) {
+      zeros += std::countl_zero(limbs[i]);
+      if (limbs[i] != 0)
+        break;
+    }
+    return zeros - static_cast<int>(64 * N - W);
+  }
+
+  //************** Reductions **********************************************//
+
+  constexpr bool and_reduce() const { return andReduce(*this).compute() != 0; }
+  constexpr bool or_reduce() const { return orReduce(*this).compute() != 0; }
+  constexpr bool xor_reduce() const { return xorReduce(*this).compute() != 0; }
+  constexpr bool nand_reduce() const { return !and_reduce(); }
+  constexpr bool nor_reduce() const { return norReduce(*this).compute() != 0; }
+  constexpr bool xnor_reduce() const { return !xor_reduce(); }
+
+  //************** Conversions *********************************************//
+
+  /// Truncating conversion to the native integer of the same signedness
+  constexpr operator std::conditional_t<S, long long, unsigned long long>()
+      const {
+    return getAs<std::conditional_t<S, long long, unsigned long long>>(*this);
+  }
+
+  constexpr bool to_bool() const { return !iszero(); }
+  constexpr int to_int() const { return getAs<int>(*this); }
+  constexpr unsigned to_uint() const { return getAs<unsigned>(*this); }
+  constexpr long to_long() const { return getAs<long>(*this); }
+  constexpr unsigned long to_ulong() const {
+    return getAs<unsigned long>(*this);
+  }
+  constexpr int64_t to_int64() const { return getAs<int64_t>(*this); }
+  constexpr uint64_t to_uint64() const { return getAs<uint64_t>(*this); }
+
+  double to_double() const {
+    bool const negative = sign();
+    bits_t const magnitude = negative ? bits_t { ~bits() + bits_t { 1 } }
+                                      : bits();
+    auto const limbs = apintext::detail::toLimbs<W>(magnitude);
+    double res = 0;
+    for (std::size_t i = limbs.size(); i-- > 0;)
+      res = res * 0x1p64 + static_cast<double>(limbs[i]);
+    return negative ? -res : res;
+  }
+
+  /// Digits in radix, with a 0b, 0o or 0x prefix for radices 2, 8 and 16.
+  /// The bits are read as a signed value if sign is set.
+  std::string to_string(int radix = 2, bool sign = S) const {
+    std::string digits = sign ? toString(Value<W, true> { *this }, radix)
+                              : toString(Value<W, false> { *this }, radix);
+    std::string const prefix = (radix == 2)    ? "0b"
+                               : (radix == 8)  ? "0o"
+                               : (radix == 16) ? "0x"
+                                               : "";
+    std::size_t const prefixPos = (digits.front() == '-') ? 1 : 0;
+    return digits.insert(prefixPos, prefix);
+  }
+};
+
+/// Decimal output, or octal or hexadecimal according to the stream flags
+template <int W, bool S>
+std::ostream& operator<<(std::ostream& os, ApInt<W, S> const& val) {
+  auto const base = os.flags() & std::ios_base::basefield;
+  int const radix = (base == std::ios_base::hex)   ? 16
+                    : (base == std::ios_base::oct) ? 8
+                                                   : 10;
+  return os << toString(val, radix);
+}
+} // namespace compat
+} // namespace apintext
+
+#ifdef APINTEXT_AP_INT_GLOBAL
+using apintext::compat::ap_int;
+using apintext::compat::ap_uint;
+#endif
+
+#endif // AP_INT_HPP
@@ -4,30 +4,88 @@
 #include <cstdint>
 
 namespace apintext {
+/// Width and signedness of an expression, known at run time
+struct Format {
+  uint32_t width;
+  bool signedness;
+
+  friend constexpr bool operator==(Format const&, Format const&) = default;
+};
+
+/// Formats of the results of the arithmetic operations
+struct ArithmeticFormats {
+  Format prod;
+  Format sum;
+  Format div;
+  Format mod;
+};
+
+constexpr ArithmeticFormats arithmeticFormats(Format op1, Format op2) {
+  uint32_t const max = (op1.width > op2.width) ? op1.width : op2.width;
+  uint32_t const min = (op1.width > op2.width) ? op2.width : op1.width;
+  bool const sameSignedness = (op1.signedness == op2.signedness);
+  bool const oneIsOne = ((op1.width == 1) || (op2.width == 1));
+  bool const bothAreOne = ((op1.width == 1) && (op2.width == 1));
+  uint32_t const caseOneWidth =
+      (sameSignedness || bothAreOne) ? max : max + 1;
+  bool const oneSigned = op1.signedness or op2.signedness;
+  return {
+    { (oneIsOne) ? caseOneWidth : op1.width + op2.width,
+      (oneSigned and (!bothAreOne || !sameSignedness)) },
+    { max + 1, oneSigned },
+    { (op2.signedness) ? op1.width + 1 : op1.width, oneSigned },
+    { (op1.signedness) ? min + 1 : min, op1.signedness }
+  };
+}
+
+/// Format of the square of a value, which is never negative: a w-bit
+/// signed value squares to at most 2^(2w - 2)
+constexpr Format squareFormat(Format op) {
+  if (op.width == 1)
+    return { 1, false };
+  return { (op.signedness) ? 2 * op.width - 1 : 2 * op.width, false };
+}
+
+/// Format of the absolute value: signed values keep their signedness and
+/// gain a bit for the magnitude of the most negative one
+constexpr Format absFormat(Format op) {
+  return { (op.signedness) ? op.width + 1 : op.width, op.signedness };
+}
+
+/// Smallest format holding all the values of both formats
+constexpr Format tightOverset(Format op1, Format op2) {
+  uint32_t const max = (op1.width > op2.width) ? op1.width : op2.width;
+  bool const sameSignedness = op1.signedness == op2.signedness;
+  return { (sameSignedness) ? max : max + 1,
+           op1.signedness || op2.signedness };
+}
+
+/// Format in which the operands of a division or a modulo are adapted
+/// before computing the result, wide enough for the quotient not to
+/// overflow
+constexpr Format divisionFormat(Format op1, Format op2) {
+  Format const overset = tightOverset(op1, op2);
+  bool const bothSigned = op1.signedness && op2.signedness;
+  return { (bothSigned && (overset.width == op1.width)) ? overset.width + 1
+                                                        : overset.width,
+           overset.signedness };
+}
+
 template <uint32_t width1, uint32_t width2, bool signedness1, bool signedness2>
 class ArithmeticProp {
  private:
-  static constexpr uint32_t _generalProdWidth = width1 + width2;
-  static constexpr uint32_t _max = (width1 > width2) ? width1 : width2;
-  static constexpr uint32_t _min = (width1 > width2) ? width2 : width1;
-  static constexpr bool _sameSignedness = (signedness1 == signedness2);
-  static constexpr bool _oneIsOne = ((width1 == 1) || (width2 == 1));
-  static constexpr bool _bothAreOne = ((width1 == 1) && (width2 == 1));
-  static constexpr uint32_t _caseOneWidth =
-      (_sameSignedness || _bothAreOne) ? _max : _max + 1;
-  static constexpr bool _oneSigned = signedness1 or signedness2;
+  static constexpr ArithmeticFormats formats =
+      arithmeticFormats({ width1, signedness1 }, { width2, signedness2 });
 
  public:
-  static constexpr bool prodSigned =
-      (_oneSigned and (!_bothAreOne || !_sameSignedness));
-  static constexpr uint32_t prodWidth =
-      (_oneIsOne) ? _caseOneWidth : _generalProdWidth;
-  static constexpr bool sumSigned = _oneSigned;
-  static constexpr uint32_t sumWidth = _max + 1;
-  static constexpr uint32_t divWidth = (signedness2) ?  width1 + 1 : width1;
-  static constexpr bool divSigned = _oneSigned;
-  static constexpr uint32_t modWidth = (signedness1) ? _min + 1 : _min;
-  static constexpr bool modSigned = signedness1;
+  static constexpr bool prodSigned = formats.prod.signedness;
+  static constexpr uint32_t prodWidth = formats.prod.width;
+  static constexpr bool sumSigned = formats.sum.signedness;
+  static constexpr uint32_t sumWidth = formats.sum.width;
+  static constexpr uint32_t divWidth = formats.div.width;
+  static constexpr bool divSigned = formats.div.signedness;
+  static constexpr uint32_t modWidth = formats.mod.width;
+  static constexpr bool modSigned = formats.mod.signedness;
 };
 } // namespace apextint
 
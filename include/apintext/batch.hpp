@@ -0,0 +1,264 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "aliases.hpp"
+#include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "traversal.hpp"
+#include "value.hpp"
+
+namespace apintext {
+
+/// Expression leaf standing for the current element of the idx-th input of
+/// a batch evaluation.
+template <std::size_t idx, uint32_t w, bool s> class Placeholder {
+ public:
+  static constexpr std::size_t index = idx;
+  static constexpr uint32_t width = w;
+  static constexpr bool signedness = s;
+
+ private:
+  using val_t = ap_repr<w, s>;
+  val_t value;
+
+ public:
+  constexpr Placeholder()
+      : value { 0 } {}
+  constexpr Placeholder(val_t const& src_repr)
+      : value { src_repr } {}
+  constexpr val_t compute() const { return value; }
+};
+
+template <typename T> struct IsPlaceholder : std::false_type {};
+
+template <std::size_t idx, uint32_t w, bool s>
+struct IsPlaceholder<Placeholder<idx, w, s>> : std::true_type {};
+
+template <typename T>
+concept PlaceholderType = IsPlaceholder<T>::value;
+
+namespace detail {
+template <std::size_t idx, typename List> struct FindPlaceholder {
+  using type = void;
+};
+
+template <std::size_t idx, typename Head, typename... Tail>
+struct FindPlaceholder<idx, TypeList<Head, Tail...>> {
+ private:
+  using found_in_tail = typename FindPlaceholder<idx, TypeList<Tail...>>::type;
+  static constexpr bool match = [] {
+    if constexpr (PlaceholderType<Head>) {
+      return Head::index == idx;
+    } else {
+      return false;
+    }
+  }();
+  static_assert(!match || std::is_void_v<found_in_tail> ||
+                    std::is_same_v<found_in_tail, Head>,
+                "Placeholders sharing an index should have the same format");
+
+ public:
+  using type = std::conditional_t<match, Head, found_in_tail>;
+};
+
+template <typename List> struct PlaceholderCount;
+
+template <typename... Leaves> struct PlaceholderCount<TypeList<Leaves...>> {
+ private:
+  template <typename Leaf> static constexpr std::size_t countUpTo() {
+    if constexpr (PlaceholderType<Leaf>) {
+      return Leaf::index + 1;
+    } else {
+      return 0;
+    }
+  }
+
+ public:
+  static constexpr std::size_t value =
+      std::max<std::size_t>({ std::size_t { 0 }, countUpTo<Leaves>()... });
+};
+} // namespace detail
+
+/// One more than the largest placeholder index of an expression
+template <ExprType ET>
+constexpr std::size_t placeholderCount =
+    detail::PlaceholderCount<leaf_types_t<ET>>::value;
+
+/// Placeholder of index idx in an expression, void if there is none
+template <ExprType ET, std::size_t idx>
+using placeholder_t =
+    typename detail::FindPlaceholder<idx, leaf_types_t<ET>>::type;
+
+/// Bind each placeholder of shape to the input of the same index.
+/// Inputs can be anything a Value can be constructed from.
+template <ExprType ET, typename... Inputs>
+constexpr auto substitute(ET const& shape, Inputs const&... inputs) {
+  auto const values = std::tie(inputs...);
+  return transformLeaves(shape, [&values](auto const& leaf) {
+    using leaf_t = std::decay_t<decltype(leaf)>;
+    if constexpr (PlaceholderType<leaf_t>) {
+      static_assert(leaf_t::index < sizeof...(Inputs),
+                    "No input provided for placeholder");
+      return leaf_t { Value<leaf_t::width, leaf_t::signedness> {
+          std::get<leaf_t::index>(values) }
+                          .compute() };
+    } else {
+      return leaf;
+    }
+  });
+}
+
+/// Loop shaping parameters of evaluate(): the loop body is replicated
+/// unrollFactor times, and the inputs are prefetched prefetchDistance
+/// elements ahead (0 disables prefetching).
+template <std::size_t unroll = 1, std::size_t prefetch = 0>
+struct BatchConfig {
+  static_assert(unroll > 0, "Unroll factor should be positive");
+  static constexpr std::size_t unrollFactor = unroll;
+  static constexpr std::size_t prefetchDistance = prefetch;
+};
+
+/// Configurations replacing the element loop of evaluate() by their own
+/// strategy, given as a static evaluateRange with the signature of
+/// detail::evaluateRange
+template <typename Config>
+concept CustomEvaluation = Config::customEvaluation;
+
+namespace detail {
+template <typename Out, ExprType ET>
+constexpr void storeResult(Out& destination, ET const& expr) {
+  if constexpr (std::same_as<Out, res_t<ET>>) {
+    destination = expr.compute();
+  } else if constexpr (std::integral<Out>) {
+    destination = getAs<Out>(expr);
+  } else {
+    destination = Out { expr };
+  }
+}
+
+/// Leaf standing for a placeholder of format w, s bound to a batch input:
+/// it reads the element *cursor of input, so that a shape bound once is
+/// evaluated for each element by moving the cursor.
+template <uint32_t w, bool s, typename T> class BoundElement {
+ public:
+  static constexpr uint32_t width = w;
+  static constexpr bool signedness = s;
+
+ private:
+  T const* input;
+  std::size_t const* cursor;
+
+ public:
+  constexpr BoundElement(T const* elements, std::size_t const* position)
+      : input { elements }
+      , cursor { position } {}
+  constexpr ap_repr<w, s> compute() const {
+    return Value<w, s> { input[*cursor] }.compute();
+  }
+};
+
+/// Bind each placeholder of shape to the element *cursor of the input span
+/// of the same index
+template <ExprType ET, typename SpanTuple, std::size_t... I>
+constexpr auto bindElements(ET const& shape, SpanTuple const& spans,
+                            std::size_t const& cursor,
+                            std::index_sequence<I...>) {
+  return transformLeaves(shape, [&spans, &cursor](auto const& leaf) {
+    using leaf_t = std::decay_t<decltype(leaf)>;
+    if constexpr (PlaceholderType<leaf_t>) {
+      static_assert(leaf_t::index < sizeof...(I),
+                    "No input provided for placeholder");
+      auto const& input = std::get<leaf_t::index>(spans);
+      using elem_t = std::remove_cv_t<
+          typename std::decay_t<decltype(input)>::element_type>;
+      return BoundElement<leaf_t::width, leaf_t::signedness, elem_t> {
+        input.data(), &cursor
+      };
+    } else {
+      return leaf;
+    }
+  });
+}
+
+template <typename T>
+inline void prefetchElement(std::span<T> const& input, std::size_t idx) {
+#if defined(__GNUC__)
+  if (idx < input.size())
+    __builtin_prefetch(input.data() + idx);
+#endif
+}
+
+/// Evaluate shape for the elements [begin, end) of the spans.
+/// The last span is the output, the others are the inputs.
+template <typename Config, ExprType ET, typename SpanTuple, std::size_t... I>
+void evaluateRange(ET const& shape, SpanTuple const& spans, std::size_t begin,
+                   std::size_t end, std::index_sequence<I...>) {
+  if constexpr (CustomEvaluation<Config>) {
+    Config::evaluateRange(shape, spans, begin, end,
+                          std::index_sequence<I...> {});
+  } else {
+    auto const& out = std::get<sizeof...(I)>(spans);
+    // The shape is bound once, its leaves reading the inputs at cursor
+    std::size_t cursor = begin;
+    auto const bound =
+        bindElements(shape, spans, cursor, std::index_sequence<I...> {});
+    auto evalAt = [&](std::size_t i) {
+      if constexpr (Config::prefetchDistance > 0)
+        (prefetchElement(std::get<I>(spans), i + Config::prefetchDistance),
+         ...);
+      cursor = i;
+      storeResult(out[i], bound);
+    };
+    std::size_t i = begin;
+    if constexpr (Config::unrollFactor > 1) {
+      for (; i + Config::unrollFactor <= end; i += Config::unrollFactor)
+        unrolledFor<Config::unrollFactor>([&](auto k) { evalAt(i + k); });
+    }
+    for (; i < end; ++i)
+      evalAt(i);
+  }
+}
+
+template <typename... Ranges> auto makeBatchSpans(Ranges&&... ranges) {
+  static_assert(sizeof...(Ranges) > 0, "Batch evaluation needs an output");
+  auto spans = std::tuple { std::span { ranges }... };
+  std::size_t const count = std::get<sizeof...(Ranges) - 1>(spans).size();
+  std::apply(
+      [count](auto const&... span) {
+        if (((span.size() < count) || ...))
+          throw std::invalid_argument(
+              "Batch input smaller than the output range");
+      },
+      spans);
+  return spans;
+}
+} // namespace detail
+
+/// Evaluate shape once per element of contiguous ranges:
+/// evaluate(shape, in0, in1, ..., out) computes out[i] from shape where each
+/// Placeholder<k, ...> stands for ink[i].
+///
+/// Inputs elements can be Values, representations or integers, output
+/// elements Values, representations of the shape format or integers.
+template <typename Config = BatchConfig<>, ExprType ET, typename... Ranges>
+void evaluate(ET const& shape, Ranges&&... ranges) {
+  auto const spans = detail::makeBatchSpans(std::forward<Ranges>(ranges)...);
+  constexpr std::size_t inputCount = sizeof...(Ranges) - 1;
+  detail::evaluateRange<Config>(shape, spans, 0,
+                                std::get<inputCount>(spans).size(),
+                                std::make_index_sequence<inputCount> {});
+}
+
+} // namespace apintext
+
+#endif // BATCH_HPP
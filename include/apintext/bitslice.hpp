@@ -0,0 +1,342 @@
+#ifndef BITSLICE_HPP
+#define BITSLICE_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "aliases.hpp"
+#include "batch.hpp"
+#include "expression.hpp"
+#include "limbs.hpp"
+#include "traversal.hpp"
+#include "value.hpp"
+
+namespace apintext {
+/// Bit-sliced evaluation: the elements of a batch are processed by blocks of
+/// lanes, one lane per bit of a Word, whose inputs are transposed into bit
+/// planes. The i-th plane of an expression holds the bit i of its value for
+/// every lane, so that a bitwise operation on planes evaluates it on all
+/// lanes at once.
+///
+/// Only the nodes which reduce to boolean operations on planes are
+/// supported: placeholders and constant leaves, sign reinterpretations,
+/// extensions, slices, bitwise logic, reductions, sums and subtractions.
+/// Placeholders and results are at most 64 bits wide.
+
+#if defined(__GNUC__)
+/// 512 lanes, which are evaluated with single instructions on targets with
+/// AVX-512
+using WideLanes = uint64_t __attribute__((vector_size(64)));
+#endif
+
+template <typename Word, uint32_t w> using planes_t = std::array<Word, w>;
+
+namespace detail {
+/// idx-th 64-lane limb of a lane word
+template <typename Word>
+inline uint64_t getLimb(Word const& word, std::size_t idx) {
+  if constexpr (std::same_as<Word, uint64_t>) {
+    return word;
+  } else {
+    return word[idx];
+  }
+}
+
+template <typename Word>
+inline void setLimb(Word& word, std::size_t idx, uint64_t limb) {
+  if constexpr (std::same_as<Word, uint64_t>) {
+    word = limb;
+  } else {
+    word[idx] = limb;
+  }
+}
+
+/// In place transposition of a 64x64 bit matrix whose rows are the limbs:
+/// bit j of row i is swapped with bit i of row j, by swapping blocks of
+/// decreasing size across the diagonal.
+inline void transpose64(std::array<uint64_t, 64>& rows) {
+  uint64_t mask = 0x00000000FFFFFFFF;
+  for (uint32_t j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+    for (uint32_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+      uint64_t const t = ((rows[k] >> j) ^ rows[k | j]) & mask;
+      rows[k] ^= t << j;
+      rows[k | j] ^= t;
+    }
+  }
+}
+
+/// Planes of a value of width ws and signedness ss converted to w bits, as
+/// a static_cast of its representation would
+template <uint32_t w, bool ss, typename Word, std::size_t ws>
+planes_t<Word, w> convertPlanes(planes_t<Word, ws> const& src) {
+  planes_t<Word, w> res;
+  for (uint32_t i = 0; i < w; ++i) {
+    if (i < ws)
+      res[i] = src[i];
+    else if constexpr (ss)
+      res[i] = src[ws - 1];
+    else
+      res[i] = Word {};
+  }
+  return res;
+}
+
+/// Evaluation of the node ET on planes. Leaves which are not placeholders
+/// are computed once and broadcast to all the lanes.
+template <ExprType ET> struct SlicedNode {
+  static_assert(!CompositeExpr<ET>,
+                "Node not supported by the bit-sliced evaluation");
+
+  template <typename Word, typename Inputs>
+  static planes_t<Word, ET::width> eval(ET const& expr, Inputs const&) {
+    auto const limbs = toLimbs<ET::width>(
+        static_cast<ap_repr<ET::width, false>>(expr.compute()));
+    planes_t<Word, ET::width> res;
+    for (uint32_t i = 0; i < ET::width; ++i)
+      res[i] = ((limbs[i / 64] >> (i % 64)) & 1) ? ~Word {} : Word {};
+    return res;
+  }
+};
+
+template <typename Word, ExprType ET, typename Inputs>
+planes_t<Word, ET::width> evalPlanes(ET const& expr, Inputs const& inputs) {
+  return SlicedNode<ET>::template eval<Word>(expr, inputs);
+}
+
+template <std::size_t idx, uint32_t w, bool s>
+struct SlicedNode<Placeholder<idx, w, s>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, w> eval(Placeholder<idx, w, s> const&,
+                                Inputs const& inputs) {
+    return std::get<idx>(inputs);
+  }
+};
+
+template <bool s, ExprType ET> struct SlicedNode<ReinterpretSignExpr<s, ET>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, ET::width>
+  eval(ReinterpretSignExpr<s, ET> const& expr, Inputs const& inputs) {
+    return evalPlanes<Word>(std::get<0>(expr.operands()), inputs);
+  }
+};
+
+template <uint32_t w, ExprType ET> struct SlicedNode<ZExtExpr<w, ET>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, w> eval(ZExtExpr<w, ET> const& expr,
+                                Inputs const& inputs) {
+    return convertPlanes<w, false>(
+        evalPlanes<Word>(std::get<0>(expr.operands()), inputs));
+  }
+};
+
+template <uint32_t w, ExprType ET> struct SlicedNode<SignExtExpr<w, ET>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, w> eval(SignExtExpr<w, ET> const& expr,
+                                Inputs const& inputs) {
+    return convertPlanes<w, ET::signedness>(
+        evalPlanes<Word>(std::get<0>(expr.operands()), inputs));
+  }
+};
+
+template <uint32_t highBit, uint32_t lowBit, ExprType ET>
+struct SlicedNode<SliceExpr<highBit, lowBit, ET>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, highBit - lowBit + 1>
+  eval(SliceExpr<highBit, lowBit, ET> const& expr, Inputs const& inputs) {
+    auto const src = evalPlanes<Word>(std::get<0>(expr.operands()), inputs);
+    planes_t<Word, highBit - lowBit + 1> res;
+    std::copy(src.begin() + lowBit, src.begin() + highBit + 1, res.begin());
+    return res;
+  }
+};
+
+template <uint32_t idx, ExprType ET> struct SlicedNode<GetBitExpr<idx, ET>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, 1> eval(GetBitExpr<idx, ET> const& expr,
+                                Inputs const& inputs) {
+    return { evalPlanes<Word>(std::get<0>(expr.operands()), inputs)[idx] };
+  }
+};
+
+template <ExprType ET1, ExprType ET2, typename Operation>
+struct SlicedNode<BitwiseLogicExpr<ET1, ET2, Operation>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, ET1::width>
+  eval(BitwiseLogicExpr<ET1, ET2, Operation> const& expr,
+       Inputs const& inputs) {
+    auto const& [left, right] = expr.operands();
+    auto res = evalPlanes<Word>(left, inputs);
+    auto const rhs = evalPlanes<Word>(right, inputs);
+    for (uint32_t i = 0; i < ET1::width; ++i) {
+      if constexpr (std::same_as<Operation, BitwiseAND>) {
+        res[i] &= rhs[i];
+      } else if constexpr (std::same_as<Operation, BitwiseOR>) {
+        res[i] |= rhs[i];
+      } else {
+        static_assert(std::same_as<Operation, BitwiseXOR>,
+                      "Unknown bitwise operation");
+        res[i] ^= rhs[i];
+      }
+    }
+    return res;
+  }
+};
+
+template <ExprType ET> struct SlicedNode<BitInvertExpr<ET>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, ET::width> eval(BitInvertExpr<ET> const& expr,
+                                        Inputs const& inputs) {
+    auto res = evalPlanes<Word>(std::get<0>(expr.operands()), inputs);
+    for (auto& plane : res)
+      plane = ~plane;
+    return res;
+  }
+};
+
+template <ExprType ET, typename Reduction>
+struct SlicedNode<ReductionExpr<ET, Reduction>> {
+  template <typename Word, typename Inputs>
+  static planes_t<Word, 1> eval(ReductionExpr<ET, Reduction> const& expr,
+                                Inputs const& inputs) {
+    auto const src = evalPlanes<Word>(std::get<0>(expr.operands()), inputs);
+    Word acc = src[0];
+    for (uint32_t i = 1; i < ET::width; ++i) {
+      if constexpr (std::same_as<Reduction, ANDReduction>) {
+        acc &= src[i];
+      } else if constexpr (std::same_as<Reduction, XORReduction>) {
+        acc ^= src[i];
+      } else {
+        acc |= src[i];
+      }
+    }
+    if constexpr (std::same_as<Reduction, NORReduction>)
+      acc = ~acc;
+    return { acc };
+  }
+};
+
+/// Ripple-carry addition: each plane costs a handful of word operations
+/// for all the lanes, and a carry-lookahead tree would only add operations
+template <ExprType ET1, ExprType ET2, bool sub>
+struct SlicedNode<ExprSumBase<ET1, ET2, sub>> {
+  using node_t = ExprSumBase<ET1, ET2, sub>;
+  static constexpr uint32_t w = node_t::width;
+
+  template <typename Word, typename Inputs>
+  static planes_t<Word, w> eval(node_t const& expr, Inputs const& inputs) {
+    auto const& [left, right] = expr.operands();
+    auto const a = convertPlanes<w, ET1::signedness>(
+        evalPlanes<Word>(left, inputs));
+    auto const b = convertPlanes<w, ET2::signedness>(
+        evalPlanes<Word>(right, inputs));
+    planes_t<Word, w> res;
+    // a - b is computed as a + ~b + 1
+    Word carry = sub ? ~Word {} : Word {};
+    for (uint32_t i = 0; i < w; ++i) {
+      Word const bi = sub ? ~b[i] : b[i];
+      Word const half = a[i] ^ bi;
+      res[i] = half ^ carry;
+      carry = (a[i] & bi) | (half & carry);
+    }
+    return res;
+  }
+};
+
+template <typename P> constexpr uint32_t placeholderWidth = P::width;
+template <> constexpr uint32_t placeholderWidth<void> = 0;
+
+/// Planes of the elements [begin, begin + count) of an input of w bits
+template <typename Word, uint32_t w, bool s, typename Span>
+planes_t<Word, w> transposeInput(Span const& input, std::size_t begin,
+                                 std::size_t count) {
+  planes_t<Word, w> res {};
+  if constexpr (w > 0) {
+    for (std::size_t chunk = 0; 64 * chunk < count; ++chunk) {
+      std::array<uint64_t, 64> rows {};
+      std::size_t const lanes = std::min<std::size_t>(count - 64 * chunk, 64);
+      for (std::size_t j = 0; j < lanes; ++j) {
+        rows[j] = toLimbs<w>(static_cast<ap_repr<w, false>>(
+            Value<w, s> { input[begin + 64 * chunk + j] }.compute()))[0];
+      }
+      transpose64(rows);
+      for (uint32_t i = 0; i < w; ++i)
+        setLimb(res[i], chunk, rows[i]);
+    }
+  }
+  return res;
+}
+
+template <ExprType ET, typename Word, typename Span>
+void transposeOutput(planes_t<Word, ET::width> const& planes, Span const& out,
+                     std::size_t begin, std::size_t count) {
+  using value_t = Value<ET::width, ET::signedness>;
+  for (std::size_t chunk = 0; 64 * chunk < count; ++chunk) {
+    std::array<uint64_t, 64> rows {};
+    for (uint32_t i = 0; i < ET::width; ++i)
+      rows[i] = getLimb(planes[i], chunk);
+    transpose64(rows);
+    std::size_t const lanes = std::min<std::size_t>(count - 64 * chunk, 64);
+    for (std::size_t j = 0; j < lanes; ++j) {
+      auto const repr = static_cast<res_t<ET>>(
+          fromLimbs<ET::width>(limbs_t<1> { rows[j] }));
+      storeResult(out[begin + 64 * chunk + j], value_t { repr });
+    }
+  }
+}
+} // namespace detail
+
+/// Configuration of evaluate() and parallelEvaluate() for bit-sliced
+/// evaluation, with 8 * sizeof(Word) lanes per block. Word is uint64_t or
+/// WideLanes.
+template <typename Word = uint64_t> struct BitSliced {
+  static_assert(sizeof(Word) % sizeof(uint64_t) == 0,
+                "Lane words should be made of 64-bit limbs");
+  static constexpr std::size_t lanes = 8 * sizeof(Word);
+  static constexpr bool customEvaluation = true;
+  /// Chunks of parallel evaluations are whole blocks
+  static constexpr std::size_t unrollFactor = lanes;
+  static constexpr std::size_t prefetchDistance = 0;
+
+  template <ExprType ET, typename SpanTuple, std::size_t... I>
+  static void evaluateRange(ET const& shape, SpanTuple const& spans,
+                            std::size_t begin, std::size_t end,
+                            std::index_sequence<I...>) {
+    static_assert(ET::width <= 64,
+                  "Bit-sliced results should be at most 64 bits wide");
+    static_assert(((detail::placeholderWidth<placeholder_t<ET, I>> <= 64) &&
+                   ...),
+                  "Bit-sliced inputs should be at most 64 bits wide");
+    auto const& out = std::get<sizeof...(I)>(spans);
+    for (std::size_t block = begin; block < end; block += lanes) {
+      std::size_t const count = std::min(end - block, lanes);
+      auto const inputs = std::tuple {
+        detail::transposeInput<
+            Word, detail::placeholderWidth<placeholder_t<ET, I>>,
+            signednessOf<placeholder_t<ET, I>>()>(std::get<I>(spans), block,
+                                                  count)...
+      };
+      detail::transposeOutput<ET>(detail::evalPlanes<Word>(shape, inputs),
+                                  out, block, count);
+    }
+  }
+
+ private:
+  template <typename P> static constexpr bool signednessOf() {
+    if constexpr (std::is_void_v<P>) {
+      return false;
+    } else {
+      return P::signedness;
+    }
+  }
+};
+
+} // namespace apintext
+
+#endif // BITSLICE_HPP
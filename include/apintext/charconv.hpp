@@ -0,0 +1,337 @@
+#ifndef CHARCONV_HPP
+#define CHARCONV_HPP
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+#include "aliases.hpp"
+#include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
+#include "value.hpp"
+
+namespace apintext {
+namespace detail {
+/// Largest power of ten fitting a limb, which decimal conversions handle
+/// as 19-digit chunks.
+constexpr uint64_t decimalChunk = 10'000'000'000'000'000'000u;
+constexpr std::size_t decimalChunkDigits = 19;
+
+/// Above this many limbs, decimal conversions split the value in halves by
+/// dividing it by 10^(19 * 2^k), instead of peeling 19-digit chunks one at
+/// a time, which would take as many passes over the value as chunks.
+constexpr std::size_t decimalSplitLimbs = 8;
+
+/// Upper bound of the digit count of a width-bit magnitude in base 10
+constexpr std::size_t maxDecimalDigits(uint32_t width) {
+  return uint64_t { width } * 30103 / 100000 + 1;
+}
+
+constexpr char digitChar(uint64_t digit) {
+  return static_cast<char>((digit < 10) ? '0' + digit : 'a' + digit - 10);
+}
+
+/// Numeric value of c in base, or base if c is not a digit of this base
+constexpr uint64_t digitValue(char c, int base) {
+  uint64_t res = base;
+  if (c >= '0' && c <= '9')
+    res = c - '0';
+  else if (c >= 'a' && c <= 'z')
+    res = c - 'a' + 10;
+  else if (c >= 'A' && c <= 'Z')
+    res = c - 'A' + 10;
+  return (res < static_cast<uint64_t>(base)) ? res : base;
+}
+
+/// Bits per digit of power of two bases, 0 for the others
+constexpr uint32_t digitBits(int base) {
+  return (base >= 2 && base <= 32 && std::has_single_bit(unsigned(base)))
+             ? std::countr_zero(unsigned(base))
+             : 0;
+}
+
+/// Magnitude and sign of the value of an expression, on limbs
+template <ExprType ET> struct Magnitude {
+  static constexpr std::size_t N = limbCount(ET::width);
+  limbs_t<N> limbs;
+  bool negative;
+
+  constexpr explicit Magnitude(ET const& expr) {
+    limbs = toLimbs<ET::width>(
+        static_cast<ap_repr<ET::width, false>>(expr.compute()));
+    constexpr uint32_t topBits = ET::width - 64 * (N - 1);
+    negative = ET::signedness && ((limbs[N - 1] >> (topBits - 1)) & 1);
+    if (negative) {
+      uint64_t carry = 1;
+      for (auto& limb : limbs)
+        limb = addCarry(~limb, 0, carry, carry);
+      if constexpr (topBits < 64)
+        limbs[N - 1] &= (uint64_t { 1 } << topBits) - 1;
+    }
+  }
+};
+
+/// Write the digits of a in a power of two base, most significant first
+template <std::size_t N>
+constexpr char* writePow2Digits(limbs_t<N> const& a, uint32_t bits,
+                                char* out) {
+  std::size_t const n = significantLimbs(a);
+  uint64_t const bitLength =
+      (n == 0) ? 1 : 64 * (n - 1) + std::bit_width(a[n - 1]);
+  uint64_t const mask = (uint64_t { 1 } << bits) - 1;
+  for (uint64_t pos = (bitLength + bits - 1) / bits * bits; pos > 0;) {
+    pos -= bits;
+    std::size_t const idx = pos / 64;
+    uint32_t const shift = pos % 64;
+    uint64_t digit = a[idx] >> shift;
+    if (shift + bits > 64 && idx + 1 < N)
+      digit |= a[idx + 1] << (64 - shift);
+    *out++ = digitChar(digit & mask);
+  }
+  return out;
+}
+
+/// Write the digitCount decimal digits of a, zero padded, ending at out.
+/// a is destroyed.
+template <std::size_t N>
+constexpr void writeDecimalChunks(limbs_t<N>& a, std::size_t digitCount,
+                                  char* end) {
+  std::size_t n = significantLimbs(a);
+  char* const begin = end - digitCount;
+  while (end > begin) {
+    uint64_t chunk = limbDivRemSmall(a, decimalChunk, n);
+    while (n > 0 && a[n - 1] == 0)
+      --n;
+    for (std::size_t i = 0; i < decimalChunkDigits && end > begin; ++i) {
+      *--end = static_cast<char>('0' + chunk % 10);
+      chunk /= 10;
+    }
+  }
+}
+
+/// Powers 10^(19 * 2^k) fitting in half of N limbs, so that their squares
+/// (the next power) can still be computed.
+template <std::size_t N> struct DecimalPowers {
+  static constexpr std::size_t maxLevels = std::bit_width(N) + 1;
+  std::array<limbs_t<N>, maxLevels> powers {};
+  std::size_t levels = 0;
+
+  DecimalPowers() {
+    powers[0][0] = decimalChunk;
+    levels = 1;
+    while (levels < maxLevels &&
+           2 * significantLimbs(powers[levels - 1]) <= N) {
+      powers[levels] = limbMul(powers[levels - 1], powers[levels - 1]);
+      ++levels;
+    }
+  }
+
+  static DecimalPowers const& get() {
+    static DecimalPowers const table;
+    return table;
+  }
+};
+
+/// Write a < 10^(19 * 2^level) as exactly 19 * 2^level digits, starting at
+/// out. a is destroyed.
+template <std::size_t N>
+void writeDecimalFixed(limbs_t<N>& a, std::size_t level, char* out) {
+  std::size_t const digitCount = decimalChunkDigits << level;
+  if (level == 0 || significantLimbs(a) <= decimalSplitLimbs) {
+    writeDecimalChunks(a, digitCount, out + digitCount);
+    return;
+  }
+  limbs_t<N> high, low;
+  limbDivMod(a, DecimalPowers<N>::get().powers[level - 1], high, low);
+  writeDecimalFixed(high, level - 1, out);
+  writeDecimalFixed(low, level - 1, out + digitCount / 2);
+}
+
+/// Write the decimal digits of a, without leading zeros, starting at out.
+/// a is destroyed.
+template <std::size_t N> char* writeDecimal(limbs_t<N>& a, char* out) {
+  if constexpr (N > decimalSplitLimbs) {
+    auto const& table = DecimalPowers<N>::get();
+    std::size_t level = table.levels;
+    while (level > 0 && limbLess(a, table.powers[level - 1]))
+      --level;
+    if (level > 0 && significantLimbs(a) > decimalSplitLimbs) {
+      // a >= 10^(19 * 2^(level - 1)): its low digits are the remainder
+      limbs_t<N> high, low;
+      limbDivMod(a, table.powers[level - 1], high, low);
+      out = writeDecimal(high, out);
+      writeDecimalFixed(low, level - 1, out);
+      return out + (decimalChunkDigits << (level - 1));
+    }
+  }
+  // Digits are produced least significant first in a local buffer
+  std::array<char, maxDecimalDigits(64 * N) + decimalChunkDigits> buffer;
+  std::size_t digitCount = 0;
+  std::size_t n = significantLimbs(a);
+  char* const bufferEnd = buffer.data() + buffer.size();
+  do {
+    uint64_t chunk = limbDivRemSmall(a, decimalChunk, n);
+    while (n > 0 && a[n - 1] == 0)
+      --n;
+    std::size_t const chunkDigits =
+        (n == 0) ? ((chunk == 0) ? 1 : 0) : decimalChunkDigits;
+    for (std::size_t i = 0; i < chunkDigits || chunk != 0; ++i) {
+      *(bufferEnd - ++digitCount) = static_cast<char>('0' + chunk % 10);
+      chunk /= 10;
+    }
+  } while (n > 0);
+  char const* src = bufferEnd - digitCount;
+  while (src != bufferEnd)
+    *out++ = *src++;
+  return out;
+}
+} // namespace detail
+
+/// Write the value of an expression in base 2 to 36 in [first, last), as
+/// std::to_chars does for integers: lower case digits, leading minus sign
+/// for negative values, no prefix.
+///
+/// Power of two bases are produced directly from the bits of the value.
+/// Decimal digits are produced 19 at a time, and wide values are first
+/// split recursively in halves with large powers of ten. Nothing is
+/// allocated on the heap.
+template <ExprType ET>
+std::to_chars_result to_chars(char* first, char* last, ET const& expr,
+                              int base = 10) {
+  if (base < 2 || base > 36)
+    return { last, std::errc::invalid_argument };
+  detail::Magnitude<ET> magnitude { expr };
+  // 1 character for the sign, at most width digits
+  std::array<char, ET::width + 1> buffer;
+  char* out = buffer.data();
+  if (magnitude.negative)
+    *out++ = '-';
+  if (uint32_t const bits = detail::digitBits(base); bits != 0) {
+    out = detail::writePow2Digits(magnitude.limbs, bits, out);
+  } else if (base == 10) {
+    out = detail::writeDecimal(magnitude.limbs, out);
+  } else {
+    // Generic base: one digit per pass
+    std::array<char, ET::width> digits;
+    std::size_t count = 0;
+    std::size_t n = detail::significantLimbs(magnitude.limbs);
+    do {
+      digits[count++] = detail::digitChar(
+          detail::limbDivRemSmall(magnitude.limbs, base, n));
+      while (n > 0 && magnitude.limbs[n - 1] == 0)
+        --n;
+    } while (n > 0);
+    while (count > 0)
+      *out++ = digits[--count];
+  }
+  std::size_t const length = out - buffer.data();
+  if (static_cast<std::size_t>(last - first) < length)
+    return { last, std::errc::value_too_large };
+  for (std::size_t i = 0; i < length; ++i)
+    first[i] = buffer[i];
+  return { first + length, std::errc {} };
+}
+
+/// Parse a value in base 2 to 36 from [first, last), as std::from_chars
+/// does for integers: an optional minus sign for signed formats, followed
+/// by digits of either case. On overflow, result_out_of_range is returned
+/// and value is left untouched.
+template <uint32_t w, bool s, typename... Policies>
+std::from_chars_result from_chars(char const* first, char const* last,
+                                  Value<w, s, Policies...>& value,
+                                  int base = 10) {
+  if (base < 2 || base > 36)
+    return { first, std::errc::invalid_argument };
+  constexpr std::size_t N = detail::limbCount(w);
+  char const* cur = first;
+  bool const negative = s && cur != last && *cur == '-';
+  if (negative)
+    ++cur;
+  char const* const digitsBegin = cur;
+  while (cur != last && detail::digitValue(*cur, base) < uint64_t(base))
+    ++cur;
+  if (cur == digitsBegin)
+    return { first, std::errc::invalid_argument };
+
+  // Magnitude, which should fit in w bits, or w - 1 bits for signed values
+  // (with an exception for the most negative value)
+  detail::limbs_t<N> limbs {};
+  bool overflow = false;
+  if (uint32_t const bits = detail::digitBits(base); bits != 0) {
+    uint64_t pos = 0;
+    for (char const* digitPtr = cur; digitPtr-- != digitsBegin; pos += bits) {
+      uint64_t const digit = detail::digitValue(*digitPtr, base);
+      if (digit == 0)
+        continue;
+      if (pos + std::bit_width(digit) > w) {
+        overflow = true;
+        break;
+      }
+      std::size_t const idx = pos / 64;
+      uint32_t const shift = pos % 64;
+      limbs[idx] |= digit << shift;
+      if (shift + bits > 64 && idx + 1 < N)
+        limbs[idx + 1] |= digit >> (64 - shift);
+    }
+  } else {
+    // Digits are accumulated by groups which fit a limb
+    uint64_t groupBase = base;
+    std::size_t groupDigits = 1;
+    while (groupBase <= ~uint64_t { 0 } / base) {
+      groupBase *= base;
+      ++groupDigits;
+    }
+    for (char const* digitPtr = digitsBegin; digitPtr != cur && !overflow;) {
+      uint64_t group = 0, factor = 1;
+      for (std::size_t i = 0; i < groupDigits && digitPtr != cur; ++i) {
+        group = group * base + detail::digitValue(*digitPtr++, base);
+        factor *= base;
+      }
+      overflow = detail::limbMulAddSmall(limbs, factor, group) != 0;
+    }
+    constexpr uint32_t topBits = w - 64 * (N - 1);
+    if constexpr (topBits < 64)
+      overflow = overflow || (limbs[N - 1] >> topBits) != 0;
+  }
+  if (!overflow && s) {
+    // |value| <= 2^(w - 1) - 1, or 2^(w - 1) when negative
+    constexpr uint32_t signIdx = (w - 1) / 64;
+    constexpr uint64_t signBit = uint64_t { 1 } << ((w - 1) % 64);
+    if (limbs[signIdx] & signBit) {
+      bool isMin = (limbs[signIdx] == signBit);
+      for (std::size_t i = 0; i < signIdx; ++i)
+        isMin = isMin && limbs[i] == 0;
+      overflow = !(negative && isMin);
+    }
+  }
+  if (overflow)
+    return { cur, std::errc::result_out_of_range };
+
+  if (negative) {
+    uint64_t carry = 1;
+    for (auto& limb : limbs)
+      limb = detail::addCarry(~limb, 0, carry, carry);
+  }
+  value = Value<w, s, Policies...> { static_cast<ap_repr<w, s>>(
+      detail::fromLimbs<w>(limbs)) };
+  return { cur, std::errc {} };
+}
+
+/// Value of an expression as a string in base 2 to 36
+template <ExprType ET> std::string toString(ET const& expr, int base = 10) {
+  std::array<char, ET::width + 1> buffer;
+  auto const res =
+      to_chars(buffer.data(), buffer.data() + buffer.size(), expr, base);
+  if (res.ec != std::errc {})
+    return {};
+  return { buffer.data(), res.ptr };
+}
+
+} // namespace apintext
+
+#endif // CHARCONV_HPP
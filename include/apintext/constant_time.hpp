@@ -0,0 +1,389 @@
+#ifndef CONSTANT_TIME_HPP
+#define CONSTANT_TIME_HPP
+
+#include <cstdint>
+
+#include "aliases.hpp"
+#include "cost.hpp"
+#include "expression.hpp"
+#include "limbs.hpp"
+
+namespace apintext {
+/// Constant-time counterparts of the arithmetic and comparison expressions.
+///
+/// The compute() method of the nodes of this namespace executes a sequence of
+/// operations and memory accesses that only depends on the operand formats,
+/// never on their values: the kernels only use fixed iteration counts, mask
+/// based selection and multiplications of 64-bit limbs. Result widths and
+/// signedness are the same as their generic counterparts.
+namespace ct {
+
+//****************** Kernels ******************************************//
+
+/// All ones if bit is set, zero otherwise
+template <uint32_t w>
+constexpr ap_repr<w, false> broadcast(ap_repr<1, false> const& bit) {
+  return ap_repr<w, false> { 0 } - static_cast<ap_repr<w, false>>(bit);
+}
+
+template <uint32_t w, bool s>
+constexpr ap_repr<w, s> maskSelect(ap_repr<1, false> const& cond,
+                                   ap_repr<w, s> const& ifSet,
+                                   ap_repr<w, s> const& ifUnset) {
+  using u_t = ap_repr<w, false>;
+  auto const mask = broadcast<w>(cond);
+  return static_cast<ap_repr<w, s>>((static_cast<u_t>(ifSet) & mask) |
+                                    (static_cast<u_t>(ifUnset) & ~mask));
+}
+
+template <uint32_t w, bool s>
+constexpr ap_repr<1, false> msb(ap_repr<w, s> const& value) {
+  return static_cast<ap_repr<1, false>>(static_cast<ap_repr<w, false>>(value) >>
+                                        (w - 1));
+}
+
+/// OR-fold of the limbs, then sign bit of (x | -x)
+template <uint32_t w>
+constexpr ap_repr<1, false> isNonZero(ap_repr<w, false> const& value) {
+  auto const limbs = detail::toLimbs<w>(value);
+  uint64_t acc = 0;
+  for (auto limb : limbs)
+    acc |= limb;
+  return static_cast<ap_repr<1, false>>((acc | (uint64_t { 0 } - acc)) >> 63);
+}
+
+/// Two's complement negation when cond is set
+template <uint32_t w>
+constexpr ap_repr<w, false> conditionalNegate(ap_repr<w, false> const& value,
+                                              ap_repr<1, false> const& cond) {
+  auto const mask = broadcast<w>(cond);
+  return (value ^ mask) - mask;
+}
+
+/// Restoring division of unsigned w-bit values, with exactly w iterations.
+/// Dividing by zero yields an all ones quotient and the dividend as
+/// remainder.
+template <uint32_t w>
+constexpr void divModUnsigned(ap_repr<w, false> const& dividend,
+                              ap_repr<w, false> const& divisor,
+                              ap_repr<w, false>& quot,
+                              ap_repr<w, false>& rem) {
+  // Partial remainders are smaller than twice the divisor, the extra bit
+  // holds the borrow of the trial subtraction.
+  using wide_t = ap_repr<w + 2, false>;
+  wide_t const d = static_cast<wide_t>(divisor);
+  wide_t r { 0 };
+  ap_repr<w, false> n = dividend;
+  ap_repr<w, false> q { 0 };
+  for (uint32_t i = 0; i < w; ++i) {
+    r = (r << 1) | static_cast<wide_t>(msb<w, false>(n));
+    n <<= 1;
+    wide_t const diff = r - d;
+    auto const borrow = msb<w + 2, false>(diff);
+    r = maskSelect<w + 2, false>(borrow, r, diff);
+    q = (q << 1) |
+        static_cast<ap_repr<w, false>>(borrow ^ ap_repr<1, false> { 1 });
+  }
+  quot = q;
+  rem = static_cast<ap_repr<w, false>>(r);
+}
+
+/// Truncating signed or unsigned division, with the sign corrections
+/// applied through masks.
+template <uint32_t w, bool s>
+constexpr void divMod(ap_repr<w, s> const& dividend,
+                      ap_repr<w, s> const& divisor, ap_repr<w, s>& quot,
+                      ap_repr<w, s>& rem) {
+  using u_t = ap_repr<w, false>;
+  u_t q { 0 }, r { 0 };
+  if constexpr (s) {
+    auto const negDividend = msb<w, true>(dividend);
+    auto const negDivisor = msb<w, true>(divisor);
+    divModUnsigned<w>(
+        conditionalNegate<w>(static_cast<u_t>(dividend), negDividend),
+        conditionalNegate<w>(static_cast<u_t>(divisor), negDivisor), q, r);
+    quot = static_cast<ap_repr<w, s>>(
+        conditionalNegate<w>(q, negDividend ^ negDivisor));
+    rem = static_cast<ap_repr<w, s>>(conditionalNegate<w>(r, negDividend));
+  } else {
+    divModUnsigned<w>(dividend, divisor, quot, rem);
+  }
+}
+
+/// Sign bit of the difference computed one bit wider than the operands
+template <uint32_t w, bool s>
+constexpr ap_repr<1, false> lessThan(ap_repr<w, s> const& left,
+                                     ap_repr<w, s> const& right) {
+  using wide_t = ap_repr<w + 1, true>;
+  wide_t const diff = static_cast<wide_t>(left) - static_cast<wide_t>(right);
+  return msb<w + 1, true>(diff);
+}
+
+template <uint32_t w, bool s>
+constexpr ap_repr<1, false> equal(ap_repr<w, s> const& left,
+                                  ap_repr<w, s> const& right) {
+  using u_t = ap_repr<w, false>;
+  return isNonZero<w>(static_cast<u_t>(left) ^ static_cast<u_t>(right)) ^
+         ap_repr<1, false> { 1 };
+}
+
+//****************** Arithmetic expressions ***************************//
+
+template <ExprType ET1, ExprType ET2> class ExprProd {
+ private:
+  using prop = ExprArithProp<ET1, ET2>;
+
+ public:
+  static constexpr uint32_t width = prop::prodWidth;
+  static constexpr bool signedness = prop::prodSigned;
+  using res_t = ap_repr<width, signedness>;
+  ET1 const leftOp;
+  ET2 const rightOp;
+
+ public:
+  constexpr ExprProd(ET1 const& val1, ET2 const& val2)
+      : leftOp { val1 }
+      , rightOp { val2 } {}
+
+  /// Truncated limb product of the operands extended to the result width,
+  /// which is exact for two's complement operands.
+  constexpr res_t compute() const {
+    using u_t = ap_repr<width, false>;
+    auto lExt = static_cast<u_t>(static_cast<res_t>(leftOp.compute()));
+    auto rExt = static_cast<u_t>(static_cast<res_t>(rightOp.compute()));
+    return static_cast<res_t>(detail::fromLimbs<width>(detail::limbMul(
+        detail::toLimbs<width>(lExt), detail::toLimbs<width>(rExt))));
+  }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ExprProd<left_t, right_t> { f(leftOp), f(rightOp) };
+  }
+};
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto prod(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprProd<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+template <ExprType ET1, ExprType ET2> class ExprDiv {
+  using prop = ExprArithProp<ET1, ET2>;
+
+ public:
+  static constexpr uint32_t width = prop::divWidth;
+  static constexpr bool signedness = prop::divSigned;
+  using res_t = ap_repr<width, signedness>;
+  ET1 const leftOp;
+  ET2 const rightOp;
+
+ public:
+  constexpr ExprDiv(ET1 const& val1, ET2 const& val2)
+      : leftOp { val1 }
+      , rightOp { val2 } {}
+
+  constexpr res_t compute() const {
+    using format = DivisionFormat<ET1, ET2>;
+    typename format::repr_t quot { 0 }, rem { 0 };
+    divMod<format::width, format::signedness>(
+        format::adapt(leftOp), format::adapt(rightOp), quot, rem);
+    return static_cast<res_t>(quot);
+  }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ExprDiv<left_t, right_t> { f(leftOp), f(rightOp) };
+  }
+};
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto div(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprDiv<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+template <ExprType ET1, ExprType ET2> class ExprMod {
+  using prop = ExprArithProp<ET1, ET2>;
+
+ public:
+  static constexpr uint32_t width = prop::modWidth;
+  static constexpr bool signedness = prop::modSigned;
+  using res_t = ap_repr<width, signedness>;
+  ET1 const leftOp;
+  ET2 const rightOp;
+
+ public:
+  constexpr ExprMod(ET1 const& val1, ET2 const& val2)
+      : leftOp { val1 }
+      , rightOp { val2 } {}
+
+  constexpr res_t compute() const {
+    using format = DivisionFormat<ET1, ET2>;
+    typename format::repr_t quot { 0 }, rem { 0 };
+    divMod<format::width, format::signedness>(
+        format::adapt(leftOp), format::adapt(rightOp), quot, rem);
+    return static_cast<res_t>(rem);
+  }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ExprMod<left_t, right_t> { f(leftOp), f(rightOp) };
+  }
+};
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto mod(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprMod<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+//****************** Comparisons **************************************//
+
+template <ExprType ET1, ExprType ET2, typename Comparison>
+class ComparisonExpr {
+ public:
+  static constexpr uint32_t width = 1;
+  static constexpr bool signedness = false;
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  ET1 const leftOp;
+  ET2 const rightOp;
+
+ public:
+  constexpr ComparisonExpr(ET1 const& left, ET2 const& right)
+      : leftOp { left }
+      , rightOp { right } {}
+
+  constexpr res_t compute() const {
+    using tightOverset = TightOverset<ET1, ET2>;
+    constexpr uint32_t toWidth = tightOverset::width;
+    constexpr bool toSign = tightOverset::signedness;
+    using adaptor = Adaptor<SignExtension, Forbid, ReinterpretSign>;
+    return Comparison::template compute<toWidth, toSign>(
+        adaptor::template adapt<toWidth, toSign>(leftOp).compute(),
+        adaptor::template adapt<toWidth, toSign>(rightOp).compute());
+  }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ComparisonExpr<left_t, right_t, Comparison> { f(leftOp), f(rightOp) };
+  }
+};
+
+struct LessThan {
+  template <uint32_t w, bool s>
+  static constexpr ap_repr<1, false> compute(ap_repr<w, s> const& left,
+                                             ap_repr<w, s> const& right) {
+    return lessThan<w, s>(left, right);
+  }
+};
+
+struct GreaterThan {
+  template <uint32_t w, bool s>
+  static constexpr ap_repr<1, false> compute(ap_repr<w, s> const& left,
+                                             ap_repr<w, s> const& right) {
+    return lessThan<w, s>(right, left);
+  }
+};
+
+struct LessEqual {
+  template <uint32_t w, bool s>
+  static constexpr ap_repr<1, false> compute(ap_repr<w, s> const& left,
+                                             ap_repr<w, s> const& right) {
+    return lessThan<w, s>(right, left) ^ ap_repr<1, false> { 1 };
+  }
+};
+
+struct GreaterEqual {
+  template <uint32_t w, bool s>
+  static constexpr ap_repr<1, false> compute(ap_repr<w, s> const& left,
+                                             ap_repr<w, s> const& right) {
+    return lessThan<w, s>(left, right) ^ ap_repr<1, false> { 1 };
+  }
+};
+
+struct Equal {
+  template <uint32_t w, bool s>
+  static constexpr ap_repr<1, false> compute(ap_repr<w, s> const& left,
+                                             ap_repr<w, s> const& right) {
+    return equal<w, s>(left, right);
+  }
+};
+
+struct NotEqual {
+  template <uint32_t w, bool s>
+  static constexpr ap_repr<1, false> compute(ap_repr<w, s> const& left,
+                                             ap_repr<w, s> const& right) {
+    return equal<w, s>(left, right) ^ ap_repr<1, false> { 1 };
+  }
+};
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto lessThan(ET1 const& left, ET2 const& right) {
+  using node_t = ComparisonExpr<operand_t<ET1>, operand_t<ET2>, LessThan>;
+  return node_t { toOperand(left), toOperand(right) };
+}
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto greaterThan(ET1 const& left, ET2 const& right) {
+  using node_t = ComparisonExpr<operand_t<ET1>, operand_t<ET2>, GreaterThan>;
+  return node_t { toOperand(left), toOperand(right) };
+}
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto lessEqual(ET1 const& left, ET2 const& right) {
+  using node_t = ComparisonExpr<operand_t<ET1>, operand_t<ET2>, LessEqual>;
+  return node_t { toOperand(left), toOperand(right) };
+}
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto greaterEqual(ET1 const& left, ET2 const& right) {
+  using node_t = ComparisonExpr<operand_t<ET1>, operand_t<ET2>, GreaterEqual>;
+  return node_t { toOperand(left), toOperand(right) };
+}
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto equal(ET1 const& left, ET2 const& right) {
+  using node_t = ComparisonExpr<operand_t<ET1>, operand_t<ET2>, Equal>;
+  return node_t { toOperand(left), toOperand(right) };
+}
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto notEqual(ET1 const& left, ET2 const& right) {
+  using node_t = ComparisonExpr<operand_t<ET1>, operand_t<ET2>, NotEqual>;
+  return node_t { toOperand(left), toOperand(right) };
+}
+
+} // namespace ct
+
+/// Products over all the limbs of the result format
+template <ExprType ET1, ExprType ET2> struct NodeCost<ct::ExprProd<ET1, ET2>> {
+  static constexpr uint64_t value =
+      detail::limbCount(ct::ExprProd<ET1, ET2>::width) *
+      detail::limbCount(ct::ExprProd<ET1, ET2>::width);
+};
+
+/// Divisions take a shift, subtraction and selection per quotient bit
+template <ExprType ET1, ExprType ET2> struct NodeCost<ct::ExprDiv<ET1, ET2>> {
+  static constexpr uint64_t value =
+      4 * uint64_t { DivisionFormat<ET1, ET2>::width } *
+      detail::limbCount(DivisionFormat<ET1, ET2>::width + 2);
+};
+
+template <ExprType ET1, ExprType ET2> struct NodeCost<ct::ExprMod<ET1, ET2>> {
+  static constexpr uint64_t value =
+      4 * uint64_t { DivisionFormat<ET1, ET2>::width } *
+      detail::limbCount(DivisionFormat<ET1, ET2>::width + 2);
+};
+} // namespace apintext
+
+#endif // CONSTANT_TIME_HPP
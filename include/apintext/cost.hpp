@@ -0,0 +1,68 @@
+#ifndef COST_HPP
+#define COST_HPP
+
+#include <cstdint>
+
+#include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "traversal.hpp"
+
+namespace apintext {
+/// Rough cost of evaluating one node, operands excluded, in 64-bit word
+/// operations. It is only meant to compare expressions with each other, for
+/// instance to size the work units of parallel evaluations.
+///
+/// Nodes without a specialisation are assumed to be linear in their width.
+/// Headers defining costlier nodes specialise it next to them.
+template <ExprType ET> struct NodeCost {
+  static constexpr uint64_t value = detail::limbCount(ET::width);
+};
+
+namespace detail {
+/// Hardware division of operands of up to 128 bits (a few tens of cycles).
+/// Wider divisions run Knuth's algorithm D on limbs (limbDivModN), each
+/// quotient limb taking a hardware division and a pass over the divisor;
+/// width * limbCount(width) is a generous bound on it.
+constexpr uint64_t divisionCost(uint32_t width) {
+  return (width <= 128) ? 32 : uint64_t { width } * limbCount(width);
+}
+} // namespace detail
+
+template <ExprType ET1, ExprType ET2> struct NodeCost<ExprProd<ET1, ET2>> {
+  static constexpr uint64_t value =
+      detail::limbCount(ET1::width) * detail::limbCount(ET2::width);
+};
+
+/// Squares compute each cross product once
+template <ExprType ET> struct NodeCost<ExprSquare<ET>> {
+  static constexpr uint64_t value =
+      detail::limbCount(ET::width) * (detail::limbCount(ET::width) + 1) / 2;
+};
+
+template <ExprType ET1, ExprType ET2> struct NodeCost<ExprDiv<ET1, ET2>> {
+  static constexpr uint64_t value =
+      detail::divisionCost(DivisionFormat<ET1, ET2>::width);
+};
+
+template <ExprType ET1, ExprType ET2> struct NodeCost<ExprMod<ET1, ET2>> {
+  static constexpr uint64_t value =
+      detail::divisionCost(DivisionFormat<ET1, ET2>::width);
+};
+
+namespace detail {
+template <typename List> struct TreeCost;
+} // namespace detail
+
+/// Estimated cost of evaluating a whole expression tree
+template <ExprType ET>
+constexpr uint64_t exprCost =
+    NodeCost<ET>::value + detail::TreeCost<operand_types_t<ET>>::value;
+
+namespace detail {
+template <typename... ETs> struct TreeCost<TypeList<ETs...>> {
+  static constexpr uint64_t value = (uint64_t { 0 } + ... + exprCost<ETs>);
+};
+} // namespace detail
+} // namespace apintext
+
+#endif // COST_HPP
@@ -0,0 +1,341 @@
+#ifndef DATAFLOW_HPP
+#define DATAFLOW_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace apintext {
+class Dataflow;
+
+/// Thrown by Dataflow::run() when every running stage waits on a stream
+/// that no other stage will ever serve
+class DeadlockError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+/// Thrown in the stages blocked on streams when the dataflow is aborted,
+/// and swallowed by the runner
+struct DataflowAborted {};
+
+/// Stream operation a stage is blocked on: ready(stream) tells whether it
+/// can proceed, without side effects
+struct StreamWait {
+  bool (*ready)(void const*);
+  void const* stream;
+  bool pushing;
+};
+
+/// Dataflow running the stage of the current thread, if any
+struct StageContext {
+  Dataflow* flow = nullptr;
+  std::size_t stage = 0;
+};
+
+inline thread_local StageContext currentStage;
+
+void waitForStream(StreamWait const& wait);
+void notifyStreams();
+} // namespace detail
+
+/// Bounded single producer, single consumer FIFO, the software counterpart
+/// of hls::stream: one stage pushes into it and another one pops from it.
+///
+/// The ring buffer is lock-free. The producer and consumer positions live
+/// on their own cache lines, each side keeping a cached copy of the other
+/// one so that it only reads the shared position when the buffer looks
+/// full or empty.
+///
+/// Blocking operations from stages of a Dataflow wait on the dataflow,
+/// which detects deadlocks. Elsewhere they spin until another thread
+/// serves the stream.
+template <typename T> class Stream {
+ private:
+  struct alignas(64) Side {
+    std::atomic<std::size_t> position { 0 };
+    /// Last seen position of the other side
+    std::size_t cached = 0;
+  };
+
+  Side producer;
+  Side consumer;
+  std::size_t const capacity;
+  std::unique_ptr<T[]> buffer;
+
+  static bool canPush(void const* stream) {
+    return !static_cast<Stream const*>(stream)->full();
+  }
+  static bool canPop(void const* stream) {
+    return !static_cast<Stream const*>(stream)->empty();
+  }
+
+  /// Room for pushes, refreshing the cached consumer position if needed
+  std::size_t room(std::size_t tail, std::size_t wanted) {
+    if (capacity - (tail - producer.cached) < wanted)
+      producer.cached = consumer.position.load(std::memory_order_acquire);
+    return capacity - (tail - producer.cached);
+  }
+
+  /// Elements available to pop, refreshing the cached producer position if
+  /// needed
+  std::size_t available(std::size_t head, std::size_t wanted) {
+    if (consumer.cached - head < wanted)
+      consumer.cached = producer.position.load(std::memory_order_acquire);
+    return consumer.cached - head;
+  }
+
+ public:
+  /// The capacity is rounded up to a power of two
+  explicit Stream(std::size_t depth = 1024)
+      : capacity { std::bit_ceil(std::max<std::size_t>(depth, 1)) }
+      , buffer { new T[capacity] } {}
+
+  Stream(Stream const&) = delete;
+  Stream& operator=(Stream const&) = delete;
+
+  std::size_t depth() const { return capacity; }
+
+  /// Number of elements in the stream, exact only from the producer or the
+  /// consumer thread
+  std::size_t size() const {
+    return producer.position.load(std::memory_order_acquire) -
+           consumer.position.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  bool full() const { return size() == capacity; }
+
+  //******************* Producer side **************************//
+
+  /// Push as many values as there is room for, returning their count
+  std::size_t tryPush(std::span<T const> values) {
+    std::size_t const tail = producer.position.load(std::memory_order_relaxed);
+    std::size_t const count =
+        std::min(room(tail, values.size()), values.size());
+    for (std::size_t i = 0; i < count; ++i)
+      buffer[(tail + i) & (capacity - 1)] = values[i];
+    if (count != 0) {
+      producer.position.store(tail + count, std::memory_order_release);
+      detail::notifyStreams();
+    }
+    return count;
+  }
+
+  bool tryPush(T const& value) { return tryPush({ &value, 1 }) == 1; }
+
+  /// Push all the values, waiting for room when the stream is full
+  void push(std::span<T const> values) {
+    while (true) {
+      values = values.subspan(tryPush(values));
+      if (values.empty())
+        return;
+      detail::waitForStream({ &canPush, this, true });
+    }
+  }
+
+  void push(T const& value) { push({ &value, 1 }); }
+
+  //******************* Consumer side **************************//
+
+  /// Pop as many values as available, up to the size of out, returning
+  /// their count
+  std::size_t tryPop(std::span<T> out) {
+    std::size_t const head = consumer.position.load(std::memory_order_relaxed);
+    std::size_t const count =
+        std::min(available(head, out.size()), out.size());
+    for (std::size_t i = 0; i < count; ++i)
+      out[i] = buffer[(head + i) & (capacity - 1)];
+    if (count != 0) {
+      consumer.position.store(head + count, std::memory_order_release);
+      detail::notifyStreams();
+    }
+    return count;
+  }
+
+  bool tryPop(T& value) { return tryPop({ &value, 1 }) == 1; }
+
+  /// Fill out, waiting for values when the stream is empty
+  void pop(std::span<T> out) {
+    while (true) {
+      out = out.subspan(tryPop(out));
+      if (out.empty())
+        return;
+      detail::waitForStream({ &canPop, this, false });
+    }
+  }
+
+  T pop() {
+    T value;
+    pop({ &value, 1 });
+    return value;
+  }
+};
+
+/// Stages connected by streams, each one running on its own thread, like
+/// the processes of an HLS dataflow region.
+///
+/// Full streams block their producer and empty ones their consumer. When
+/// all the stages still running are blocked on streams which none of them
+/// can serve, for instance because a consumer pops more values than its
+/// producer pushes, the dataflow is deadlocked: the blocked stages are
+/// unwound and run() throws a DeadlockError naming them.
+class Dataflow {
+ private:
+  std::vector<std::function<void()>> stages;
+
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  /// Operation each stage is blocked on, if any
+  std::vector<detail::StreamWait const*> waits;
+  std::atomic<std::size_t> waiting { 0 };
+  std::size_t running = 0;
+  bool aborting = false;
+  std::string deadlock;
+  std::exception_ptr error;
+
+  /// Pushes and pops do not synchronize with the registration of waiters:
+  /// a missed notification only delays the wake up by this much
+  static constexpr std::chrono::milliseconds pollPeriod { 1 };
+
+  /// Description of the deadlock if no blocked stage can proceed, called
+  /// with the mutex held once all the running stages are blocked
+  std::string findDeadlock() const {
+    std::string res;
+    for (std::size_t i = 0; i < waits.size(); ++i) {
+      if (waits[i] == nullptr)
+        continue;
+      if (waits[i]->ready(waits[i]->stream))
+        return {};
+      res += (res.empty() ? "Dataflow deadlock: stage " : ", stage ") +
+             std::to_string(i) +
+             (waits[i]->pushing ? " waits to push" : " waits to pop");
+    }
+    return res;
+  }
+
+  void stageDone(std::exception_ptr stageError) {
+    std::lock_guard lock { mutex };
+    --running;
+    if (stageError && !error) {
+      error = stageError;
+      aborting = true;
+    }
+    wakeUp.notify_all();
+  }
+
+  void runStage(std::size_t idx) {
+    detail::currentStage = { this, idx };
+    std::exception_ptr stageError;
+    try {
+      stages[idx]();
+    } catch (detail::DataflowAborted const&) {
+    } catch (...) {
+      stageError = std::current_exception();
+    }
+    detail::currentStage = {};
+    stageDone(stageError);
+  }
+
+  friend void detail::waitForStream(detail::StreamWait const& wait);
+  friend void detail::notifyStreams();
+
+  void wait(std::size_t stage, detail::StreamWait const& streamWait) {
+    std::unique_lock lock { mutex };
+    waits[stage] = &streamWait;
+    waiting.fetch_add(1, std::memory_order_relaxed);
+    auto const leave = [&] {
+      waits[stage] = nullptr;
+      waiting.fetch_sub(1, std::memory_order_relaxed);
+    };
+    while (true) {
+      if (!aborting && streamWait.ready(streamWait.stream)) {
+        leave();
+        return;
+      }
+      if (!aborting && waiting.load(std::memory_order_relaxed) == running) {
+        deadlock = findDeadlock();
+        if (!deadlock.empty()) {
+          aborting = true;
+          wakeUp.notify_all();
+        }
+      }
+      if (aborting) {
+        leave();
+        throw detail::DataflowAborted {};
+      }
+      wakeUp.wait_for(lock, pollPeriod);
+    }
+  }
+
+  void notify() {
+    if (waiting.load(std::memory_order_relaxed) == 0)
+      return;
+    std::lock_guard lock { mutex };
+    wakeUp.notify_all();
+  }
+
+ public:
+  Dataflow() = default;
+  Dataflow(Dataflow const&) = delete;
+  Dataflow& operator=(Dataflow const&) = delete;
+
+  /// Add a stage, a callable run once on its own thread by run()
+  template <typename F> void addStage(F&& stage) {
+    stages.emplace_back(std::forward<F>(stage));
+  }
+
+  /// Run all the stages concurrently and wait for them to return. The first
+  /// exception thrown by a stage aborts the stages blocked on streams and is
+  /// rethrown; a deadlock throws a DeadlockError.
+  void run() {
+    waits.assign(stages.size(), nullptr);
+    running = stages.size();
+    aborting = false;
+    deadlock.clear();
+    error = nullptr;
+    std::vector<std::thread> threads;
+    threads.reserve(stages.size());
+    for (std::size_t i = 0; i < stages.size(); ++i)
+      threads.emplace_back([this, i] { runStage(i); });
+    for (auto& thread : threads)
+      thread.join();
+    if (error)
+      std::rethrow_exception(error);
+    if (!deadlock.empty())
+      throw DeadlockError(deadlock);
+  }
+};
+
+namespace detail {
+inline void waitForStream(StreamWait const& wait) {
+  if (currentStage.flow != nullptr) {
+    currentStage.flow->wait(currentStage.stage, wait);
+    return;
+  }
+  while (!wait.ready(wait.stream))
+    std::this_thread::yield();
+}
+
+inline void notifyStreams() {
+  if (currentStage.flow != nullptr)
+    currentStage.flow->notify();
+}
+} // namespace detail
+} // namespace apintext
+
+#endif // DATAFLOW_HPP
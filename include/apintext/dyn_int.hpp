@@ -0,0 +1,359 @@
+#ifndef DYN_INT_HPP
+#define DYN_INT_HPP
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "arith_prop.hpp"
+#include "limbs.hpp"
+#include "runtime_kernels.hpp"
+#include "value.hpp"
+
+namespace apintext {
+/// Bump allocator of limbs.
+///
+/// Memory is taken from a list of chunks of growing size, which are kept
+/// when the arena is released: once warmed up, an arena reset after each
+/// evaluation batch no longer calls the system allocator.
+class DynArena {
+ private:
+  struct Chunk {
+    std::unique_ptr<uint64_t[]> limbs;
+    std::size_t size;
+  };
+
+  static constexpr std::size_t minChunkLimbs = 4096;
+
+  std::vector<Chunk> chunks;
+  std::size_t current = 0;
+  std::size_t used = 0;
+
+ public:
+  /// Allocation state, to which the arena can be rewound
+  struct Mark {
+    std::size_t chunk;
+    std::size_t used;
+
+    friend bool operator==(Mark const&, Mark const&) = default;
+  };
+
+  DynArena() = default;
+  DynArena(DynArena const&) = delete;
+  DynArena& operator=(DynArena const&) = delete;
+
+  /// Arena of the calling thread
+  static DynArena& local() {
+    thread_local DynArena arena;
+    return arena;
+  }
+
+  uint64_t* allocate(std::size_t limbs) {
+    while (!chunks.empty()) {
+      if (used + limbs <= chunks[current].size) {
+        uint64_t* res = chunks[current].limbs.get() + used;
+        used += limbs;
+        return res;
+      }
+      if (current + 1 == chunks.size())
+        break;
+      ++current;
+      used = 0;
+    }
+    std::size_t const size = std::max(
+        { minChunkLimbs, limbs, chunks.empty() ? 0 : 2 * chunks.back().size });
+    chunks.push_back({ std::make_unique<uint64_t[]>(size), size });
+    current = chunks.size() - 1;
+    used = limbs;
+    return chunks.back().limbs.get();
+  }
+
+  Mark mark() const { return { current, used }; }
+
+  /// Free everything allocated since m was taken
+  void release(Mark m) {
+    current = m.chunk;
+    used = m.used;
+  }
+
+  void reset() { release({ 0, 0 }); }
+
+  /// Number of limbs owned by the arena
+  std::size_t capacity() const {
+    std::size_t res = 0;
+    for (Chunk const& chunk : chunks)
+      res += chunk.size;
+    return res;
+  }
+};
+
+/// Scope of an evaluation batch: the arena is rewound to its state at the
+/// start of the batch when the scope ends.
+class ArenaBatch {
+ private:
+  DynArena& arena;
+  DynArena::Mark const start;
+
+ public:
+  explicit ArenaBatch(DynArena& arena = DynArena::local())
+      : arena { arena }
+      , start { arena.mark() } {}
+  ArenaBatch(ArenaBatch const&) = delete;
+  ArenaBatch& operator=(ArenaBatch const&) = delete;
+  ~ArenaBatch() { arena.release(start); }
+};
+
+/// Integer whose format is chosen at run time.
+///
+/// Operators follow the format rules of the expression templates, and
+/// division by zero follows the runtime IR: the quotient is all ones and
+/// the remainder is the dividend.
+///
+/// Values up to 128 bits are stored inline. Wider values take their limbs
+/// from the arena of the constructing thread, and should not outlive the
+/// batch in which they were created.
+class ApIntDyn {
+ private:
+  static constexpr uint32_t inlineWidth = 128;
+
+  Format fmt;
+  std::array<uint64_t, 2> small {};
+  uint64_t* wide = nullptr;
+
+  struct Uninitialized {};
+
+  ApIntDyn(Format format, Uninitialized)
+      : fmt { format } {
+    if (format.width == 0)
+      throw std::invalid_argument("Null integer width");
+    if (format.width > inlineWidth)
+      wide = DynArena::local().allocate(limbCount());
+  }
+
+  /// Drop the wide storage, which was moved to another value
+  void release() {
+    fmt.width = std::min(fmt.width, inlineWidth);
+    small = {};
+    wide = nullptr;
+  }
+
+  std::size_t limbCount() const { return detail::limbCount(fmt.width); }
+  uint64_t* data() { return (fmt.width > inlineWidth) ? wide : small.data(); }
+  uint64_t const* data() const {
+    return (fmt.width > inlineWidth) ? wide : small.data();
+  }
+
+  static ApIntDyn bitwise(ApIntDyn const& lhs, ApIntDyn const& rhs,
+                          uint64_t (*op)(uint64_t, uint64_t)) {
+    if (lhs.fmt.width != rhs.fmt.width)
+      throw std::invalid_argument(
+          "Bitwise operation on operands of different widths");
+    ApIntDyn res { { lhs.fmt.width, false }, Uninitialized {} };
+    for (std::size_t i = 0; i < res.limbCount(); ++i)
+      res.data()[i] = op(lhs.data()[i], rhs.data()[i]);
+    detail::normalizeLimbs(res.data(), res.fmt);
+    return res;
+  }
+
+  static ApIntDyn divMod(ApIntDyn const& lhs, ApIntDyn const& rhs,
+                         bool quotient) {
+    Format const format = divisionFormat(lhs.fmt, rhs.fmt);
+    ArithmeticFormats const formats = arithmeticFormats(lhs.fmt, rhs.fmt);
+    std::size_t const n = detail::limbCount(format.width);
+    ApIntDyn res { quotient ? formats.div : formats.mod, Uninitialized {} };
+    // The temporaries are released before returning
+    ArenaBatch const batch;
+    uint64_t* const quot =
+        DynArena::local().allocate(2 * n + detail::divModScratch(n));
+    uint64_t* const rem = quot + n;
+    detail::divModExtended(quot, rem, lhs.data(), lhs.fmt, rhs.data(),
+                           rhs.fmt, rem + n);
+    detail::copyExtended(res.data(), res.limbCount(),
+                         quotient ? quot : rem, format);
+    detail::normalizeLimbs(res.data(), res.fmt);
+    return res;
+  }
+
+ public:
+  explicit ApIntDyn(Format format, int64_t value = 0)
+      : ApIntDyn { format, Uninitialized {} } {
+    std::fill_n(data(), limbCount(), (value < 0) ? ~uint64_t { 0 } : 0);
+    data()[0] = static_cast<uint64_t>(value);
+    detail::normalizeLimbs(data(), fmt);
+  }
+
+  /// Value whose limbs are given, the bits above the width being ignored
+  ApIntDyn(Format format, std::span<uint64_t const> limbs)
+      : ApIntDyn { format, Uninitialized {} } {
+    if (limbs.size() < limbCount())
+      throw std::invalid_argument("Too few limbs for the integer width");
+    std::copy_n(limbs.begin(), limbCount(), data());
+    detail::normalizeLimbs(data(), fmt);
+  }
+
+  template <uint32_t w, bool s, typename... Policies>
+  explicit ApIntDyn(Value<w, s, Policies...> const& value)
+      : ApIntDyn { Format { w, s }, Uninitialized {} } {
+    auto const limbs =
+        detail::toLimbs<w>(static_cast<ap_repr<w, false>>(value.compute()));
+    if constexpr (w > inlineWidth)
+      std::copy(limbs.begin(), limbs.end(), wide);
+    else
+      std::copy(limbs.begin(), limbs.end(), small.begin());
+    detail::normalizeLimbs(data(), fmt);
+  }
+
+  ApIntDyn(ApIntDyn const& other)
+      : ApIntDyn { other.fmt, Uninitialized {} } {
+    std::copy_n(other.data(), limbCount(), data());
+  }
+
+  /// The moved-from value is left as zero in an inline format, so that it
+  /// does not share the wide storage
+  ApIntDyn(ApIntDyn&& other) noexcept
+      : fmt { other.fmt }
+      , small { other.small }
+      , wide { other.wide } {
+    other.release();
+  }
+
+  ApIntDyn& operator=(ApIntDyn const& other) {
+    if (this == &other)
+      return *this;
+    // Wide storage is reused when large enough
+    bool const fits =
+        fmt.width > inlineWidth && limbCount() >= other.limbCount();
+    if (other.fmt.width > inlineWidth && !fits)
+      wide = DynArena::local().allocate(other.limbCount());
+    fmt = other.fmt;
+    std::copy_n(other.data(), limbCount(), data());
+    return *this;
+  }
+
+  ApIntDyn& operator=(ApIntDyn&& other) noexcept {
+    if (this == &other)
+      return *this;
+    fmt = other.fmt;
+    small = other.small;
+    wide = other.wide;
+    other.release();
+    return *this;
+  }
+
+  Format format() const { return fmt; }
+  uint32_t width() const { return fmt.width; }
+  bool signedness() const { return fmt.signedness; }
+
+  /// Limbs of the value, extended to whole limbs according to its format
+  std::span<uint64_t const> limbs() const { return { data(), limbCount() }; }
+
+  bool isNegative() const {
+    return fmt.signedness && static_cast<int64_t>(data()[limbCount() - 1]) < 0;
+  }
+
+  /// Conversion to a template value of the same format
+  template <uint32_t w, bool s> Value<w, s> toValue() const {
+    if (fmt != Format { w, s })
+      throw std::invalid_argument("Integer format mismatch");
+    detail::limbs_t<detail::limbCount(w)> limbs;
+    for (std::size_t i = 0; i < limbs.size(); ++i)
+      limbs[i] = detail::unsignedLimb(data(), fmt, i);
+    return { static_cast<ap_repr<w, s>>(detail::fromLimbs<w>(limbs)) };
+  }
+
+  /// Adaptation with the default policies of Value: extension by the sign,
+  /// truncation and sign reinterpretation
+  ApIntDyn adapt(Format target) const {
+    ApIntDyn res { target, Uninitialized {} };
+    detail::copyExtended(res.data(), res.limbCount(), data(), fmt);
+    detail::normalizeLimbs(res.data(), target);
+    return res;
+  }
+
+  /// Unsigned value of the bits lowBit to highBit
+  ApIntDyn slice(uint32_t highBit, uint32_t lowBit) const {
+    if (highBit < lowBit || highBit >= fmt.width)
+      throw std::out_of_range("Slice out of the integer bounds");
+    ApIntDyn res { { highBit - lowBit + 1, false }, Uninitialized {} };
+    detail::sliceLimbs(res.data(), res.limbCount(), data(), fmt, lowBit);
+    detail::normalizeLimbs(res.data(), res.fmt);
+    return res;
+  }
+
+  friend ApIntDyn operator+(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    ApIntDyn res { arithmeticFormats(lhs.fmt, rhs.fmt).sum,
+                   Uninitialized {} };
+    detail::addExtended(res.data(), res.limbCount(), lhs.data(), lhs.fmt,
+                        rhs.data(), rhs.fmt);
+    detail::normalizeLimbs(res.data(), res.fmt);
+    return res;
+  }
+
+  friend ApIntDyn operator-(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    ApIntDyn res { arithmeticFormats(lhs.fmt, rhs.fmt).sum,
+                   Uninitialized {} };
+    detail::subExtended(res.data(), res.limbCount(), lhs.data(), lhs.fmt,
+                        rhs.data(), rhs.fmt);
+    detail::normalizeLimbs(res.data(), res.fmt);
+    return res;
+  }
+
+  friend ApIntDyn operator*(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    ApIntDyn res { arithmeticFormats(lhs.fmt, rhs.fmt).prod,
+                   Uninitialized {} };
+    detail::mulExtended(res.data(), res.limbCount(), lhs.data(), lhs.fmt,
+                        rhs.data(), rhs.fmt);
+    detail::normalizeLimbs(res.data(), res.fmt);
+    return res;
+  }
+
+  friend ApIntDyn operator/(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    return divMod(lhs, rhs, true);
+  }
+
+  friend ApIntDyn operator%(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    return divMod(lhs, rhs, false);
+  }
+
+  friend ApIntDyn operator&(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    return bitwise(lhs, rhs, [](uint64_t a, uint64_t b) { return a & b; });
+  }
+
+  friend ApIntDyn operator|(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    return bitwise(lhs, rhs, [](uint64_t a, uint64_t b) { return a | b; });
+  }
+
+  friend ApIntDyn operator^(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    return bitwise(lhs, rhs, [](uint64_t a, uint64_t b) { return a ^ b; });
+  }
+
+  friend ApIntDyn operator~(ApIntDyn const& src) {
+    ApIntDyn res { { src.fmt.width, false }, Uninitialized {} };
+    for (std::size_t i = 0; i < res.limbCount(); ++i)
+      res.data()[i] = ~src.data()[i];
+    detail::normalizeLimbs(res.data(), res.fmt);
+    return res;
+  }
+
+  /// Comparisons are performed in the tight overset of the formats
+  friend bool operator==(ApIntDyn const& lhs, ApIntDyn const& rhs) {
+    return detail::compareExtended(lhs.data(), lhs.fmt, rhs.data(),
+                                   rhs.fmt) == 0;
+  }
+
+  friend std::strong_ordering operator<=>(ApIntDyn const& lhs,
+                                          ApIntDyn const& rhs) {
+    int const cmp =
+        detail::compareExtended(lhs.data(), lhs.fmt, rhs.data(), rhs.fmt);
+    return cmp <=> 0;
+  }
+};
+} // namespace apintext
+
+#endif // DYN_INT_HPP
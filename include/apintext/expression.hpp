@@ -4,10 +4,13 @@
 #include <concepts>
 #include <cstdint>
 #include <limits>
+#include <tuple>
 #include <type_traits>
 
 #include "aliases.hpp"
 #include "arith_prop.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
 
 namespace apintext {
 
@@ -18,17 +21,40 @@ concept ExprType = requires(T const& val) {
 
 template <ExprType ET> using res_t = ap_repr<ET::width, ET::signedness>;
 
+/// Expressions built on top of other expressions expose them through
+/// operands(), which returns a tuple of references, and mapOperands(f),
+/// which builds the same node on top of f(operand) for each operand.
+template <typename T>
+concept CompositeExpr = ExprType<T> && requires(T const& val) {
+  val.operands();
+};
+
+/// Expressions holding their value, like values and constants, which give
+/// access to it by reference through stored(), so that nodes reading a few
+/// of its limbs do not copy it
+template <typename T>
+concept StoredExpr = ExprType<T> && requires(T const& val) {
+  { val.stored() } -> std::same_as<res_t<T> const&>;
+};
+
+/// Operand stored by the nodes built on an expression, the expression
+/// itself unless an overload found by ADL gives a by-value replacement,
+/// for expressions which refer to their data like writable slices
+template <ExprType ET> constexpr ET const& toOperand(ET const& expr) {
+  return expr;
+}
+
+template <ExprType ET>
+using operand_t = std::decay_t<decltype(toOperand(std::declval<ET const&>()))>;
+
 template <ExprType E1, ExprType E2> struct TightOverset {
  private:
-  static constexpr bool widestIsE1 = E1::width == E2::width;
-  static constexpr uint32_t maxWidth =
-      (E1::width > E2::width) ? E1::width : E2::width;
-  static constexpr bool sameSignedness = E1::signedness == E2::signedness;
-  static constexpr bool oneIsSigned = E1::signedness || E2::signedness;
+  static constexpr Format format = tightOverset(
+      { E1::width, E1::signedness }, { E2::width, E2::signedness });
 
  public:
-  static constexpr bool signedness = oneIsSigned;
-  static constexpr uint32_t width = (sameSignedness) ? maxWidth : maxWidth + 1;
+  static constexpr bool signedness = format.signedness;
+  static constexpr uint32_t width = format.width;
 };
 
 //****************** Adaptor **********************************//
@@ -67,6 +93,7 @@ template <uint32_t w, bool s> class ConstantExpr {
   constexpr ConstantExpr(val_t const& src_repr)
       : value { src_repr } {}
   constexpr val_t compute() const { return value; };
+  constexpr val_t const& stored() const { return value; }
 
  private:
   const val_t value;
@@ -82,13 +109,30 @@ toExpr(T const& value) {
   return { value };
 }
 
+#ifdef APINTEXT_NATIVE_INT
 template <uint32_t w>
-constexpr ConstantExpr<w, false> toExpr(unsigned _ExtInt(w) const& value) {
+constexpr ConstantExpr<w, false>
+toExpr(unsigned APINTEXT_NATIVE_INT(w) const& value) {
   return { value };
 }
 
 template <uint32_t w>
-constexpr ConstantExpr<w, true> toExpr(signed _ExtInt(w) const& value) {
+constexpr ConstantExpr<w, true>
+toExpr(signed APINTEXT_NATIVE_INT(w) const& value) {
+  return { value };
+}
+#endif
+
+/// Representations of the limb backend, when it is the default one
+template <uint32_t w, bool s>
+  requires std::same_as<ap_repr<w, s>, LimbInt<w, s>>
+constexpr ConstantExpr<w, s> toExpr(LimbInt<w, s> const& value) {
+  return { value };
+}
+
+template <uint32_t w, bool s>
+  requires std::same_as<ap_repr<w, s>, SmallInt<w, s>>
+constexpr ConstantExpr<w, s> toExpr(SmallInt<w, s> const& value) {
   return { value };
 }
 
@@ -110,6 +154,12 @@ class ReinterpretSignExpr {
   constexpr res_t compute() const {
     return static_cast<res_t>(source.compute());
   }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ReinterpretSignExpr<targetSignedness, mapped_t> { f(source) };
+  }
 };
 
 template <uint32_t targetWidth, ExprType SourceType> class ZExtExpr {
@@ -131,11 +181,17 @@ template <uint32_t targetWidth, ExprType SourceType> class ZExtExpr {
     return static_cast<res_t>(
         static_cast<ap_repr<SourceType::width, false>>(source.compute()));
   };
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ZExtExpr<targetWidth, mapped_t> { f(source) };
+  }
 };
 
 template <uint32_t targetWidth, ExprType ET>
 constexpr auto zeroExtendToWidth(ET const& source) {
-  return ZExtExpr<targetWidth, ET> { source };
+  return ZExtExpr<targetWidth, operand_t<ET>> { toOperand(source) };
 }
 
 template <uint32_t targetWidth, ExprType SourceType> class SignExtExpr {
@@ -156,11 +212,17 @@ template <uint32_t targetWidth, ExprType SourceType> class SignExtExpr {
   constexpr res_t compute() const {
     return static_cast<res_t>(source.compute());
   };
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return SignExtExpr<targetWidth, mapped_t> { f(source) };
+  }
 };
 
 template <uint32_t targetWidth, ExprType ET>
 constexpr auto signExtendToWidth(ET const& source) {
-  return SignExtExpr<targetWidth, ET>(source);
+  return SignExtExpr<targetWidth, operand_t<ET>>(toOperand(source));
 }
 
 //**************** Operation on bit vector ********************************//
@@ -186,11 +248,17 @@ class SliceExpr {
     return static_cast<res_t>(
         static_cast<ap_repr<highBit + 1, false>>(source.compute()) >> lowBit);
   }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return SliceExpr<highBit, lowBit, mapped_t> { f(source) };
+  }
 };
 
 template <uint32_t highBit, uint32_t lowBit, ExprType ET>
 constexpr auto slice(ET const& source) {
-  return SliceExpr<highBit, lowBit, ET> { source };
+  return SliceExpr<highBit, lowBit, operand_t<ET>> { toOperand(source) };
 }
 
 template <uint32_t bitIdx, ExprType ET> class GetBitExpr {
@@ -213,10 +281,97 @@ template <uint32_t bitIdx, ExprType ET> class GetBitExpr {
     return { (static_cast<intermediate_t>(source.compute()) & mask) !=
              intermediate_t { 0 } };
   }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return GetBitExpr<bitIdx, mapped_t> { f(source) };
+  }
 };
 
 template <uint32_t idx, ExprType ET> constexpr auto getBit(ET const& src) {
-  return GetBitExpr<idx, ET> { src };
+  return GetBitExpr<idx, operand_t<ET>> { toOperand(src) };
+}
+
+/// Slice of w bits of the source starting at a runtime index. Bits above
+/// the source width read as zero.
+template <uint32_t w, ExprType ET> class DynSliceExpr {
+ public:
+  static constexpr uint32_t width = w;
+  static constexpr bool signedness = false;
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  using src_t = ap_repr<ET::width, false>;
+  using stored_t = ap_repr<ET::width, ET::signedness>;
+  static constexpr std::size_t srcLimbs = detail::limbCount(ET::width);
+  ET const source;
+  uint32_t const lowIdx;
+
+  /// Source limb idx, zero past the source width
+  static uint64_t srcLimb(stored_t const& src, std::size_t idx) {
+    if (idx >= srcLimbs)
+      return 0;
+    uint64_t const limb =
+        detail::loadLimb<ET::width, ET::signedness>(src, idx);
+    if constexpr (ET::width % 64 != 0) {
+      if (idx == srcLimbs - 1)
+        return limb & ((uint64_t { 1 } << (ET::width % 64)) - 1);
+    }
+    return limb;
+  }
+
+  constexpr res_t extract(stored_t const& src) const {
+    if (lowIdx >= ET::width)
+      return res_t { 0 };
+    if constexpr (srcLimbs > 1 &&
+                  detail::limbAddressable<ET::width, ET::signedness>) {
+      if (!std::is_constant_evaluated()) {
+        // Only read the limbs overlapping the slice
+        std::size_t const first = lowIdx / 64;
+        uint32_t const shift = lowIdx % 64;
+        detail::limbs_t<detail::limbCount(w)> res;
+        detail::limbFor<detail::limbCount(w)>([&](std::size_t i) {
+          res[i] = detail::funnelShr(srcLimb(src, first + i + 1),
+                                     srcLimb(src, first + i), shift);
+        });
+        if constexpr (w % 64 != 0)
+          res.back() &= (uint64_t { 1 } << (w % 64)) - 1;
+        return detail::fromLimbs<w>(res);
+      }
+    }
+    return static_cast<res_t>(static_cast<src_t>(src) >> lowIdx);
+  }
+
+ public:
+  constexpr DynSliceExpr(ET const& src, uint32_t lowIdx)
+      : source { src }
+      , lowIdx { lowIdx } {}
+
+  /// Stored sources are read in place, other ones are computed first
+  constexpr res_t compute() const {
+    if constexpr (StoredExpr<ET>)
+      return extract(source.stored());
+    else
+      return extract(source.compute());
+  }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return DynSliceExpr<w, mapped_t> { f(source), lowIdx };
+  }
+};
+
+template <uint32_t w, ExprType ET>
+constexpr auto dynSlice(ET const& source, uint32_t lowIdx) {
+  return DynSliceExpr<w, operand_t<ET>> { toOperand(source), lowIdx };
+}
+
+template <ExprType ET> using DynGetBitExpr = DynSliceExpr<1, ET>;
+
+template <ExprType ET> constexpr auto dynGetBit(ET const& src, uint32_t idx) {
+  return DynGetBitExpr<operand_t<ET>> { toOperand(src), idx };
 }
 
 template <ExprType ET1, ExprType ET2, typename Operation>
@@ -231,7 +386,7 @@ class BitwiseLogicExpr {
   ET2 rightOp;
 
  public:
-  constexpr BitwiseLogicExpr(ET1 const& left, ET1 const& right)
+  constexpr BitwiseLogicExpr(ET1 const& left, ET2 const& right)
       : leftOp { left }
       , rightOp { right } {
     Operation::template check<ET1, ET2>();
@@ -239,6 +394,14 @@ class BitwiseLogicExpr {
   constexpr res_t compute() const {
     return Operation::compute(leftOp, rightOp);
   }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return BitwiseLogicExpr<left_t, right_t, Operation> { f(leftOp),
+                                                         f(rightOp) };
+  }
 };
 
 struct BitwiseAND {
@@ -294,17 +457,20 @@ using BitwiseXORExpr = BitwiseLogicExpr<ET1, ET2, BitwiseXOR>;
 
 template <ExprType ET1, ExprType ET2>
 constexpr auto operator|(ET1 const& left, ET2 const& right) {
-  return BitwiseORExpr<ET1, ET2> { left, right };
+  using node_t = BitwiseORExpr<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(left), toOperand(right) };
 }
 
 template <ExprType ET1, ExprType ET2>
 constexpr auto operator&(ET1 const& left, ET2 const& right) {
-  return BitwiseANDExpr<ET1, ET2> { left, right };
+  using node_t = BitwiseANDExpr<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(left), toOperand(right) };
 }
 
 template <ExprType ET1, ExprType ET2>
 constexpr auto operator^(ET1 const& left, ET2 const& right) {
-  return BitwiseXORExpr<ET1, ET2> { left, right };
+  using node_t = BitwiseXORExpr<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(left), toOperand(right) };
 }
 
 template <ExprType ET> class BitInvertExpr {
@@ -321,10 +487,16 @@ template <ExprType ET> class BitInvertExpr {
       : source { src } {}
 
   constexpr res_t compute() const { return { ~source.compute() }; }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return BitInvertExpr<mapped_t> { f(source) };
+  }
 };
 
 template <ExprType ET> constexpr auto operator~(ET const& src) {
-  return BitInvertExpr<ET> { src };
+  return BitInvertExpr<operand_t<ET>> { toOperand(src) };
 }
 
 template <ExprType ET, typename Reduction> class ReductionExpr {
@@ -340,6 +512,12 @@ template <ExprType ET, typename Reduction> class ReductionExpr {
   constexpr ReductionExpr(ET const& src)
       : source { src } {}
   constexpr res_t compute() const { return Reduction::compute(source); }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ReductionExpr<mapped_t, Reduction> { f(source) };
+  }
 };
 
 struct ORReduction {
@@ -367,22 +545,39 @@ struct NORReduction {
   }
 };
 
+struct XORReduction {
+  template <ExprType ET>
+  static constexpr ap_repr<1, false> compute(ET const& src) {
+    // After folding with shifts 1, 2, 4, ..., bit 0 is the parity of all bits
+    auto folded = static_cast<ap_repr<ET::width, false>>(src.compute());
+    for (uint32_t shift = 1; shift < ET::width; shift *= 2)
+      folded ^= folded >> shift;
+    return static_cast<ap_repr<1, false>>(folded);
+  }
+};
+
 template <ExprType ET> using ORReductionExpr = ReductionExpr<ET, ORReduction>;
 
 template <ExprType ET> using NORReductionExpr = ReductionExpr<ET, NORReduction>;
 
 template <ExprType ET> using ANDReductionExpr = ReductionExpr<ET, ANDReduction>;
 
+template <ExprType ET> using XORReductionExpr = ReductionExpr<ET, XORReduction>;
+
 template <ExprType ET> constexpr auto orReduce(ET const& source) {
-  return ORReductionExpr<ET> { source };
+  return ORReductionExpr<operand_t<ET>> { toOperand(source) };
 }
 
 template <ExprType ET> constexpr auto norReduce(ET const& source) {
-  return NORReductionExpr<ET> { source };
+  return NORReductionExpr<operand_t<ET>> { toOperand(source) };
 }
 
 template <ExprType ET> constexpr auto andReduce(ET const& source) {
-  return ANDReductionExpr<ET> { source };
+  return ANDReductionExpr<operand_t<ET>> { toOperand(source) };
+}
+
+template <ExprType ET> constexpr auto xorReduce(ET const& source) {
+  return XORReductionExpr<operand_t<ET>> { toOperand(source) };
 }
 
 //************* Policies *********************************************//
@@ -440,9 +635,94 @@ template <ExprType ET1, ExprType ET2>
 using ExprArithProp =
     ArithmeticProp<ET1::width, ET2::width, ET1::signedness, ET2::signedness>;
 
+namespace detail {
+/// Square of an unsigned representation, as an unsigned representation of
+/// rw bits. Limb arrays are squared by the squaring kernel, the other
+/// representations are multiplied by the compiler.
+template <uint32_t rw, uint32_t w>
+constexpr ap_repr<rw, false> squareRepr(ap_repr<w, false> const& val) {
+  using res_t = ap_repr<rw, false>;
+  if constexpr (std::same_as<res_t, LimbInt<rw, false>>) {
+    return res_t::fromLimbs(limbSqr<limbCount(rw)>(val.getLimbs()));
+  } else {
+    auto const ext = static_cast<res_t>(val);
+    return ext * ext;
+  }
+}
+
+/// Products of a stored expression by itself can be squares of a single
+/// object, which is only known at run time from the operand addresses
+template <typename ET1, typename ET2>
+constexpr bool maybeSquare = StoredExpr<ET1> && std::same_as<ET1, ET2>;
+
+/// Whether a product is the square of a single object, empty for the
+/// products which cannot be
+template <bool stored> struct SquareFlag {
+  static constexpr bool value = false;
+  constexpr SquareFlag(bool) {}
+};
+
+template <> struct SquareFlag<true> {
+  bool value;
+  constexpr SquareFlag(bool same)
+      : value { same } {}
+};
+} // namespace detail
+
+/// Square of an expression, whose operand is evaluated once. The result is
+/// unsigned and only as wide as squareFormat requires.
+template <ExprType ET> class ExprSquare {
+  static constexpr Format format =
+      squareFormat({ ET::width, ET::signedness });
+
+ public:
+  static constexpr uint32_t width = format.width;
+  static constexpr bool signedness = false;
+  using res_t = ap_repr<width, signedness>;
+  ET const source;
+
+ public:
+  constexpr ExprSquare(ET const& src)
+      : source { src } {}
+
+  constexpr res_t compute() const {
+    using operand_t = ap_repr<ET::width, false>;
+    auto const val = source.compute();
+    auto magnitude = static_cast<operand_t>(val);
+    if constexpr (ET::signedness) {
+      if (val < decltype(val) { 0 })
+        magnitude = -magnitude;
+    }
+    return detail::squareRepr<width, ET::width>(magnitude);
+  }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ExprSquare<mapped_t> { f(source) };
+  }
+};
+
+template <ExprType ET> constexpr auto square(ET const& expr) {
+  return ExprSquare<operand_t<ET>> { toOperand(expr) };
+}
+
+/// Product of two expressions. When both operands are the same stored
+/// object, as in x * x on a Value, it is evaluated as the square of that
+/// object, still in the format of the product; square() gives the narrower
+/// unsigned format.
 template <ExprType ET1, ExprType ET2> class ExprProd {
  private:
   using prop = ExprArithProp<ET1, ET2>;
+  static constexpr bool maybeSquare = detail::maybeSquare<ET1, ET2>;
+
+  static constexpr bool sameObject(ET1 const& val1, ET2 const& val2) {
+    if constexpr (maybeSquare) {
+      return &val1 == &val2;
+    } else {
+      return false;
+    }
+  }
 
  public:
   static constexpr uint32_t width = prop::prodWidth;
@@ -451,23 +731,64 @@ template <ExprType ET1, ExprType ET2> class ExprProd {
   ET1 const leftOp;
   ET2 const rightOp;
 
+ private:
+  [[no_unique_address]] detail::SquareFlag<maybeSquare> const squaring;
+
  public:
   constexpr ExprProd(ET1 const& val1, ET2 const& val2)
       : leftOp { val1 }
-      , rightOp { val2 } {}
+      , rightOp { val2 }
+      , squaring { sameObject(val1, val2) } {}
 
   constexpr res_t compute() const {
+    if constexpr (maybeSquare) {
+      if (squaring.value)
+        return static_cast<res_t>(ExprSquare<ET1> { leftOp }.compute());
+    }
     auto lExt = static_cast<res_t>(leftOp.compute());
     auto rExt = static_cast<res_t>(rightOp.compute());
     return { lExt * rExt };
   }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  /// Squares are mapped to squares of the mapped operand
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    if constexpr (maybeSquare && std::same_as<left_t, right_t>) {
+      if (squaring.value) {
+        auto const mapped = f(leftOp);
+        return ExprProd<left_t, right_t> { mapped, mapped };
+      }
+    }
+    return ExprProd<left_t, right_t> { f(leftOp), f(rightOp) };
+  }
 };
 
 template <ExprType ET1, ExprType ET2>
-constexpr ExprProd<ET1, ET2> operator*(ET1 const& expr1, ET2 const& expr2) {
-  return { expr1, expr2 };
+constexpr auto operator*(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprProd<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
 }
 
+/// Common format in which the operands of a division or a modulo are
+/// adapted before computing the result
+template <ExprType ET1, ExprType ET2> struct DivisionFormat {
+ private:
+  static constexpr Format format = divisionFormat(
+      { ET1::width, ET1::signedness }, { ET2::width, ET2::signedness });
+
+ public:
+  static constexpr uint32_t width = format.width;
+  static constexpr bool signedness = format.signedness;
+  using repr_t = ap_repr<width, signedness>;
+
+  template <ExprType ET> static constexpr repr_t adapt(ET const& source) {
+    using adaptor = Adaptor<SignExtension, Forbid, ReinterpretSign>;
+    return adaptor::template adapt<width, signedness>(source).compute();
+  }
+};
+
 template <ExprType ET1, ExprType ET2> class ExprDiv {
   using prop = ExprArithProp<ET1, ET2>;
 
@@ -484,23 +805,22 @@ template <ExprType ET1, ExprType ET2> class ExprDiv {
       , rightOp { val2 } {}
 
   constexpr res_t compute() const {
-    using tightOverset = TightOverset<ET1, ET2>;
-    constexpr bool bothSigned = ET1::signedness && ET2::signedness;
-    constexpr uint32_t toWidth =
-        (bothSigned && (tightOverset::width == ET1::width))
-            ? tightOverset::width + 1
-            : tightOverset::width;
-    constexpr bool toSign = tightOverset::signedness;
-    using adaptor = Adaptor<SignExtension, Forbid, ReinterpretSign>;
-    return static_cast<res_t>(
-        adaptor::template adapt<toWidth, toSign>(leftOp).compute() /
-        adaptor::template adapt<toWidth, toSign>(rightOp).compute());
+    using format = DivisionFormat<ET1, ET2>;
+    return static_cast<res_t>(format::adapt(leftOp) / format::adapt(rightOp));
+  }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ExprDiv<left_t, right_t> { f(leftOp), f(rightOp) };
   }
 };
 
 template <ExprType ET1, ExprType ET2>
-constexpr ExprDiv<ET1, ET2> operator/(ET1 const& expr1, ET2 const& expr2) {
-  return { expr1, expr2 };
+constexpr auto operator/(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprDiv<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
 }
 
 template <ExprType ET1, ExprType ET2> class ExprMod {
@@ -519,24 +839,22 @@ template <ExprType ET1, ExprType ET2> class ExprMod {
       , rightOp { val2 } {}
 
   constexpr res_t compute() const {
-    using tightOverset = TightOverset<ET1, ET2>;
-    constexpr bool bothSigned = ET1::signedness && ET2::signedness;
-    constexpr uint32_t toWidth =
-        (bothSigned && (tightOverset::width == ET1::width))
-            ? tightOverset::width + 1
-            : tightOverset::width;
-    constexpr bool toSign = tightOverset::signedness;
+    using format = DivisionFormat<ET1, ET2>;
+    return static_cast<res_t>(format::adapt(leftOp) % format::adapt(rightOp));
+  }
 
-    using adaptor = Adaptor<SignExtension, Forbid, ReinterpretSign>;
-    return static_cast<res_t>(
-        adaptor::template adapt<toWidth, toSign>(leftOp).compute() %
-        adaptor::template adapt<toWidth, toSign>(rightOp).compute());
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ExprMod<left_t, right_t> { f(leftOp), f(rightOp) };
   }
 };
 
 template <ExprType ET1, ExprType ET2>
-constexpr ExprMod<ET1, ET2> operator%(ET1 const& expr1, ET2 const& expr2) {
-  return { expr1, expr2 };
+constexpr auto operator%(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprMod<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
 }
 
 template <ExprType ET1, ExprType ET2, bool sub> class ExprSumBase {
@@ -565,22 +883,31 @@ template <ExprType ET1, ExprType ET2, bool sub> class ExprSumBase {
       return { lExt + rExt };
     }
   }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ExprSumBase<left_t, right_t, sub> { f(leftOp), f(rightOp) };
+  }
 };
 
 template <ExprType ET1, ExprType ET2>
 using ExprSum = ExprSumBase<ET1, ET2, false>;
 
 template <ExprType ET1, ExprType ET2>
-constexpr ExprSum<ET1, ET2> operator+(ET1 const& expr1, ET2 const& expr2) {
-  return { expr1, expr2 };
+constexpr auto operator+(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprSum<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
 }
 
 template <ExprType ET1, ExprType ET2>
 using ExprSub = ExprSumBase<ET1, ET2, true>;
 
 template <ExprType ET1, ExprType ET2>
-constexpr ExprSub<ET1, ET2> operator-(ET1 const& expr1, ET2 const& expr2) {
-  return { expr1, expr2 };
+constexpr auto operator-(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprSub<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
 }
 
 //*************** Comparisons *********************************************//
@@ -0,0 +1,472 @@
+#ifndef FLOAT_HPP
+#define FLOAT_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#include "aliases.hpp"
+#include "expression.hpp"
+#include "limbs.hpp"
+#include "value.hpp"
+
+namespace apintext {
+/// Binary floating-point numbers with expBits exponent bits and mantBits
+/// fraction bits, encoded as IEEE 754 interchange formats: sign, biased
+/// exponent and fraction from the most to the least significant bits, with
+/// subnormals, infinities and NaNs.
+///
+/// Operations compute the exact result as a significand and the weight of
+/// its least significant bit, normalize it with a leading zero count, and
+/// round it once to nearest, ties to even, from its guard, round and sticky
+/// bits. Results are bit-exact, except for NaNs which are all returned as
+/// the canonical quiet NaN.
+template <uint32_t expBits, uint32_t mantBits> struct FloatFormat {
+  static_assert(expBits >= 2 && expBits <= 32,
+                "Float exponents should have 2 to 32 bits");
+  static_assert(mantBits >= 1, "Floats should have a fraction");
+
+  static constexpr uint32_t width = 1 + expBits + mantBits;
+  static constexpr int64_t bias = (int64_t { 1 } << (expBits - 1)) - 1;
+  static constexpr int64_t minExp = 1 - bias;
+  static constexpr int64_t maxExp = bias;
+  using bits_t = ap_repr<width, false>;
+  /// Significands, with their leading one
+  using sig_t = ap_repr<mantBits + 1, false>;
+
+  static constexpr bits_t signBit() { return bits_t { 1 } << (width - 1); }
+  static constexpr bits_t infinity(bool sign) {
+    bits_t const inf = ((bits_t { 1 } << expBits) - bits_t { 1 }) << mantBits;
+    return sign ? inf | signBit() : inf;
+  }
+  static constexpr bits_t zero(bool sign) {
+    return sign ? signBit() : bits_t { 0 };
+  }
+  static constexpr bits_t quietNaN() {
+    return infinity(false) | (bits_t { 1 } << (mantBits - 1));
+  }
+};
+
+namespace detail {
+enum class FloatClass { zero, finite, infinite, nan };
+
+/// Exact value of a float: (-1)^sign * sig * 2^lsb, with a normalized
+/// significand for finite values, subnormals included
+template <uint32_t expBits, uint32_t mantBits> struct UnpackedFloat {
+  using format = FloatFormat<expBits, mantBits>;
+  bool sign;
+  FloatClass kind;
+  typename format::sig_t sig;
+  int64_t lsb;
+};
+
+template <uint32_t expBits, uint32_t mantBits>
+constexpr UnpackedFloat<expBits, mantBits>
+unpackFloat(ap_repr<1 + expBits + mantBits, false> const& bits) {
+  using format = FloatFormat<expBits, mantBits>;
+  using bits_t = typename format::bits_t;
+  using sig_t = typename format::sig_t;
+  bool const sign = (bits & format::signBit()) != bits_t { 0 };
+  auto const exp = static_cast<int64_t>(static_cast<uint64_t>(
+      (bits >> mantBits) & ((bits_t { 1 } << expBits) - bits_t { 1 })));
+  sig_t const frac = static_cast<sig_t>(
+      bits & ((bits_t { 1 } << mantBits) - bits_t { 1 }));
+  if (exp == 2 * format::bias + 1)
+    return { sign,
+             (frac == sig_t { 0 }) ? FloatClass::infinite : FloatClass::nan,
+             frac, 0 };
+  if (exp != 0)
+    return { sign, FloatClass::finite, frac | (sig_t { 1 } << mantBits),
+             exp - format::bias - mantBits };
+  if (frac == sig_t { 0 })
+    return { sign, FloatClass::zero, frac, 0 };
+  // Subnormals are normalized by their leading zero count
+  uint32_t const shift = mantBits + 1 - bitLength<mantBits + 1>(frac);
+  return { sign, FloatClass::finite, frac << shift,
+           format::minExp - mantBits - static_cast<int64_t>(shift) };
+}
+
+/// Whether bits [0, count) of value are not all zero
+template <uint32_t w>
+constexpr bool anyLowBit(ap_repr<w, false> const& value, uint64_t count) {
+  auto const limbs = toLimbs<w>(value);
+  for (std::size_t i = 0; i < limbs.size() && 64 * i < count; ++i) {
+    uint64_t const mask = (count >= 64 * i + 64)
+                              ? ~uint64_t { 0 }
+                              : (uint64_t { 1 } << (count - 64 * i)) - 1;
+    if ((limbs[i] & mask) != 0)
+      return true;
+  }
+  return false;
+}
+
+/// Encoding of (-1)^sign * sig * 2^lsb, for a non-zero sig, rounded to
+/// nearest, ties to even
+template <uint32_t expBits, uint32_t mantBits, uint32_t w>
+constexpr ap_repr<1 + expBits + mantBits, false>
+roundFloat(bool sign, ap_repr<w, false> const& sig, int64_t lsb) {
+  using format = FloatFormat<expBits, mantBits>;
+  using bits_t = typename format::bits_t;
+  int64_t const top = lsb + bitLength<w>(sig) - 1;
+  if (top > format::maxExp)
+    return format::infinity(sign);
+
+  // Weight of the last kept bit, which is fixed below the normal range
+  int64_t const target =
+      ((top > format::minExp) ? top : format::minExp) - mantBits;
+  int64_t const drop = target - lsb;
+  using kept_t = ap_repr<mantBits + 2, false>;
+  kept_t kept { 0 };
+  bool round = false, sticky = false;
+  if (drop <= 0) {
+    kept = static_cast<kept_t>(sig) << static_cast<uint32_t>(-drop);
+  } else if (drop > w) {
+    sticky = true;
+  } else {
+    auto const dropped = static_cast<uint64_t>(drop);
+    if (dropped < w)
+      kept = static_cast<kept_t>(sig >> dropped);
+    round = (static_cast<uint64_t>(sig >> (dropped - 1)) & 1) != 0;
+    sticky = anyLowBit<w>(sig, dropped - 1);
+  }
+  if (round && (sticky || (static_cast<uint64_t>(kept) & 1) != 0))
+    kept = kept + kept_t { 1 };
+
+  // The leading one of normal values, or the carry out of the rounding of
+  // a subnormal, adds one to the exponent field
+  using wide_t = ap_repr<1 + expBits + mantBits + 1, false>;
+  wide_t const biased = static_cast<wide_t>(
+      static_cast<uint64_t>(target + mantBits + format::bias - 1));
+  wide_t const magnitude = (biased << mantBits) + static_cast<wide_t>(kept);
+  if (!(magnitude < static_cast<wide_t>(format::infinity(false))))
+    return format::infinity(sign);
+  bits_t const res = static_cast<bits_t>(magnitude);
+  return sign ? res | format::signBit() : res;
+}
+
+/// Sum of two signed significands, aligned in a window wide enough for
+/// the rounding of the sum: the larger operand fits in it, and the bits of
+/// the smaller one below it are jammed in its last bit
+template <uint32_t wx, uint32_t wy> struct AlignedSum {
+  static constexpr uint32_t width = wx + wy + 5;
+  using window_t = ap_repr<width, false>;
+  bool sign;
+  window_t sum;
+  int64_t lsb;
+};
+
+/// v * 2^lsb in a window of w bits whose last bit weighs 2^windowLsb, the
+/// bits of v below the window being jammed in the last bit
+template <uint32_t w, uint32_t wv>
+constexpr ap_repr<w, false> placeInWindow(ap_repr<wv, false> const& v,
+                                          int64_t lsb, int64_t windowLsb) {
+  using window_t = ap_repr<w, false>;
+  if (lsb >= windowLsb)
+    return static_cast<window_t>(v) << static_cast<uint32_t>(lsb - windowLsb);
+  auto const shift = static_cast<uint64_t>(windowLsb - lsb);
+  if (shift >= wv)
+    return window_t { 1 };
+  window_t const sticky { anyLowBit<wv>(v, shift) ? 1u : 0u };
+  return static_cast<window_t>(v >> shift) | sticky;
+}
+
+template <uint32_t wx, uint32_t wy>
+constexpr AlignedSum<wx, wy>
+alignedSum(bool signX, ap_repr<wx, false> const& x, int64_t lsbX,
+           bool signY, ap_repr<wy, false> const& y, int64_t lsbY) {
+  using res_t = AlignedSum<wx, wy>;
+  using window_t = typename res_t::window_t;
+  constexpr uint32_t w = res_t::width;
+  int64_t const topX = lsbX + bitLength<wx>(x);
+  int64_t const topY = lsbY + bitLength<wy>(y);
+  int64_t const windowLsb = ((topX > topY) ? topX : topY) + 1 - int64_t { w };
+  window_t const alignedX = placeInWindow<w, wx>(x, lsbX, windowLsb);
+  window_t const alignedY = placeInWindow<w, wy>(y, lsbY, windowLsb);
+  if (signX == signY)
+    return { signX, alignedX + alignedY, windowLsb };
+  if (alignedY < alignedX)
+    return { signX, alignedX - alignedY, windowLsb };
+  return { signY, alignedY - alignedX, windowLsb };
+}
+
+/// Rounded sum of two finite non-zero values, +0 for exact cancellations
+template <uint32_t expBits, uint32_t mantBits, uint32_t wx, uint32_t wy>
+constexpr ap_repr<1 + expBits + mantBits, false>
+roundedSum(bool signX, ap_repr<wx, false> const& x, int64_t lsbX, bool signY,
+           ap_repr<wy, false> const& y, int64_t lsbY) {
+  auto const sum = alignedSum<wx, wy>(signX, x, lsbX, signY, y, lsbY);
+  if (sum.sum == typename AlignedSum<wx, wy>::window_t { 0 })
+    return FloatFormat<expBits, mantBits>::zero(false);
+  return roundFloat<expBits, mantBits, AlignedSum<wx, wy>::width>(
+      sum.sign, sum.sum, sum.lsb);
+}
+
+/// Exact product of two significands
+template <uint32_t mantBits>
+constexpr ap_repr<2 * mantBits + 2, false>
+sigProduct(ap_repr<mantBits + 1, false> const& a,
+           ap_repr<mantBits + 1, false> const& b) {
+  return (Value<mantBits + 1, false> { a } * Value<mantBits + 1, false> { b })
+      .compute();
+}
+} // namespace detail
+
+struct FloatAdd {
+  template <uint32_t expBits, uint32_t mantBits, typename Bits>
+  static constexpr Bits compute(Bits const& a, Bits const& b) {
+    using format = FloatFormat<expBits, mantBits>;
+    using detail::FloatClass;
+    auto const x = detail::unpackFloat<expBits, mantBits>(a);
+    auto const y = detail::unpackFloat<expBits, mantBits>(b);
+    if (x.kind == FloatClass::nan || y.kind == FloatClass::nan)
+      return format::quietNaN();
+    if (x.kind == FloatClass::infinite || y.kind == FloatClass::infinite) {
+      if (x.kind == y.kind && x.sign != y.sign)
+        return format::quietNaN();
+      return format::infinity((x.kind == FloatClass::infinite) ? x.sign
+                                                               : y.sign);
+    }
+    if (y.kind == FloatClass::zero)
+      return (x.kind == FloatClass::zero) ? format::zero(x.sign && y.sign)
+                                          : a;
+    if (x.kind == FloatClass::zero)
+      return b;
+    return detail::roundedSum<expBits, mantBits, mantBits + 1, mantBits + 1>(
+        x.sign, x.sig, x.lsb, y.sign, y.sig, y.lsb);
+  }
+};
+
+struct FloatSub {
+  template <uint32_t expBits, uint32_t mantBits, typename Bits>
+  static constexpr Bits compute(Bits const& a, Bits const& b) {
+    using format = FloatFormat<expBits, mantBits>;
+    return FloatAdd::compute<expBits, mantBits>(a, b ^ format::signBit());
+  }
+};
+
+struct FloatMul {
+  template <uint32_t expBits, uint32_t mantBits, typename Bits>
+  static constexpr Bits compute(Bits const& a, Bits const& b) {
+    using format = FloatFormat<expBits, mantBits>;
+    using detail::FloatClass;
+    auto const x = detail::unpackFloat<expBits, mantBits>(a);
+    auto const y = detail::unpackFloat<expBits, mantBits>(b);
+    bool const sign = x.sign != y.sign;
+    if (x.kind == FloatClass::nan || y.kind == FloatClass::nan)
+      return format::quietNaN();
+    if (x.kind == FloatClass::infinite || y.kind == FloatClass::infinite) {
+      if (x.kind == FloatClass::zero || y.kind == FloatClass::zero)
+        return format::quietNaN();
+      return format::infinity(sign);
+    }
+    if (x.kind == FloatClass::zero || y.kind == FloatClass::zero)
+      return format::zero(sign);
+    return detail::roundFloat<expBits, mantBits, 2 * mantBits + 2>(
+        sign, detail::sigProduct<mantBits>(x.sig, y.sig), x.lsb + y.lsb);
+  }
+};
+
+/// a * b + c with a single rounding
+struct FloatFma {
+  template <uint32_t expBits, uint32_t mantBits, typename Bits>
+  static constexpr Bits compute(Bits const& a, Bits const& b, Bits const& c) {
+    using format = FloatFormat<expBits, mantBits>;
+    using detail::FloatClass;
+    auto const x = detail::unpackFloat<expBits, mantBits>(a);
+    auto const y = detail::unpackFloat<expBits, mantBits>(b);
+    auto const z = detail::unpackFloat<expBits, mantBits>(c);
+    bool const sign = x.sign != y.sign;
+    if (x.kind == FloatClass::nan || y.kind == FloatClass::nan ||
+        z.kind == FloatClass::nan)
+      return format::quietNaN();
+    if (x.kind == FloatClass::infinite || y.kind == FloatClass::infinite) {
+      if (x.kind == FloatClass::zero || y.kind == FloatClass::zero ||
+          (z.kind == FloatClass::infinite && z.sign != sign))
+        return format::quietNaN();
+      return format::infinity(sign);
+    }
+    if (z.kind == FloatClass::infinite)
+      return c;
+    if (x.kind == FloatClass::zero || y.kind == FloatClass::zero)
+      return (z.kind == FloatClass::zero) ? format::zero(sign && z.sign) : c;
+    auto const prod = detail::sigProduct<mantBits>(x.sig, y.sig);
+    if (z.kind == FloatClass::zero)
+      return detail::roundFloat<expBits, mantBits, 2 * mantBits + 2>(
+          sign, prod, x.lsb + y.lsb);
+    return detail::roundedSum<expBits, mantBits, 2 * mantBits + 2,
+                              mantBits + 1>(sign, prod, x.lsb + y.lsb, z.sign,
+                                            z.sig, z.lsb);
+  }
+};
+
+/// Floating-point operation Op on expressions holding the encodings of
+/// their operands
+template <uint32_t expBits, uint32_t mantBits, typename Op,
+          ExprType... Operands>
+class FloatOpExpr {
+ public:
+  static constexpr uint32_t width = 1 + expBits + mantBits;
+  static constexpr bool signedness = false;
+  static_assert(((Operands::width == width) && ...),
+                "Float operands should be as wide as their encoding");
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  std::tuple<Operands...> ops;
+
+ public:
+  constexpr FloatOpExpr(Operands const&... operands)
+      : ops { operands... } {}
+
+  constexpr res_t compute() const {
+    return std::apply(
+        [](auto const&... operands) {
+          return Op::template compute<expBits, mantBits>(
+              static_cast<res_t>(operands.compute())...);
+        },
+        ops);
+  }
+
+  constexpr auto operands() const {
+    return std::apply(
+        [](auto const&... operands) { return std::tie(operands...); }, ops);
+  }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    return std::apply(
+        [&](auto const&... operands) {
+          return FloatOpExpr<expBits, mantBits, Op,
+                             std::decay_t<decltype(f(operands))>...> {
+            f(operands)...
+          };
+        },
+        ops);
+  }
+};
+
+template <uint32_t expBits, uint32_t mantBits, ExprType ET1, ExprType ET2>
+constexpr auto floatAdd(ET1 const& a, ET2 const& b) {
+  using node_t = FloatOpExpr<expBits, mantBits, FloatAdd, operand_t<ET1>,
+                             operand_t<ET2>>;
+  return node_t { toOperand(a), toOperand(b) };
+}
+
+template <uint32_t expBits, uint32_t mantBits, ExprType ET1, ExprType ET2>
+constexpr auto floatSub(ET1 const& a, ET2 const& b) {
+  using node_t = FloatOpExpr<expBits, mantBits, FloatSub, operand_t<ET1>,
+                             operand_t<ET2>>;
+  return node_t { toOperand(a), toOperand(b) };
+}
+
+template <uint32_t expBits, uint32_t mantBits, ExprType ET1, ExprType ET2>
+constexpr auto floatMul(ET1 const& a, ET2 const& b) {
+  using node_t = FloatOpExpr<expBits, mantBits, FloatMul, operand_t<ET1>,
+                             operand_t<ET2>>;
+  return node_t { toOperand(a), toOperand(b) };
+}
+
+template <uint32_t expBits, uint32_t mantBits, ExprType ET1, ExprType ET2,
+          ExprType ET3>
+constexpr auto floatFma(ET1 const& a, ET2 const& b, ET3 const& c) {
+  using node_t = FloatOpExpr<expBits, mantBits, FloatFma, operand_t<ET1>,
+                             operand_t<ET2>, operand_t<ET3>>;
+  return node_t { toOperand(a), toOperand(b), toOperand(c) };
+}
+
+/// Floating-point value of the format FloatFormat<expBits, mantBits>, e.g.
+/// Float<5, 10> for binary16, Float<8, 23> for binary32 or Float<8, 7> for
+/// bfloat16. Arithmetic operators round to nearest, ties to even.
+template <uint32_t expBits, uint32_t mantBits> class Float {
+ public:
+  using format = FloatFormat<expBits, mantBits>;
+  static constexpr uint32_t width = format::width;
+  using bits_t = typename format::bits_t;
+
+ private:
+  bits_t encoding;
+
+  template <uint32_t, uint32_t> friend class Float;
+
+ public:
+  /// Positive zero
+  constexpr Float()
+      : encoding { 0 } {}
+
+  static constexpr Float fromBits(bits_t const& bits) {
+    Float res;
+    res.encoding = bits;
+    return res;
+  }
+
+  /// Value of another format, rounded to nearest, ties to even
+  template <uint32_t e, uint32_t m>
+  explicit constexpr Float(Float<e, m> const& other)
+      : encoding { 0 } {
+    using detail::FloatClass;
+    auto const x = detail::unpackFloat<e, m>(other.encoding);
+    switch (x.kind) {
+    case FloatClass::nan:
+      encoding = format::quietNaN();
+      break;
+    case FloatClass::infinite:
+      encoding = format::infinity(x.sign);
+      break;
+    case FloatClass::zero:
+      encoding = format::zero(x.sign);
+      break;
+    case FloatClass::finite:
+      encoding =
+          detail::roundFloat<expBits, mantBits, m + 1>(x.sign, x.sig, x.lsb);
+    }
+  }
+
+  explicit constexpr Float(double value)
+      : Float(Float<11, 52>::fromBits(ap_repr<64, false> {
+            std::bit_cast<uint64_t>(value) })) {}
+
+  explicit constexpr operator double() const {
+    return std::bit_cast<double>(
+        static_cast<uint64_t>(Float<11, 52> { *this }.encoding));
+  }
+
+  constexpr bits_t bits() const { return encoding; }
+
+  constexpr bool isNaN() const {
+    return detail::unpackFloat<expBits, mantBits>(encoding).kind ==
+           detail::FloatClass::nan;
+  }
+
+  constexpr Float operator-() const {
+    return fromBits(encoding ^ format::signBit());
+  }
+
+  friend constexpr Float operator+(Float const& a, Float const& b) {
+    return fromBits(FloatAdd::compute<expBits, mantBits>(a.encoding,
+                                                         b.encoding));
+  }
+  friend constexpr Float operator-(Float const& a, Float const& b) {
+    return fromBits(FloatSub::compute<expBits, mantBits>(a.encoding,
+                                                         b.encoding));
+  }
+  friend constexpr Float operator*(Float const& a, Float const& b) {
+    return fromBits(FloatMul::compute<expBits, mantBits>(a.encoding,
+                                                         b.encoding));
+  }
+  friend constexpr Float fma(Float const& a, Float const& b, Float const& c) {
+    return fromBits(FloatFma::compute<expBits, mantBits>(
+        a.encoding, b.encoding, c.encoding));
+  }
+
+  /// IEEE equality: NaNs differ from everything, zeros of both signs are
+  /// equal
+  friend constexpr bool operator==(Float const& a, Float const& b) {
+    if (a.isNaN() || b.isNaN())
+      return false;
+    bits_t const magnitudes = (a.encoding | b.encoding) & ~format::signBit();
+    return a.encoding == b.encoding || magnitudes == bits_t { 0 };
+  }
+};
+} // namespace apintext
+
+#endif // FLOAT_HPP
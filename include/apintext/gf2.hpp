@@ -0,0 +1,237 @@
+#ifndef GF2_HPP
+#define GF2_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+
+#include "aliases.hpp"
+#include "cost.hpp"
+#include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
+
+namespace apintext {
+/// Arithmetic on polynomials over GF(2), whose coefficients are the bits of
+/// unsigned values: bit i is the coefficient of x^i. Additions are XORs,
+/// products are carry-less multiplications.
+namespace detail {
+/// Carry-less 64x64 -> 128 product, lowered to a single pclmulqdq when the
+/// target has it
+constexpr uint64_t clmulWide(uint64_t a, uint64_t b, uint64_t& high) {
+#if defined(__PCLMUL__)
+  if (!std::is_constant_evaluated()) {
+    __m128i const prod =
+        _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(a)),
+                             _mm_cvtsi64_si128(static_cast<long long>(b)), 0);
+    high = static_cast<uint64_t>(
+        _mm_cvtsi128_si64(_mm_unpackhi_epi64(prod, prod)));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(prod));
+  }
+#endif
+  uint64_t low = 0;
+  high = 0;
+  for (uint32_t i = 0; i < 64; ++i) {
+    uint64_t const mask = uint64_t { 0 } - ((b >> i) & 1);
+    low ^= (a << i) & mask;
+    if (i != 0)
+      high ^= (a >> (64 - i)) & mask;
+  }
+  return low;
+}
+
+/// M low limbs of the carry-less product of a and b, limb by limb
+template <std::size_t M, std::size_t Na, std::size_t Nb>
+constexpr limbs_t<M> limbClmul(limbs_t<Na> const& a, limbs_t<Nb> const& b) {
+  limbs_t<M> res {};
+  for (std::size_t i = 0; i < Na && i < M; ++i) {
+    for (std::size_t j = 0; j < Nb && i + j < M; ++j) {
+      uint64_t high;
+      res[i + j] ^= clmulWide(a[i], b[j], high);
+      if (i + j + 1 < M)
+        res[i + j + 1] ^= high;
+    }
+  }
+  return res;
+}
+
+/// The M low limbs of a, whose bits from bits on are cleared
+template <std::size_t M, std::size_t N>
+constexpr limbs_t<M> lowBits(limbs_t<N> const& a, uint32_t bits) {
+  limbs_t<M> res {};
+  for (std::size_t i = 0; i < M && i < N; ++i) {
+    if (64 * i + 64 <= bits)
+      res[i] = a[i];
+    else if (64 * i < bits)
+      res[i] = a[i] & ((uint64_t { 1 } << (bits % 64)) - 1);
+  }
+  return res;
+}
+
+/// floor(x^(2d) / P) for the polynomial P = x^d + R, computed by long
+/// division
+template <uint32_t d>
+constexpr limbs_t<limbCount(d + 1)>
+barrettConstant(limbs_t<limbCount(d)> const& low) {
+  constexpr std::size_t L = limbCount(d + 1);
+  limbs_t<L> rem {}, quot {};
+  for (uint32_t i = 2 * d + 1; i-- > 0;) {
+    rem = limbShl(rem, 1);
+    if (i == 2 * d)
+      rem[0] |= 1;
+    if ((rem[d / 64] >> (d % 64)) & 1) {
+      rem[d / 64] ^= uint64_t { 1 } << (d % 64);
+      for (std::size_t j = 0; j < low.size(); ++j)
+        rem[j] ^= low[j];
+      quot[i / 64] |= uint64_t { 1 } << (i % 64);
+    }
+  }
+  return quot;
+}
+
+/// Remainder of the w-bit polynomial x by P = x^d + R, given
+/// mu = barrettConstant<d>(R).
+///
+/// x is reduced d bits at a time from its top, by Horner's rule: the
+/// remainder of (acc * x^d + chunk), whose degree is below 2d, is computed
+/// by Barrett reduction with two carry-less products.
+template <uint32_t d, uint32_t w>
+constexpr limbs_t<limbCount(d)>
+limbPolyMod(limbs_t<limbCount(w)> const& x,
+            limbs_t<limbCount(d)> const& low,
+            limbs_t<limbCount(d + 1)> const& mu) {
+  constexpr std::size_t D = limbCount(d);
+  constexpr uint32_t chunks = (w + d - 1) / d;
+  auto chunk = [&](uint32_t k) {
+    return lowBits<D>(limbShr(x, k * d, 0), d);
+  };
+  limbs_t<D> acc = chunk(chunks - 1);
+  for (uint32_t k = chunks - 1; k-- > 0;) {
+    // q = floor(acc * mu / x^d) is the quotient of acc * x^d + chunk by P,
+    // whose remainder is then chunk + low d bits of q * R
+    auto const prod = limbClmul<limbCount(2 * d)>(acc, mu);
+    auto const q = lowBits<D>(limbShr(prod, d, 0), d);
+    auto const qr = lowBits<D>(limbClmul<D>(q, low), d);
+    auto const c = chunk(k);
+    for (std::size_t j = 0; j < D; ++j)
+      acc[j] = c[j] ^ qr[j];
+  }
+  return acc;
+}
+} // namespace detail
+
+/// Polynomial over GF(2) given by the exponents of its terms, highest
+/// first, e.g. Polynomial<32, 26, 23, 22, 16, 12, 11, 10, 8, 7, 5, 4, 2, 1,
+/// 0> for CRC-32 or Polynomial<128, 7, 2, 1, 0> for GHASH.
+template <uint32_t d, uint32_t... lowerExponents> struct Polynomial {
+  static_assert(d > 0, "Polynomial degree should be positive");
+  static_assert(((lowerExponents < d) && ...),
+                "Exponents should be listed highest first");
+
+  static constexpr uint32_t degree = d;
+
+ private:
+  static constexpr detail::limbs_t<detail::limbCount(d)> makeLow() {
+    detail::limbs_t<detail::limbCount(d)> res {};
+    ((res[lowerExponents / 64] |= uint64_t { 1 } << (lowerExponents % 64)),
+     ...);
+    return res;
+  }
+
+ public:
+  /// Terms below the degree, i.e. x^d mod the polynomial
+  static constexpr detail::limbs_t<detail::limbCount(d)> low = makeLow();
+  static constexpr detail::limbs_t<detail::limbCount(d + 1)> barrett =
+      detail::barrettConstant<d>(low);
+};
+
+/// Carry-less product of the bits of two expressions, whose width is
+/// wa + wb - 1
+template <ExprType ET1, ExprType ET2> class ExprClmul {
+ public:
+  static constexpr uint32_t width = ET1::width + ET2::width - 1;
+  static constexpr bool signedness = false;
+  using res_t = ap_repr<width, signedness>;
+  ET1 const leftOp;
+  ET2 const rightOp;
+
+ public:
+  constexpr ExprClmul(ET1 const& val1, ET2 const& val2)
+      : leftOp { val1 }
+      , rightOp { val2 } {}
+
+  constexpr res_t compute() const {
+    auto const a = detail::toLimbs<ET1::width>(
+        static_cast<ap_repr<ET1::width, false>>(leftOp.compute()));
+    auto const b = detail::toLimbs<ET2::width>(
+        static_cast<ap_repr<ET2::width, false>>(rightOp.compute()));
+    return detail::fromLimbs<width>(
+        detail::limbClmul<detail::limbCount(width)>(a, b));
+  }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return ExprClmul<left_t, right_t> { f(leftOp), f(rightOp) };
+  }
+};
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto clmul(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprClmul<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+template <ExprType ET1, ExprType ET2> struct NodeCost<ExprClmul<ET1, ET2>> {
+  static constexpr uint64_t value =
+      detail::limbCount(ET1::width) * detail::limbCount(ET2::width);
+};
+
+/// Remainder of the bits of an expression by the polynomial Poly, whose
+/// width is the degree of Poly
+template <typename Poly, ExprType ET> class ExprPolyMod {
+ public:
+  static constexpr uint32_t width = Poly::degree;
+  static constexpr bool signedness = false;
+  using res_t = ap_repr<width, signedness>;
+  ET const source;
+
+ public:
+  constexpr ExprPolyMod(ET const& src)
+      : source { src } {}
+
+  constexpr res_t compute() const {
+    auto const x = detail::toLimbs<ET::width>(
+        static_cast<ap_repr<ET::width, false>>(source.compute()));
+    return detail::fromLimbs<width>(
+        detail::limbPolyMod<width, ET::width>(x, Poly::low, Poly::barrett));
+  }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ExprPolyMod<Poly, mapped_t> { f(source) };
+  }
+};
+
+template <typename Poly, ExprType ET>
+constexpr auto polyMod(ET const& expr) {
+  using node_t = ExprPolyMod<Poly, operand_t<ET>>;
+  return node_t { toOperand(expr) };
+}
+
+/// Two carry-less products of the degree per reduced chunk
+template <typename Poly, ExprType ET> struct NodeCost<ExprPolyMod<Poly, ET>> {
+  static constexpr uint64_t value =
+      2 * uint64_t { (ET::width + Poly::degree - 1) / Poly::degree } *
+      detail::limbCount(Poly::degree + 1) * detail::limbCount(Poly::degree);
+};
+} // namespace apintext
+
+#endif // GF2_HPP
@@ -0,0 +1,293 @@
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "aliases.hpp"
+#include "expression.hpp"
+#include "traversal.hpp"
+#include "value.hpp"
+
+namespace apintext {
+
+/// Incremental evaluation of expression DAGs.
+///
+/// A SignalGraph holds named signals: inputs, which are set by the user,
+/// and derived signals, defined by an expression whose leaves may be other
+/// signals. Derived signals cache their value. Setting an input to a new
+/// value marks the signals downstream of it dirty, and dirty signals are
+/// only recomputed when read. A recomputed signal whose value is unchanged
+/// does not trigger the recomputation of its own dependents, so the work
+/// done is proportional to what actually changed.
+///
+/// Graphs are not thread-safe, and signal handles are valid as long as
+/// their graph is.
+class SignalGraph;
+
+namespace detail {
+class SignalNode {
+ private:
+  std::string nodeName;
+  std::vector<SignalNode*> dependencies;
+  std::vector<SignalNode*> dependents;
+  bool dirty = true;
+  /// Graph clock when the value last changed, and when it was last checked
+  /// against its dependencies
+  uint64_t changedAt = 0;
+  uint64_t checkedAt = 0;
+
+ protected:
+  SignalGraph& graph;
+
+  /// Recompute the value, returning whether it changed
+  virtual bool evaluate() = 0;
+
+  void markChanged();
+  void markClean();
+
+ public:
+  SignalNode(SignalGraph& graph, std::string name)
+      : nodeName { std::move(name) }
+      , graph { graph } {}
+  SignalNode(SignalNode const&) = delete;
+  SignalNode& operator=(SignalNode const&) = delete;
+  virtual ~SignalNode() = default;
+
+  std::string const& name() const { return nodeName; }
+  bool isDirty() const { return dirty; }
+
+  void addDependency(SignalNode& dependency) {
+    dependencies.push_back(&dependency);
+    dependency.dependents.push_back(this);
+  }
+
+  /// Mark the signals downstream of this one dirty
+  void invalidateDependents() {
+    std::vector<SignalNode*> pending { dependents };
+    while (!pending.empty()) {
+      SignalNode* node = pending.back();
+      pending.pop_back();
+      if (node->dirty)
+        continue;
+      node->dirty = true;
+      pending.insert(pending.end(), node->dependents.begin(),
+                     node->dependents.end());
+    }
+  }
+
+  /// Bring the value up to date, recomputing it only if one of its
+  /// dependencies changed since it was last checked
+  void refresh();
+};
+} // namespace detail
+
+class SignalGraph {
+ private:
+  std::vector<std::unique_ptr<detail::SignalNode>> nodes;
+  std::unordered_map<std::string, detail::SignalNode*> byName;
+  uint64_t clock = 0;
+  uint64_t evaluationCount = 0;
+
+  friend class detail::SignalNode;
+
+  template <typename Node>
+  Node& addNode(std::unique_ptr<Node> node) {
+    if (!byName.emplace(node->name(), node.get()).second)
+      throw std::invalid_argument("Duplicate signal name: " + node->name());
+    Node& res = *node;
+    nodes.push_back(std::move(node));
+    return res;
+  }
+
+ public:
+  SignalGraph() = default;
+  SignalGraph(SignalGraph const&) = delete;
+  SignalGraph& operator=(SignalGraph const&) = delete;
+
+  template <uint32_t w, bool s> class Signal;
+  template <uint32_t w, bool s> class Input;
+
+  template <uint32_t w, bool s>
+  Input<w, s> input(std::string name, Value<w, s> const& init = {});
+
+  /// Derived signal computing expr. The signals among the leaves of expr
+  /// are its dependencies, other leaves are copied as constants.
+  template <ExprType ET>
+  Signal<ET::width, ET::signedness> define(std::string name, ET const& expr);
+
+  /// Handle to the signal called name, which should have format (w, s)
+  template <uint32_t w, bool s> Signal<w, s> find(std::string const& name);
+
+  /// Bring all the dirty signals up to date
+  void settle() {
+    for (auto& node : nodes)
+      node->refresh();
+  }
+
+  std::size_t size() const { return nodes.size(); }
+
+  /// Number of expression evaluations done by derived signals so far
+  uint64_t evaluations() const { return evaluationCount; }
+};
+
+namespace detail {
+inline void SignalNode::markChanged() { changedAt = ++graph.clock; }
+
+inline void SignalNode::markClean() {
+  checkedAt = graph.clock;
+  dirty = false;
+}
+
+inline void SignalNode::refresh() {
+  if (!dirty)
+    return;
+  bool stale = (checkedAt == 0);
+  for (SignalNode* dependency : dependencies) {
+    dependency->refresh();
+    stale |= dependency->changedAt > checkedAt;
+  }
+  if (stale) {
+    ++graph.evaluationCount;
+    if (evaluate())
+      markChanged();
+  }
+  markClean();
+}
+
+template <uint32_t w, bool s> class ValueNode : public SignalNode {
+ protected:
+  ap_repr<w, s> value { 0 };
+
+ public:
+  using SignalNode::SignalNode;
+
+  ap_repr<w, s> const& get() {
+    refresh();
+    return value;
+  }
+};
+
+template <uint32_t w, bool s> class InputNode final : public ValueNode<w, s> {
+ protected:
+  bool evaluate() override { return false; }
+
+ public:
+  InputNode(SignalGraph& graph, std::string name, ap_repr<w, s> init)
+      : ValueNode<w, s>(graph, std::move(name)) {
+    this->value = init;
+    this->markChanged();
+    this->markClean();
+  }
+
+  void set(ap_repr<w, s> const& newValue) {
+    if (newValue == this->value)
+      return;
+    this->value = newValue;
+    this->markChanged();
+    this->invalidateDependents();
+  }
+};
+
+template <ExprType ET>
+class DerivedNode final : public ValueNode<ET::width, ET::signedness> {
+ private:
+  ET const expr;
+
+ protected:
+  bool evaluate() override {
+    auto const newValue = expr.compute();
+    if (newValue == this->value)
+      return false;
+    this->value = newValue;
+    return true;
+  }
+
+ public:
+  DerivedNode(SignalGraph& graph, std::string name, ET const& expr)
+      : ValueNode<ET::width, ET::signedness>(graph, std::move(name))
+      , expr { expr } {}
+};
+} // namespace detail
+
+/// Handle to a signal, which is an expression reading its up to date value
+template <uint32_t w, bool s> class SignalGraph::Signal {
+ public:
+  static constexpr uint32_t width = w;
+  static constexpr bool signedness = s;
+
+ protected:
+  detail::ValueNode<w, s>* node;
+
+  friend class SignalGraph;
+
+ public:
+  explicit Signal(detail::ValueNode<w, s>& node)
+      : node { &node } {}
+
+  ap_repr<w, s> compute() const { return node->get(); }
+  std::string const& name() const { return node->name(); }
+};
+
+template <uint32_t w, bool s>
+class SignalGraph::Input : public SignalGraph::Signal<w, s> {
+ public:
+  explicit Input(detail::InputNode<w, s>& node)
+      : Signal<w, s> { node } {}
+
+  /// Set the value, invalidating the signals depending on it if it changed
+  void set(Value<w, s> const& newValue) {
+    static_cast<detail::InputNode<w, s>*>(this->node)->set(
+        newValue.compute());
+  }
+};
+
+template <uint32_t w, bool s>
+SignalGraph::Input<w, s> SignalGraph::input(std::string name,
+                                            Value<w, s> const& init) {
+  return Input<w, s> { addNode(std::make_unique<detail::InputNode<w, s>>(
+      *this, std::move(name), init.compute())) };
+}
+
+namespace detail {
+template <typename T> struct IsSignal : std::false_type {};
+
+template <uint32_t w, bool s>
+struct IsSignal<SignalGraph::Signal<w, s>> : std::true_type {};
+
+template <uint32_t w, bool s>
+struct IsSignal<SignalGraph::Input<w, s>> : std::true_type {};
+} // namespace detail
+
+template <ExprType ET>
+SignalGraph::Signal<ET::width, ET::signedness>
+SignalGraph::define(std::string name, ET const& expr) {
+  auto& node = addNode(
+      std::make_unique<detail::DerivedNode<ET>>(*this, std::move(name), expr));
+  transformLeaves(expr, [&node](auto const& leaf) {
+    if constexpr (detail::IsSignal<std::decay_t<decltype(leaf)>>::value)
+      node.addDependency(*leaf.node);
+    return leaf;
+  });
+  return Signal<ET::width, ET::signedness> { node };
+}
+
+template <uint32_t w, bool s>
+SignalGraph::Signal<w, s> SignalGraph::find(std::string const& name) {
+  auto const it = byName.find(name);
+  if (it == byName.end())
+    throw std::out_of_range("Unknown signal: " + name);
+  auto* node = dynamic_cast<detail::ValueNode<w, s>*>(it->second);
+  if (node == nullptr)
+    throw std::invalid_argument("Signal format mismatch: " + name);
+  return Signal<w, s> { *node };
+}
+} // namespace apintext
+
+#endif // INCREMENTAL_HPP
@@ -0,0 +1,321 @@
+#ifndef INTERPRETER_HPP
+#define INTERPRETER_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "arith_prop.hpp"
+#include "runtime_ir.hpp"
+#include "runtime_kernels.hpp"
+
+namespace apintext {
+namespace ir {
+namespace detail {
+/// Instruction of the interpreter. Operands and results are registers,
+/// given by their offset in the limb arena.
+struct Instruction {
+  Opcode op;
+  Format format;
+  Format lhsFormat;
+  Format rhsFormat;
+  uint32_t dst;
+  uint32_t lhs;
+  uint32_t rhs;
+  /// Low bit of slices
+  uint32_t imm;
+};
+
+inline bool isBinary(Opcode op) {
+  switch (op) {
+  case Opcode::Sum:
+  case Opcode::Sub:
+  case Opcode::Prod:
+  case Opcode::Div:
+  case Opcode::Mod:
+  case Opcode::And:
+  case Opcode::Or:
+  case Opcode::Xor:
+  case Opcode::Eq:
+  case Opcode::Ne:
+  case Opcode::Lt:
+  case Opcode::Le:
+  case Opcode::Gt:
+  case Opcode::Ge:
+    return true;
+  default:
+    return false;
+  }
+}
+} // namespace detail
+
+/// Bytecode interpreter of programs, with the same calling convention as
+/// the compiled programs.
+///
+/// Each node value lives in a register of the limb arena, allocated once
+/// when the interpreter is built: registers are reused after the last use
+/// of their value, and evaluation does not allocate. An interpreter should
+/// not be used by several threads at once, it can be copied instead.
+class Interpreter {
+ private:
+  std::vector<detail::Instruction> code;
+  std::vector<uint64_t> arena;
+  /// Registers of the inputs and of the outputs
+  std::vector<std::pair<uint32_t, Format>> inputRegs;
+  std::vector<std::pair<uint32_t, Format>> outputRegs;
+  /// Scratch space of the divisions
+  uint32_t scratch = 0;
+
+  void divide(detail::Instruction const& instr) {
+    namespace kernels = apintext::detail;
+    Format const format = divisionFormat(instr.lhsFormat, instr.rhsFormat);
+    std::size_t const n = kernels::limbCount(format.width);
+    uint64_t* const quot = arena.data() + scratch;
+    uint64_t* const rem = quot + n;
+    kernels::divModExtended(quot, rem, arena.data() + instr.lhs,
+                            instr.lhsFormat, arena.data() + instr.rhs,
+                            instr.rhsFormat, rem + n);
+    uint64_t* const dst = arena.data() + instr.dst;
+    kernels::copyExtended(dst, kernels::limbCount(instr.format.width),
+                          (instr.op == Opcode::Div) ? quot : rem, format);
+  }
+
+  void execute(detail::Instruction const& instr) {
+    namespace kernels = apintext::detail;
+    uint64_t* const dst = arena.data() + instr.dst;
+    uint64_t const* const lhs = arena.data() + instr.lhs;
+    uint64_t const* const rhs = arena.data() + instr.rhs;
+    Format const lf = instr.lhsFormat;
+    Format const rf = instr.rhsFormat;
+    std::size_t const n = kernels::limbCount(instr.format.width);
+    switch (instr.op) {
+    case Opcode::Sum:
+      kernels::addExtended(dst, n, lhs, lf, rhs, rf);
+      break;
+    case Opcode::Sub:
+      kernels::subExtended(dst, n, lhs, lf, rhs, rf);
+      break;
+    case Opcode::Prod:
+      kernels::mulExtended(dst, n, lhs, lf, rhs, rf);
+      break;
+    case Opcode::Div:
+    case Opcode::Mod:
+      divide(instr);
+      break;
+    case Opcode::ZExt:
+      for (std::size_t i = 0; i < n; ++i)
+        dst[i] = kernels::unsignedLimb(lhs, lf, i);
+      break;
+    case Opcode::SExt:
+    case Opcode::Reinterpret:
+      kernels::copyExtended(dst, n, lhs, lf);
+      break;
+    case Opcode::Slice:
+    case Opcode::DynSlice:
+      kernels::sliceLimbs(dst, n, lhs, lf, instr.imm);
+      break;
+    case Opcode::And:
+      for (std::size_t i = 0; i < n; ++i)
+        dst[i] = lhs[i] & rhs[i];
+      break;
+    case Opcode::Or:
+      for (std::size_t i = 0; i < n; ++i)
+        dst[i] = lhs[i] | rhs[i];
+      break;
+    case Opcode::Xor:
+      for (std::size_t i = 0; i < n; ++i)
+        dst[i] = lhs[i] ^ rhs[i];
+      break;
+    case Opcode::Not:
+      for (std::size_t i = 0; i < n; ++i)
+        dst[i] = ~lhs[i];
+      break;
+    case Opcode::OrReduce:
+    case Opcode::NorReduce:
+    case Opcode::AndReduce:
+    case Opcode::XorReduce: {
+      std::size_t const srcLimbs = kernels::limbCount(lf.width);
+      uint64_t any = 0;
+      uint64_t all = ~uint64_t { 0 };
+      uint64_t parity = 0;
+      for (std::size_t i = 0; i < srcLimbs; ++i) {
+        uint64_t const limb = kernels::unsignedLimb(lhs, lf, i);
+        any |= limb;
+        all &= (i == srcLimbs - 1 && lf.width % 64 != 0)
+                   ? limb | (~uint64_t { 0 } << (lf.width % 64))
+                   : limb;
+        parity ^= limb;
+      }
+      switch (instr.op) {
+      case Opcode::OrReduce:
+        dst[0] = any != 0;
+        break;
+      case Opcode::NorReduce:
+        dst[0] = any == 0;
+        break;
+      case Opcode::AndReduce:
+        dst[0] = all == ~uint64_t { 0 };
+        break;
+      default:
+        dst[0] = std::popcount(parity) & 1;
+        break;
+      }
+      return;
+    }
+    case Opcode::Input:
+    case Opcode::Constant:
+      return;
+    default: {
+      int const cmp = kernels::compareExtended(lhs, lf, rhs, rf);
+      bool res;
+      switch (instr.op) {
+      case Opcode::Eq:
+        res = cmp == 0;
+        break;
+      case Opcode::Ne:
+        res = cmp != 0;
+        break;
+      case Opcode::Lt:
+        res = cmp < 0;
+        break;
+      case Opcode::Le:
+        res = cmp <= 0;
+        break;
+      case Opcode::Gt:
+        res = cmp > 0;
+        break;
+      default:
+        res = cmp >= 0;
+        break;
+      }
+      dst[0] = res;
+      return;
+    }
+    }
+    kernels::normalizeLimbs(dst, instr.format);
+  }
+
+ public:
+  explicit Interpreter(Program const& program) {
+    namespace kernels = apintext::detail;
+    auto const nodes = program.nodes();
+    // Nodes whose value is needed by an output
+    std::vector<bool> live(nodes.size(), false);
+    for (uint32_t id : program.outputs())
+      live[id] = true;
+    for (std::size_t i = nodes.size(); i-- > 0;) {
+      if (!live[i])
+        continue;
+      live[nodes[i].operands[0]] = true;
+      if (detail::isBinary(nodes[i].op))
+        live[nodes[i].operands[1]] = true;
+    }
+
+    // Index of the last instruction reading each node. Inputs, constants
+    // and outputs are live during the whole evaluation.
+    std::vector<std::size_t> lastUse(nodes.size(), 0);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      Node const& node = nodes[i];
+      if (node.op == Opcode::Input || node.op == Opcode::Constant ||
+          !live[i])
+        continue;
+      lastUse[node.operands[0]] = i;
+      if (detail::isBinary(node.op))
+        lastUse[node.operands[1]] = i;
+    }
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      if (nodes[i].op == Opcode::Input || nodes[i].op == Opcode::Constant)
+        lastUse[i] = nodes.size();
+    for (uint32_t id : program.outputs())
+      lastUse[id] = nodes.size();
+
+    // Registers freed after the last use of their value, by limb count
+    std::multimap<std::size_t, uint32_t> freeRegs;
+    std::vector<uint32_t> regs(nodes.size());
+    std::size_t scratchLimbs = 0;
+    inputRegs.resize(program.inputs().size());
+    auto allocate = [&](std::size_t limbs) {
+      auto const it = freeRegs.find(limbs);
+      if (it != freeRegs.end()) {
+        uint32_t const reg = it->second;
+        freeRegs.erase(it);
+        return reg;
+      }
+      uint32_t const reg = static_cast<uint32_t>(arena.size());
+      arena.resize(arena.size() + limbs);
+      return reg;
+    };
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      Node const& node = nodes[i];
+      bool const isLeaf =
+          node.op == Opcode::Input || node.op == Opcode::Constant;
+      if (!isLeaf && !live[i])
+        continue;
+      regs[i] = allocate(kernels::limbCount(node.format.width));
+      if (node.op == Opcode::Input) {
+        inputRegs[node.imm[0]] = { regs[i], node.format };
+        continue;
+      }
+      if (node.op == Opcode::Constant) {
+        auto const value = program.constantLimbs(node);
+        std::copy(value.begin(), value.end(), arena.begin() + regs[i]);
+        kernels::normalizeLimbs(arena.data() + regs[i], node.format);
+        continue;
+      }
+      Format const lhsFormat = nodes[node.operands[0]].format;
+      Format const rhsFormat = nodes[node.operands[1]].format;
+      if (node.op == Opcode::Div || node.op == Opcode::Mod) {
+        std::size_t const n = kernels::limbCount(
+            divisionFormat(lhsFormat, rhsFormat).width);
+        scratchLimbs =
+            std::max(scratchLimbs, 2 * n + kernels::divModScratch(n));
+      }
+      bool const isSlice = node.op == Opcode::Slice;
+      code.push_back({ node.op, node.format, lhsFormat, rhsFormat, regs[i],
+                       regs[node.operands[0]], regs[node.operands[1]],
+                       isSlice ? node.imm[1] : node.imm[0] });
+      // Free the operands after allocating the result, so that they are
+      // not overwritten while being read
+      std::size_t const operandCount = detail::isBinary(node.op) ? 2 : 1;
+      for (std::size_t k = 0; k < operandCount; ++k) {
+        uint32_t const operand = node.operands[k];
+        if (lastUse[operand] == i && (k == 0 || operand != node.operands[0]))
+          freeRegs.emplace(kernels::limbCount(nodes[operand].format.width),
+                           regs[operand]);
+      }
+    }
+    for (uint32_t id : program.outputs())
+      outputRegs.emplace_back(regs[id], nodes[id].format);
+    scratch = static_cast<uint32_t>(arena.size());
+    arena.resize(arena.size() + scratchLimbs);
+  }
+
+  /// inputs[i] points to the limbs of the i-th input, and the limbs of the
+  /// i-th output are written to outputs[i]
+  void operator()(uint64_t const* const* inputs, uint64_t* const* outputs) {
+    namespace kernels = apintext::detail;
+    for (std::size_t i = 0; i < inputRegs.size(); ++i) {
+      auto const [reg, format] = inputRegs[i];
+      std::copy_n(inputs[i], kernels::limbCount(format.width),
+                  arena.begin() + reg);
+      kernels::normalizeLimbs(arena.data() + reg, format);
+    }
+    for (detail::Instruction const& instr : code)
+      execute(instr);
+    for (std::size_t i = 0; i < outputRegs.size(); ++i) {
+      auto const [reg, format] = outputRegs[i];
+      std::copy_n(arena.begin() + reg, kernels::limbCount(format.width),
+                  outputs[i]);
+    }
+  }
+
+  /// Number of limbs of the arena
+  std::size_t arenaSize() const { return arena.size(); }
+};
+} // namespace ir
+} // namespace apintext
+
+#endif // INTERPRETER_HPP
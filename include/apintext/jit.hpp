@@ -0,0 +1,440 @@
+#ifndef JIT_HPP
+#define JIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <llvm/ADT/APInt.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include "limb_kernels.hpp"
+#include "runtime_ir.hpp"
+
+namespace apintext {
+namespace ir {
+namespace detail {
+/// Widest integer type supported by LLVM
+constexpr uint32_t maxJitWidth = (1u << 23) - 1;
+
+/// Unsigned division of len-limb operands, called by the generated code for
+/// the divisions too wide for the LLVM backend
+inline void jitDivMod(uint64_t const* u, uint64_t const* v, uint64_t* quot,
+                      uint64_t* rem, uint64_t len, uint64_t* scratch) {
+  apintext::detail::limbDivModN(u, v, quot, rem, len, scratch);
+}
+
+constexpr char const* jitDivModSymbol = "apintext_jit_divmod";
+
+[[noreturn]] inline void throwLLVMError(llvm::Error err) {
+  throw std::runtime_error(llvm::toString(std::move(err)));
+}
+
+template <typename T> T unwrap(llvm::Expected<T> expected) {
+  if (!expected)
+    throwLLVMError(expected.takeError());
+  return std::move(*expected);
+}
+
+/// Translation of a program to a function
+///   void f(uint64_t const* const* inputs, uint64_t* const* outputs)
+class Lowering {
+ private:
+  Program const& program;
+  llvm::LLVMContext& ctx;
+  llvm::Module& module;
+  llvm::IRBuilder<> builder;
+  std::vector<llvm::Value*> values;
+
+  llvm::IntegerType* intType(uint32_t width) {
+    return llvm::IntegerType::get(ctx, width);
+  }
+
+  static uint32_t limbBits(uint32_t width) {
+    return 64 * static_cast<uint32_t>(apintext::detail::limbCount(width));
+  }
+
+  /// Value of node id changed to width, extending it according to its
+  /// signedness or truncating it
+  llvm::Value* resized(uint32_t id, uint32_t width) {
+    return resized(values[id], program.nodes()[id].format, width);
+  }
+
+  llvm::Value* resized(llvm::Value* val, Format format, uint32_t width) {
+    if (width == format.width)
+      return val;
+    if (width < format.width)
+      return builder.CreateTrunc(val, intType(width));
+    return format.signedness ? builder.CreateSExt(val, intType(width))
+                             : builder.CreateZExt(val, intType(width));
+  }
+
+  llvm::Value* limbPointer(llvm::Value* array, uint32_t idx) {
+    auto* ptrType = llvm::Type::getInt64PtrTy(ctx);
+    auto* slot = builder.CreateConstInBoundsGEP1_64(ptrType, array, idx);
+    return builder.CreateLoad(ptrType, slot);
+  }
+
+  llvm::Value* lowerInput(Node const& node, llvm::Value* inputs) {
+    uint32_t const bits = limbBits(node.format.width);
+    auto* ptr = builder.CreateBitCast(limbPointer(inputs, node.imm[0]),
+                                      intType(bits)->getPointerTo());
+    auto* load = builder.CreateAlignedLoad(intType(bits), ptr,
+                                           llvm::MaybeAlign { 8 });
+    return resized(load, { bits, false }, node.format.width);
+  }
+
+  llvm::Value* lowerConstant(Node const& node) {
+    auto const limbs = program.constantLimbs(node);
+    llvm::APInt value { limbBits(node.format.width),
+                        llvm::ArrayRef<uint64_t> { limbs.data(),
+                                                   limbs.size() } };
+    return llvm::ConstantInt::get(ctx, value.trunc(node.format.width));
+  }
+
+  /// Array of len limbs on the stack
+  llvm::Value* limbArray(uint64_t len) {
+    return builder.CreateAlloca(builder.getInt64Ty(), builder.getInt64(len));
+  }
+
+  llvm::Value* storeLimbs(llvm::Value* val, uint32_t bits) {
+    auto* array = limbArray(bits / 64);
+    builder.CreateAlignedStore(
+        val, builder.CreateBitCast(array, intType(bits)->getPointerTo()),
+        llvm::MaybeAlign { 8 });
+    return array;
+  }
+
+  llvm::Value* loadLimbs(llvm::Value* array, uint32_t bits) {
+    return builder.CreateAlignedLoad(
+        intType(bits),
+        builder.CreateBitCast(array, intType(bits)->getPointerTo()),
+        llvm::MaybeAlign { 8 });
+  }
+
+  /// Unsigned quotient and remainder of width-bit values through the limb
+  /// division routine
+  std::pair<llvm::Value*, llvm::Value*>
+  callDivMod(llvm::Value* u, llvm::Value* v, uint32_t width) {
+    uint32_t const bits = limbBits(width);
+    auto* i64Ptr = llvm::Type::getInt64PtrTy(ctx);
+    auto* fnType = llvm::FunctionType::get(
+        builder.getVoidTy(),
+        { i64Ptr, i64Ptr, i64Ptr, i64Ptr, builder.getInt64Ty(), i64Ptr },
+        false);
+    auto callee = module.getOrInsertFunction(jitDivModSymbol, fnType);
+    auto* uArray = storeLimbs(builder.CreateZExt(u, intType(bits)), bits);
+    auto* vArray = storeLimbs(builder.CreateZExt(v, intType(bits)), bits);
+    auto* quot = limbArray(bits / 64);
+    auto* rem = limbArray(bits / 64);
+    auto* scratch = limbArray(2 * (bits / 64) + 1);
+    builder.CreateCall(callee, { uArray, vArray, quot, rem,
+                                 builder.getInt64(bits / 64), scratch });
+    return { builder.CreateTrunc(loadLimbs(quot, bits), intType(width)),
+             builder.CreateTrunc(loadLimbs(rem, bits), intType(width)) };
+  }
+
+  llvm::Value* lowerDivision(Node const& node) {
+    Node const& lhs = program.nodes()[node.operands[0]];
+    Node const& rhs = program.nodes()[node.operands[1]];
+    Format const format = divisionFormat(lhs.format, rhs.format);
+    auto* type = intType(format.width);
+    llvm::Value* u = resized(node.operands[0], format.width);
+    llvm::Value* v = resized(node.operands[1], format.width);
+    auto* zero = llvm::ConstantInt::get(type, 0);
+    auto* isZero = builder.CreateICmpEQ(v, zero);
+    llvm::Value *quot, *rem;
+    // Wider native divisions would be lowered to calls to the compiler
+    // runtime, which is not linked in the JIT
+    if (format.width <= 64) {
+      auto* divisor =
+          builder.CreateSelect(isZero, llvm::ConstantInt::get(type, 1), v);
+      quot = format.signedness ? builder.CreateSDiv(u, divisor)
+                               : builder.CreateUDiv(u, divisor);
+      rem = format.signedness ? builder.CreateSRem(u, divisor)
+                              : builder.CreateURem(u, divisor);
+    } else if (format.signedness) {
+      // Divide the magnitudes, then restore the signs of the truncated
+      // division results
+      auto* uNeg = builder.CreateICmpSLT(u, zero);
+      auto* vNeg = builder.CreateICmpSLT(v, zero);
+      auto* uAbs = builder.CreateSelect(uNeg, builder.CreateNeg(u), u);
+      auto* vAbs = builder.CreateSelect(vNeg, builder.CreateNeg(v), v);
+      auto [q, r] = callDivMod(uAbs, vAbs, format.width);
+      quot = builder.CreateSelect(builder.CreateXor(uNeg, vNeg),
+                                  builder.CreateNeg(q), q);
+      rem = builder.CreateSelect(uNeg, builder.CreateNeg(r), r);
+    } else {
+      std::tie(quot, rem) = callDivMod(u, v, format.width);
+    }
+    quot = builder.CreateSelect(
+        isZero, llvm::ConstantInt::getAllOnesValue(type), quot);
+    rem = builder.CreateSelect(isZero, u, rem);
+    return resized(node.op == Opcode::Div ? quot : rem, format,
+                   node.format.width);
+  }
+
+  llvm::Value* lowerComparison(Node const& node) {
+    Format const format =
+        tightOverset(program.nodes()[node.operands[0]].format,
+                     program.nodes()[node.operands[1]].format);
+    llvm::Value* lhs = resized(node.operands[0], format.width);
+    llvm::Value* rhs = resized(node.operands[1], format.width);
+    bool const s = format.signedness;
+    using Predicate = llvm::CmpInst::Predicate;
+    Predicate pred;
+    switch (node.op) {
+    case Opcode::Eq:
+      pred = Predicate::ICMP_EQ;
+      break;
+    case Opcode::Ne:
+      pred = Predicate::ICMP_NE;
+      break;
+    case Opcode::Lt:
+      pred = s ? Predicate::ICMP_SLT : Predicate::ICMP_ULT;
+      break;
+    case Opcode::Le:
+      pred = s ? Predicate::ICMP_SLE : Predicate::ICMP_ULE;
+      break;
+    case Opcode::Gt:
+      pred = s ? Predicate::ICMP_SGT : Predicate::ICMP_UGT;
+      break;
+    default:
+      pred = s ? Predicate::ICMP_SGE : Predicate::ICMP_UGE;
+      break;
+    }
+    return builder.CreateICmp(pred, lhs, rhs);
+  }
+
+  llvm::Value* lowerSlice(uint32_t src, uint32_t width, uint32_t lowBit) {
+    Format const format = program.nodes()[src].format;
+    if (lowBit >= format.width)
+      return llvm::ConstantInt::get(intType(width), 0);
+    llvm::Value* shifted = values[src];
+    if (lowBit != 0)
+      shifted = builder.CreateLShr(shifted, lowBit);
+    return resized(shifted, { format.width, false }, width);
+  }
+
+  llvm::Value* lowerNode(Node const& node, llvm::Value* inputs) {
+    uint32_t const width = node.format.width;
+    auto operand = [&](std::size_t i) {
+      return resized(node.operands[i], width);
+    };
+    switch (node.op) {
+    case Opcode::Input:
+      return lowerInput(node, inputs);
+    case Opcode::Constant:
+      return lowerConstant(node);
+    case Opcode::Sum:
+      return builder.CreateAdd(operand(0), operand(1));
+    case Opcode::Sub:
+      return builder.CreateSub(operand(0), operand(1));
+    case Opcode::Prod:
+      return builder.CreateMul(operand(0), operand(1));
+    case Opcode::Div:
+    case Opcode::Mod:
+      return lowerDivision(node);
+    case Opcode::ZExt:
+      return builder.CreateZExt(values[node.operands[0]], intType(width));
+    case Opcode::SExt:
+      return operand(0);
+    case Opcode::Reinterpret:
+      return values[node.operands[0]];
+    case Opcode::Slice:
+      return lowerSlice(node.operands[0], width, node.imm[1]);
+    case Opcode::DynSlice:
+      return lowerSlice(node.operands[0], width, node.imm[0]);
+    case Opcode::And:
+      return builder.CreateAnd(values[node.operands[0]],
+                               values[node.operands[1]]);
+    case Opcode::Or:
+      return builder.CreateOr(values[node.operands[0]],
+                              values[node.operands[1]]);
+    case Opcode::Xor:
+      return builder.CreateXor(values[node.operands[0]],
+                               values[node.operands[1]]);
+    case Opcode::Not:
+      return builder.CreateNot(values[node.operands[0]]);
+    case Opcode::OrReduce:
+      return builder.CreateIsNotNull(values[node.operands[0]]);
+    case Opcode::NorReduce:
+      return builder.CreateIsNull(values[node.operands[0]]);
+    case Opcode::AndReduce: {
+      llvm::Value* src = values[node.operands[0]];
+      return builder.CreateICmpEQ(
+          src, llvm::ConstantInt::getAllOnesValue(src->getType()));
+    }
+    case Opcode::XorReduce: {
+      llvm::Value* src = values[node.operands[0]];
+      auto* popCount = builder.CreateUnaryIntrinsic(llvm::Intrinsic::ctpop,
+                                                    src);
+      return builder.CreateTrunc(popCount, intType(1));
+    }
+    default:
+      return lowerComparison(node);
+    }
+  }
+
+ public:
+  Lowering(Program const& program, llvm::Module& module)
+      : program { program }
+      , ctx { module.getContext() }
+      , module { module }
+      , builder { module.getContext() } {}
+
+  void lower(std::string const& name) {
+    auto* ptrArrayType = llvm::Type::getInt64PtrTy(ctx)->getPointerTo();
+    auto* fnType = llvm::FunctionType::get(
+        builder.getVoidTy(), { ptrArrayType, ptrArrayType }, false);
+    auto* fn = llvm::Function::Create(
+        fnType, llvm::Function::ExternalLinkage, name, module);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(ctx, "entry", fn));
+    for (Node const& node : program.nodes()) {
+      if (node.format.width > maxJitWidth)
+        throw std::invalid_argument("Expression too wide for the JIT");
+      values.push_back(lowerNode(node, fn->getArg(0)));
+    }
+    for (std::size_t i = 0; i < program.outputs().size(); ++i) {
+      uint32_t const id = program.outputs()[i];
+      uint32_t const bits = limbBits(program.nodes()[id].format.width);
+      auto* ptr = builder.CreateBitCast(
+          limbPointer(fn->getArg(1), static_cast<uint32_t>(i)),
+          intType(bits)->getPointerTo());
+      builder.CreateAlignedStore(resized(id, bits), ptr,
+                                 llvm::MaybeAlign { 8 });
+    }
+    builder.CreateRetVoid();
+    if (llvm::verifyFunction(*fn, &llvm::errs()))
+      throw std::logic_error("Invalid function generated for the program");
+  }
+};
+
+inline void optimize(llvm::Module& module) {
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  llvm::PassBuilder passBuilder;
+  passBuilder.registerModuleAnalyses(mam);
+  passBuilder.registerCGSCCAnalyses(cgam);
+  passBuilder.registerFunctionAnalyses(fam);
+  passBuilder.registerLoopAnalyses(lam);
+  passBuilder.crossRegisterProxies(lam, fam, cgam, mam);
+  passBuilder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2)
+      .run(module, mam);
+}
+} // namespace detail
+
+/// Native code of a program, valid as long as the Jit which compiled it
+class CompiledProgram {
+ public:
+  using function_t = void (*)(uint64_t const* const*, uint64_t* const*);
+
+ private:
+  function_t function;
+
+ public:
+  explicit CompiledProgram(function_t function)
+      : function { function } {}
+
+  /// inputs[i] points to the limbs of the i-th input, and the limbs of the
+  /// i-th output are written to outputs[i]
+  void operator()(uint64_t const* const* inputs,
+                  uint64_t* const* outputs) const {
+    function(inputs, outputs);
+  }
+};
+
+/// Compiler of programs to native code through LLVM ORC, caching the
+/// compiled programs by structure. Compilation is thread-safe.
+class Jit {
+ private:
+  std::unique_ptr<llvm::orc::LLJIT> engine;
+  mutable std::mutex mutex;
+  std::unordered_map<uint64_t, std::vector<std::pair<Program, CompiledProgram>>>
+      cache;
+  std::size_t compiledCount = 0;
+
+  CompiledProgram build(Program const& program) {
+    auto ctx = std::make_unique<llvm::LLVMContext>();
+    std::string const name =
+        "apintext_program_" + std::to_string(compiledCount++);
+    auto module = std::make_unique<llvm::Module>(name, *ctx);
+    module->setDataLayout(engine->getDataLayout());
+    module->setTargetTriple(engine->getTargetTriple().str());
+    detail::Lowering { program, *module }.lower(name);
+    detail::optimize(*module);
+    if (auto err = engine->addIRModule(llvm::orc::ThreadSafeModule {
+            std::move(module), std::move(ctx) }))
+      detail::throwLLVMError(std::move(err));
+    auto symbol = detail::unwrap(engine->lookup(name));
+#if LLVM_VERSION_MAJOR >= 15
+    return CompiledProgram { symbol.toPtr<CompiledProgram::function_t>() };
+#else
+    return CompiledProgram { reinterpret_cast<CompiledProgram::function_t>(
+        symbol.getAddress()) };
+#endif
+  }
+
+ public:
+  Jit() {
+    static bool const initialized = [] {
+      llvm::InitializeNativeTarget();
+      llvm::InitializeNativeTargetAsmPrinter();
+      return true;
+    }();
+    (void)initialized;
+    engine = detail::unwrap(llvm::orc::LLJITBuilder {}.create());
+    llvm::orc::SymbolMap helpers;
+    helpers[engine->mangleAndIntern(detail::jitDivModSymbol)] =
+        llvm::JITEvaluatedSymbol(
+            llvm::pointerToJITTargetAddress(&detail::jitDivMod),
+            llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable);
+    if (auto err = engine->getMainJITDylib().define(
+            llvm::orc::absoluteSymbols(std::move(helpers))))
+      detail::throwLLVMError(std::move(err));
+  }
+
+  Jit(Jit const&) = delete;
+  Jit& operator=(Jit const&) = delete;
+
+  /// Native code of program, compiled on the first request for a program of
+  /// that structure
+  CompiledProgram compile(Program const& program) {
+    uint64_t const hash = program.structuralHash();
+    std::lock_guard lock { mutex };
+    auto& bucket = cache[hash];
+    for (auto const& [cached, compiled] : bucket)
+      if (cached == program)
+        return compiled;
+    CompiledProgram const res = build(program);
+    bucket.emplace_back(program, res);
+    return res;
+  }
+
+  /// Number of programs compiled so far, cache hits excluded
+  std::size_t compiledPrograms() const {
+    std::lock_guard lock { mutex };
+    return compiledCount;
+  }
+};
+} // namespace ir
+} // namespace apintext
+
+#endif // JIT_HPP
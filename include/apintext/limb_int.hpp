@@ -0,0 +1,508 @@
+#ifndef LIMB_INT_HPP
+#define LIMB_INT_HPP
+
+#include <array>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "limb_kernels.hpp"
+
+namespace apintext {
+template <uint32_t w, bool s> class SmallInt;
+
+/// Fixed width two's complement integer stored in 64-bit limbs, with the
+/// same semantics as _ExtInt(w): wrapping arithmetic, truncating division,
+/// arithmetic right shift for signed types. Its operations are implemented
+/// by the limb kernels for the limb count known at compile time, instead of
+/// depending on how the compiler legalizes wide integers.
+///
+/// Invariant: the bits of the most significant limb above w are a copy of
+/// the sign bit for signed types and zero for unsigned ones.
+template <uint32_t w, bool s> class LimbInt {
+  static_assert(w > 0, "LimbInt width should be positive");
+
+ public:
+  static constexpr std::size_t limbCount = (w + 63) / 64;
+  using limbs_t = detail::limbs_t<limbCount>;
+
+ private:
+  static constexpr uint32_t topBits = w - 64 * (limbCount - 1);
+  limbs_t limbs;
+
+  constexpr void normalize() {
+    if constexpr (topBits < 64) {
+      uint64_t& top = limbs[limbCount - 1];
+      if constexpr (s) {
+        top = static_cast<uint64_t>(
+            static_cast<int64_t>(top << (64 - topBits)) >> (64 - topBits));
+      } else {
+        top &= (uint64_t { 1 } << topBits) - 1;
+      }
+    }
+  }
+
+  constexpr uint64_t fillLimb() const {
+    if constexpr (s) {
+      return (static_cast<int64_t>(limbs[limbCount - 1]) < 0) ? ~uint64_t { 0 }
+                                                            : 0;
+    } else {
+      return 0;
+    }
+  }
+
+  constexpr bool isNegative() const {
+    if constexpr (s) {
+      return static_cast<int64_t>(limbs[limbCount - 1]) < 0;
+    } else {
+      return false;
+    }
+  }
+
+  /// The w-bit pattern of the value, without sign extension
+  constexpr limbs_t rawBits() const {
+    limbs_t res = limbs;
+    if constexpr (topBits < 64)
+      res[limbCount - 1] &= (uint64_t { 1 } << topBits) - 1;
+    return res;
+  }
+
+  template <uint32_t, bool> friend class LimbInt;
+
+ public:
+  constexpr LimbInt()
+      : limbs {} {}
+
+  template <std::integral I>
+  constexpr LimbInt(I val)
+      : limbs {} {
+    limbs[0] = static_cast<uint64_t>(val);
+    uint64_t fill = (std::is_signed_v<I> && val < 0) ? ~uint64_t { 0 } : 0;
+    for (std::size_t i = 1; i < limbCount; ++i)
+      limbs[i] = fill;
+    normalize();
+  }
+
+  /// Width and signedness conversion: the source is sign extended if it is
+  /// signed, zero extended otherwise, then truncated to w bits.
+  template <uint32_t ws, bool ss>
+  constexpr explicit LimbInt(LimbInt<ws, ss> const& src)
+      : limbs {} {
+    uint64_t fill = src.fillLimb();
+    for (std::size_t i = 0; i < limbCount; ++i)
+      limbs[i] = (i < LimbInt<ws, ss>::limbCount) ? src.limbs[i] : fill;
+    normalize();
+  }
+
+  template <uint32_t ws, bool ss>
+  constexpr explicit LimbInt(SmallInt<ws, ss> const& src)
+      : limbs {} {
+    auto const srcLimbs = src.getLimbs();
+    uint64_t const fill =
+        (ss && static_cast<int64_t>(srcLimbs.back()) < 0) ? ~uint64_t { 0 } : 0;
+    for (std::size_t i = 0; i < limbCount; ++i)
+      limbs[i] = (i < srcLimbs.size()) ? srcLimbs[i] : fill;
+    normalize();
+  }
+
+  static constexpr LimbInt fromLimbs(limbs_t const& src) {
+    LimbInt res;
+    res.limbs = src;
+    res.normalize();
+    return res;
+  }
+
+  constexpr limbs_t const& getLimbs() const { return limbs; }
+
+  template <std::integral I> constexpr explicit operator I() const {
+    if constexpr (std::is_same_v<I, bool>) {
+      return *this != LimbInt {};
+    } else {
+      return static_cast<I>(limbs[0]);
+    }
+  }
+
+  //******************* Arithmetic *****************************//
+
+  friend constexpr LimbInt operator+(LimbInt const& a, LimbInt const& b) {
+    return fromLimbs(detail::limbAdd(a.limbs, b.limbs));
+  }
+
+  friend constexpr LimbInt operator-(LimbInt const& a, LimbInt const& b) {
+    return fromLimbs(detail::limbSub(a.limbs, b.limbs));
+  }
+
+  friend constexpr LimbInt operator*(LimbInt const& a, LimbInt const& b) {
+    return fromLimbs(detail::limbMul(a.limbs, b.limbs));
+  }
+
+  friend constexpr LimbInt operator/(LimbInt const& a, LimbInt const& b) {
+    LimbInt quot, rem;
+    divMod(a, b, quot, rem);
+    return quot;
+  }
+
+  friend constexpr LimbInt operator%(LimbInt const& a, LimbInt const& b) {
+    LimbInt quot, rem;
+    divMod(a, b, quot, rem);
+    return rem;
+  }
+
+  /// Truncating division, the remainder takes the sign of the dividend
+  static constexpr void divMod(LimbInt const& a, LimbInt const& b,
+                               LimbInt& quot, LimbInt& rem) {
+    bool const negA = a.isNegative();
+    bool const negB = b.isNegative();
+    limbs_t q {}, r {};
+    detail::limbDivMod((negA ? -a : a).rawBits(), (negB ? -b : b).rawBits(), q,
+                       r);
+    quot = fromLimbs(q);
+    rem = fromLimbs(r);
+    if (negA != negB)
+      quot = -quot;
+    if (negA)
+      rem = -rem;
+  }
+
+  friend constexpr LimbInt operator-(LimbInt const& a) {
+    return LimbInt {} - a;
+  }
+
+  friend constexpr LimbInt operator+(LimbInt const& a) { return a; }
+
+  //******************* Bitwise ********************************//
+
+  friend constexpr LimbInt operator&(LimbInt const& a, LimbInt const& b) {
+    LimbInt res;
+    detail::limbFor<limbCount>(
+        [&](std::size_t i) { res.limbs[i] = a.limbs[i] & b.limbs[i]; });
+    return res;
+  }
+
+  friend constexpr LimbInt operator|(LimbInt const& a, LimbInt const& b) {
+    LimbInt res;
+    detail::limbFor<limbCount>(
+        [&](std::size_t i) { res.limbs[i] = a.limbs[i] | b.limbs[i]; });
+    return res;
+  }
+
+  friend constexpr LimbInt operator^(LimbInt const& a, LimbInt const& b) {
+    LimbInt res;
+    detail::limbFor<limbCount>(
+        [&](std::size_t i) { res.limbs[i] = a.limbs[i] ^ b.limbs[i]; });
+    return res;
+  }
+
+  friend constexpr LimbInt operator~(LimbInt const& a) {
+    LimbInt res;
+    detail::limbFor<limbCount>(
+        [&](std::size_t i) { res.limbs[i] = ~a.limbs[i]; });
+    res.normalize();
+    return res;
+  }
+
+  template <std::integral I>
+  friend constexpr LimbInt operator<<(LimbInt const& a, I shift) {
+    return fromLimbs(
+        detail::limbShl<limbCount>(a.limbs, static_cast<uint32_t>(shift)));
+  }
+
+  template <std::integral I>
+  friend constexpr LimbInt operator>>(LimbInt const& a, I shift) {
+    return fromLimbs(detail::limbShr<limbCount>(
+        a.limbs, static_cast<uint32_t>(shift), a.fillLimb()));
+  }
+
+  //******************* Comparisons ****************************//
+
+  friend constexpr bool operator==(LimbInt const& a, LimbInt const& b) {
+    return a.limbs == b.limbs;
+  }
+
+  friend constexpr std::strong_ordering operator<=>(LimbInt const& a,
+                                                    LimbInt const& b) {
+    if constexpr (s) {
+      auto topA = static_cast<int64_t>(a.limbs[limbCount - 1]);
+      auto topB = static_cast<int64_t>(b.limbs[limbCount - 1]);
+      if (topA != topB)
+        return topA <=> topB;
+    } else {
+      if (a.limbs[limbCount - 1] != b.limbs[limbCount - 1])
+        return a.limbs[limbCount - 1] <=> b.limbs[limbCount - 1];
+    }
+    for (std::size_t i = limbCount - 1; i-- > 0;) {
+      if (a.limbs[i] != b.limbs[i])
+        return a.limbs[i] <=> b.limbs[i];
+    }
+    return std::strong_ordering::equal;
+  }
+
+  //******************* Compound assignment ********************//
+
+  constexpr LimbInt& operator+=(LimbInt const& o) { return *this = *this + o; }
+  constexpr LimbInt& operator-=(LimbInt const& o) { return *this = *this - o; }
+  constexpr LimbInt& operator*=(LimbInt const& o) { return *this = *this * o; }
+  constexpr LimbInt& operator/=(LimbInt const& o) { return *this = *this / o; }
+  constexpr LimbInt& operator%=(LimbInt const& o) { return *this = *this % o; }
+  constexpr LimbInt& operator&=(LimbInt const& o) { return *this = *this & o; }
+  constexpr LimbInt& operator|=(LimbInt const& o) { return *this = *this | o; }
+  constexpr LimbInt& operator^=(LimbInt const& o) { return *this = *this ^ o; }
+  template <std::integral I> constexpr LimbInt& operator<<=(I shift) {
+    return *this = *this << shift;
+  }
+  template <std::integral I> constexpr LimbInt& operator>>=(I shift) {
+    return *this = *this >> shift;
+  }
+  constexpr LimbInt& operator++() { return *this += LimbInt { 1 }; }
+  constexpr LimbInt& operator--() { return *this -= LimbInt { 1 }; }
+  constexpr LimbInt operator++(int) {
+    LimbInt old = *this;
+    ++*this;
+    return old;
+  }
+  constexpr LimbInt operator--(int) {
+    LimbInt old = *this;
+    --*this;
+    return old;
+  }
+};
+
+/// Integer of at most 128 bits with the semantics of LimbInt, stored in a
+/// uint64_t or an unsigned __int128 so that its arithmetic is lowered to
+/// the same instructions as the native integers of these widths.
+///
+/// Invariant: the bits of the word above w are a copy of the sign bit for
+/// signed types and zero for unsigned ones.
+template <uint32_t w, bool s> class SmallInt {
+  static_assert(w > 0 && w <= 128, "SmallInt width should be in [1, 128]");
+
+ public:
+  static constexpr std::size_t limbCount = (w + 63) / 64;
+  using word_t =
+      std::conditional_t<(w <= 64), uint64_t, detail::uint128_t>;
+  using signed_word_t =
+      std::conditional_t<(w <= 64), int64_t, detail::int128_t>;
+
+ private:
+  static constexpr uint32_t wordBits = 64 * limbCount;
+  word_t word;
+
+  static constexpr word_t normalized(word_t val) {
+    if constexpr (w == wordBits) {
+      return val;
+    } else if constexpr (s) {
+      return static_cast<word_t>(
+          static_cast<signed_word_t>(val << (wordBits - w)) >>
+          (wordBits - w));
+    } else {
+      return val & ((word_t { 1 } << w) - 1);
+    }
+  }
+
+  static constexpr SmallInt fromWord(word_t val) {
+    SmallInt res;
+    res.word = normalized(val);
+    return res;
+  }
+
+  constexpr signed_word_t signedWord() const {
+    return static_cast<signed_word_t>(word);
+  }
+
+  static constexpr bool minusOne(SmallInt const& a) {
+    return a.word == normalized(~word_t { 0 });
+  }
+
+  static constexpr SmallInt minValue() {
+    return fromWord(word_t { 1 } << (w - 1));
+  }
+
+  template <uint32_t, bool> friend class SmallInt;
+
+ public:
+  constexpr SmallInt()
+      : word { 0 } {}
+
+  template <std::integral I>
+  constexpr SmallInt(I val)
+      : word { normalized(static_cast<word_t>(val)) } {}
+
+  /// Width and signedness conversion: the source is sign extended if it is
+  /// signed, zero extended otherwise, then truncated to w bits.
+  template <uint32_t ws, bool ss>
+  constexpr explicit SmallInt(SmallInt<ws, ss> const& src)
+      : word { normalized(
+            ss ? static_cast<word_t>(src.signedWord())
+               : static_cast<word_t>(src.word)) } {}
+
+  template <uint32_t ws, bool ss>
+  constexpr explicit SmallInt(LimbInt<ws, ss> const& src)
+      : word { 0 } {
+    auto const& srcLimbs = src.getLimbs();
+    uint64_t const fill =
+        (ss && static_cast<int64_t>(srcLimbs.back()) < 0) ? ~uint64_t { 0 } : 0;
+    word = srcLimbs[0];
+    if constexpr (limbCount > 1)
+      word |= static_cast<word_t>((srcLimbs.size() > 1) ? srcLimbs[1] : fill)
+              << 64;
+    word = normalized(word);
+  }
+
+  /// Limbs of the value, extended according to its signedness
+  constexpr detail::limbs_t<limbCount> getLimbs() const {
+    detail::limbs_t<limbCount> res {};
+    detail::unrolledFor<limbCount>([&](auto i) {
+      res[i] = static_cast<uint64_t>(word >> (64 * i));
+    });
+    return res;
+  }
+
+  template <std::integral I> constexpr explicit operator I() const {
+    if constexpr (std::is_same_v<I, bool>) {
+      return word != 0;
+    } else {
+      return static_cast<I>(word);
+    }
+  }
+
+  //******************* Arithmetic *****************************//
+
+  friend constexpr SmallInt operator+(SmallInt const& a, SmallInt const& b) {
+    return fromWord(a.word + b.word);
+  }
+
+  friend constexpr SmallInt operator-(SmallInt const& a, SmallInt const& b) {
+    return fromWord(a.word - b.word);
+  }
+
+  friend constexpr SmallInt operator*(SmallInt const& a, SmallInt const& b) {
+    return fromWord(a.word * b.word);
+  }
+
+  /// Truncating division. The overflowing signed division wraps, as the
+  /// quotient of LimbInt.
+  friend constexpr SmallInt operator/(SmallInt const& a, SmallInt const& b) {
+    if constexpr (s) {
+      if (a == minValue() && minusOne(b))
+        return a;
+      return fromWord(static_cast<word_t>(a.signedWord() / b.signedWord()));
+    } else {
+      return fromWord(a.word / b.word);
+    }
+  }
+
+  friend constexpr SmallInt operator%(SmallInt const& a, SmallInt const& b) {
+    if constexpr (s) {
+      if (minusOne(b))
+        return SmallInt {};
+      return fromWord(static_cast<word_t>(a.signedWord() % b.signedWord()));
+    } else {
+      return fromWord(a.word % b.word);
+    }
+  }
+
+  friend constexpr SmallInt operator-(SmallInt const& a) {
+    return fromWord(word_t { 0 } - a.word);
+  }
+
+  friend constexpr SmallInt operator+(SmallInt const& a) { return a; }
+
+  //******************* Bitwise ********************************//
+
+  friend constexpr SmallInt operator&(SmallInt const& a, SmallInt const& b) {
+    return fromWord(a.word & b.word);
+  }
+
+  friend constexpr SmallInt operator|(SmallInt const& a, SmallInt const& b) {
+    return fromWord(a.word | b.word);
+  }
+
+  friend constexpr SmallInt operator^(SmallInt const& a, SmallInt const& b) {
+    return fromWord(a.word ^ b.word);
+  }
+
+  friend constexpr SmallInt operator~(SmallInt const& a) {
+    return fromWord(~a.word);
+  }
+
+  template <std::integral I>
+  friend constexpr SmallInt operator<<(SmallInt const& a, I shift) {
+    return fromWord(a.word << shift);
+  }
+
+  template <std::integral I>
+  friend constexpr SmallInt operator>>(SmallInt const& a, I shift) {
+    if constexpr (s) {
+      return fromWord(static_cast<word_t>(a.signedWord() >> shift));
+    } else {
+      return fromWord(a.word >> shift);
+    }
+  }
+
+  //******************* Comparisons ****************************//
+
+  friend constexpr bool operator==(SmallInt const& a, SmallInt const& b) {
+    return a.word == b.word;
+  }
+
+  friend constexpr std::strong_ordering operator<=>(SmallInt const& a,
+                                                    SmallInt const& b) {
+    bool const less =
+        s ? a.signedWord() < b.signedWord() : a.word < b.word;
+    if (less)
+      return std::strong_ordering::less;
+    return (a.word == b.word) ? std::strong_ordering::equal
+                              : std::strong_ordering::greater;
+  }
+
+  //******************* Compound assignment ********************//
+
+  constexpr SmallInt& operator+=(SmallInt const& o) {
+    return *this = *this + o;
+  }
+  constexpr SmallInt& operator-=(SmallInt const& o) {
+    return *this = *this - o;
+  }
+  constexpr SmallInt& operator*=(SmallInt const& o) {
+    return *this = *this * o;
+  }
+  constexpr SmallInt& operator/=(SmallInt const& o) {
+    return *this = *this / o;
+  }
+  constexpr SmallInt& operator%=(SmallInt const& o) {
+    return *this = *this % o;
+  }
+  constexpr SmallInt& operator&=(SmallInt const& o) {
+    return *this = *this & o;
+  }
+  constexpr SmallInt& operator|=(SmallInt const& o) {
+    return *this = *this | o;
+  }
+  constexpr SmallInt& operator^=(SmallInt const& o) {
+    return *this = *this ^ o;
+  }
+  template <std::integral I> constexpr SmallInt& operator<<=(I shift) {
+    return *this = *this << shift;
+  }
+  template <std::integral I> constexpr SmallInt& operator>>=(I shift) {
+    return *this = *this >> shift;
+  }
+  constexpr SmallInt& operator++() { return *this += SmallInt { 1 }; }
+  constexpr SmallInt& operator--() { return *this -= SmallInt { 1 }; }
+  constexpr SmallInt operator++(int) {
+    SmallInt old = *this;
+    ++*this;
+    return old;
+  }
+  constexpr SmallInt operator--(int) {
+    SmallInt old = *this;
+    --*this;
+    return old;
+  }
+};
+} // namespace apintext
+
+#endif // LIMB_INT_HPP
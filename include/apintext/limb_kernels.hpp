@@ -0,0 +1,351 @@
+#ifndef LIMB_KERNELS_HPP
+#define LIMB_KERNELS_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace apintext {
+namespace detail {
+__extension__ using uint128_t = unsigned __int128;
+__extension__ using int128_t = __int128;
+
+template <std::size_t N> using limbs_t = std::array<uint64_t, N>;
+
+constexpr std::size_t limbCount(uint32_t width) { return (width + 63) / 64; }
+
+/// Call f(integral_constant<i>) for i in [0, N), fully unrolled.
+template <std::size_t N, typename F> constexpr void unrolledFor(F&& f) {
+  [&]<std::size_t... I>(std::index_sequence<I...>) {
+    (f(std::integral_constant<std::size_t, I> {}), ...);
+  }
+  (std::make_index_sequence<N> {});
+}
+
+/// Above this limb count, the kernels use plain loops instead of being fully
+/// unrolled, to keep the instantiations reasonably sized.
+constexpr std::size_t unrollLimbThreshold = 8;
+
+template <std::size_t N, typename F> constexpr void limbFor(F&& f) {
+  if constexpr (N <= unrollLimbThreshold) {
+    unrolledFor<N>([&](auto i) { f(std::size_t { i }); });
+  } else {
+    for (std::size_t i = 0; i < N; ++i)
+      f(i);
+  }
+}
+
+constexpr uint64_t addCarry(uint64_t a, uint64_t b, uint64_t carryIn,
+                            uint64_t& carryOut) {
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_addcll)
+  if (!std::is_constant_evaluated()) {
+    unsigned long long carry;
+    uint64_t const res = __builtin_addcll(a, b, carryIn, &carry);
+    carryOut = carry;
+    return res;
+  }
+#endif
+#endif
+  uint64_t partial = a + b;
+  uint64_t res = partial + carryIn;
+  carryOut = (partial < a) | (res < partial);
+  return res;
+}
+
+constexpr uint64_t subBorrow(uint64_t a, uint64_t b, uint64_t borrowIn,
+                             uint64_t& borrowOut) {
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_subcll)
+  if (!std::is_constant_evaluated()) {
+    unsigned long long borrow;
+    uint64_t const res = __builtin_subcll(a, b, borrowIn, &borrow);
+    borrowOut = borrow;
+    return res;
+  }
+#endif
+#endif
+  uint64_t partial = a - b;
+  uint64_t res = partial - borrowIn;
+  borrowOut = (a < b) | (partial < borrowIn);
+  return res;
+}
+
+/// Low limb of (high:low) >> shift, for shift < 64, lowered to shrd on
+/// x86-64
+constexpr uint64_t funnelShr(uint64_t high, uint64_t low, uint32_t shift) {
+  return (shift == 0) ? low : (low >> shift) | (high << (64 - shift));
+}
+
+/// Full 64x64 -> 128 product, lowered to a single mul/mulx on x86-64
+constexpr uint64_t mulWide(uint64_t a, uint64_t b, uint64_t& high) {
+  uint128_t prod = static_cast<uint128_t>(a) * b;
+  high = static_cast<uint64_t>(prod >> 64);
+  return static_cast<uint64_t>(prod);
+}
+
+/// (high:low) / divisor, with high < divisor so that the quotient fits a
+/// limb. Lowered to a single div on x86-64, instead of a call to the
+/// generic 128-bit division routine.
+constexpr uint64_t divWide(uint64_t high, uint64_t low, uint64_t divisor,
+                           uint64_t& rem) {
+#if defined(__x86_64__) && defined(__GNUC__)
+  if (!std::is_constant_evaluated()) {
+    uint64_t quot;
+    asm("divq %4"
+        : "=a"(quot), "=d"(rem)
+        : "a"(low), "d"(high), "rm"(divisor));
+    return quot;
+  }
+#endif
+  uint128_t num = (static_cast<uint128_t>(high) << 64) | low;
+  rem = static_cast<uint64_t>(num % divisor);
+  return static_cast<uint64_t>(num / divisor);
+}
+
+template <std::size_t N>
+constexpr limbs_t<N> limbAdd(limbs_t<N> const& a, limbs_t<N> const& b) {
+  limbs_t<N> res {};
+  uint64_t carry = 0;
+  limbFor<N>(
+      [&](std::size_t i) { res[i] = addCarry(a[i], b[i], carry, carry); });
+  return res;
+}
+
+template <std::size_t N>
+constexpr limbs_t<N> limbSub(limbs_t<N> const& a, limbs_t<N> const& b) {
+  limbs_t<N> res {};
+  uint64_t borrow = 0;
+  limbFor<N>(
+      [&](std::size_t i) { res[i] = subBorrow(a[i], b[i], borrow, borrow); });
+  return res;
+}
+
+template <std::size_t N>
+constexpr limbs_t<N> limbShl(limbs_t<N> const& a, uint32_t shift) {
+  limbs_t<N> res {};
+  std::size_t const limbShift = shift / 64;
+  uint32_t const bitShift = shift % 64;
+  limbFor<N>([&](std::size_t i) {
+    if (i < limbShift)
+      return;
+    uint64_t cur = a[i - limbShift] << bitShift;
+    if (bitShift != 0 && i > limbShift)
+      cur |= a[i - limbShift - 1] >> (64 - bitShift);
+    res[i] = cur;
+  });
+  return res;
+}
+
+/// Right shift, filling the vacated bits with fill (0 or ~0)
+template <std::size_t N>
+constexpr limbs_t<N> limbShr(limbs_t<N> const& a, uint32_t shift,
+                             uint64_t fill) {
+  limbs_t<N> res {};
+  std::size_t const limbShift = shift / 64;
+  uint32_t const bitShift = shift % 64;
+  limbFor<N>([&](std::size_t i) {
+    std::size_t const src = i + limbShift;
+    uint64_t const low = (src < N) ? a[src] : fill;
+    uint64_t const high = (src + 1 < N) ? a[src + 1] : fill;
+    res[i] = funnelShr(high, low, bitShift);
+  });
+  return res;
+}
+
+/// Step j of the row i of the truncated product
+template <std::size_t N>
+constexpr void limbMulStep(limbs_t<N>& res, uint64_t a, uint64_t b,
+                           std::size_t k, uint64_t& carry) {
+  uint64_t high, c1, c2;
+  uint64_t low = mulWide(a, b, high);
+  low = addCarry(low, res[k], 0, c1);
+  res[k] = addCarry(low, carry, 0, c2);
+  carry = high + c1 + c2;
+}
+
+/// Truncated schoolbook product: only the N low limbs are computed.
+/// The sequence of operations only depends on N, and both loops are
+/// unrolled for small N.
+template <std::size_t N>
+constexpr limbs_t<N> limbMul(limbs_t<N> const& a, limbs_t<N> const& b) {
+  limbs_t<N> res {};
+  if constexpr (N <= unrollLimbThreshold) {
+    unrolledFor<N>([&](auto i) {
+      uint64_t carry = 0;
+      unrolledFor<N - decltype(i)::value>(
+          [&](auto j) { limbMulStep(res, a[i], b[j], i + j, carry); });
+    });
+  } else {
+    for (std::size_t i = 0; i < N; ++i) {
+      uint64_t carry = 0;
+      for (std::size_t j = 0; i + j < N; ++j)
+        limbMulStep(res, a[i], b[j], i + j, carry);
+    }
+  }
+  return res;
+}
+
+/// M low limbs of the square of a, with M <= 2N. Each cross product
+/// a[i] * a[j], i < j, is computed once and doubled by a shift, which
+/// saves about half of the multiplications of limbMul.
+template <std::size_t M, std::size_t N>
+constexpr limbs_t<M> limbSqr(limbs_t<N> const& a) {
+  static_assert(M <= 2 * N, "The square of N limbs fits in 2N limbs");
+  limbs_t<M> res {};
+  for (std::size_t i = 0; i + 1 < N && 2 * i + 1 < M; ++i) {
+    uint64_t carry = 0;
+    for (std::size_t j = i + 1; j < N && i + j < M; ++j)
+      limbMulStep(res, a[i], a[j], i + j, carry);
+    if (i + N < M)
+      res[i + N] = carry;
+  }
+  res = limbShl(res, 1);
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < N && 2 * i < M; ++i) {
+    uint64_t high;
+    uint64_t const low = mulWide(a[i], a[i], high);
+    res[2 * i] = addCarry(res[2 * i], low, carry, carry);
+    if (2 * i + 1 < M)
+      res[2 * i + 1] = addCarry(res[2 * i + 1], high, carry, carry);
+  }
+  return res;
+}
+
+template <std::size_t N>
+constexpr std::size_t significantLimbs(limbs_t<N> const& a) {
+  std::size_t n = N;
+  while (n > 0 && a[n - 1] == 0)
+    --n;
+  return n;
+}
+
+template <std::size_t N>
+constexpr bool limbLess(limbs_t<N> const& a, limbs_t<N> const& b) {
+  for (std::size_t i = N; i-- > 0;)
+    if (a[i] != b[i])
+      return a[i] < b[i];
+  return false;
+}
+
+/// a = a * factor + addend, returning the carried-out limb
+template <std::size_t N>
+constexpr uint64_t limbMulAddSmall(limbs_t<N>& a, uint64_t factor,
+                                   uint64_t addend) {
+  uint64_t carry = addend;
+  for (std::size_t i = 0; i < N; ++i) {
+    uint64_t high, c;
+    a[i] = addCarry(mulWide(a[i], factor, high), carry, 0, c);
+    carry = high + c;
+  }
+  return carry;
+}
+
+/// a = a / divisor, returning the remainder. Only the n low limbs of a are
+/// considered, the others should be zero.
+template <std::size_t N>
+constexpr uint64_t limbDivRemSmall(limbs_t<N>& a, uint64_t divisor,
+                                   std::size_t n = N) {
+  uint64_t rem = 0;
+  for (std::size_t i = n; i-- > 0;)
+    a[i] = divWide(rem, a[i], divisor, rem);
+  return rem;
+}
+
+/// Unsigned division (Knuth, TAOCP vol. 2, 4.3.1, algorithm D) of n-limb
+/// operands, whose cost depends on their significant limbs only. scratch
+/// should hold 2n + 1 limbs.
+/// Division by zero yields an all-ones quotient and returns the dividend as
+/// remainder, which is what a restoring divider would produce.
+constexpr void limbDivModN(uint64_t const* u, uint64_t const* v,
+                           uint64_t* quot, uint64_t* rem, std::size_t len,
+                           uint64_t* scratch) {
+  std::size_t n = len;
+  while (n > 0 && v[n - 1] == 0)
+    --n;
+  std::size_t m = len;
+  while (m > 0 && u[m - 1] == 0)
+    --m;
+  for (std::size_t i = 0; i < len; ++i) {
+    quot[i] = (n == 0) ? ~uint64_t { 0 } : 0;
+    rem[i] = (n == 0 || m < n) ? u[i] : 0;
+  }
+  if (n == 0 || m < n)
+    return;
+  if (n == 1) {
+    uint64_t r = 0;
+    for (std::size_t i = m; i-- > 0;)
+      quot[i] = divWide(r, u[i], v[0], r);
+    rem[0] = r;
+    return;
+  }
+  // Normalise so that the divisor top limb has its MSB set
+  int const s = std::countl_zero(v[n - 1]);
+  uint64_t* const vn = scratch;
+  uint64_t* const un = scratch + len;
+  for (std::size_t i = n - 1; i > 0; --i)
+    vn[i] = (v[i] << s) | (s ? v[i - 1] >> (64 - s) : 0);
+  vn[0] = v[0] << s;
+  un[m] = s ? u[m - 1] >> (64 - s) : 0;
+  for (std::size_t i = m - 1; i > 0; --i)
+    un[i] = (u[i] << s) | (s ? u[i - 1] >> (64 - s) : 0);
+  un[0] = u[0] << s;
+
+  for (std::size_t j = m - n + 1; j-- > 0;) {
+    // Estimate the quotient limb from the two top limbs, then correct it
+    uint64_t qhat, rhat;
+    bool rhatOverflow = false;
+    if (un[j + n] >= vn[n - 1]) {
+      // The top limbs are equal: the estimate saturates at the base - 1
+      qhat = ~uint64_t { 0 };
+      rhat = un[j + n - 1] + vn[n - 1];
+      rhatOverflow = rhat < vn[n - 1];
+    } else {
+      qhat = divWide(un[j + n], un[j + n - 1], vn[n - 1], rhat);
+    }
+    while (!rhatOverflow) {
+      uint64_t high;
+      uint64_t low = mulWide(qhat, vn[n - 2], high);
+      if (high < rhat || (high == rhat && low <= un[j + n - 2]))
+        break;
+      --qhat;
+      rhat += vn[n - 1];
+      rhatOverflow = rhat < vn[n - 1];
+    }
+    // Multiply and subtract
+    uint64_t borrow = 0;
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      uint64_t high, c;
+      uint64_t low = addCarry(mulWide(qhat, vn[i], high), carry, 0, c);
+      carry = high + c;
+      un[i + j] = subBorrow(un[i + j], low, borrow, borrow);
+    }
+    un[j + n] = subBorrow(un[j + n], carry, borrow, borrow);
+    if (borrow) {
+      // qhat was one too large: add back
+      --qhat;
+      uint64_t c = 0;
+      for (std::size_t i = 0; i < n; ++i)
+        un[i + j] = addCarry(un[i + j], vn[i], c, c);
+      un[j + n] += c;
+    }
+    quot[j] = qhat;
+  }
+  for (std::size_t i = 0; i < n; ++i)
+    rem[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+}
+
+template <std::size_t N>
+constexpr void limbDivMod(limbs_t<N> const& u, limbs_t<N> const& v,
+                          limbs_t<N>& quot, limbs_t<N>& rem) {
+  limbs_t<2 * N + 1> scratch {};
+  limbDivModN(u.data(), v.data(), quot.data(), rem.data(), N, scratch.data());
+}
+} // namespace detail
+} // namespace apintext
+
+#endif // LIMB_KERNELS_HPP
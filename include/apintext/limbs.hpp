@@ -0,0 +1,68 @@
+#ifndef LIMBS_HPP
+#define LIMBS_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "aliases.hpp"
+#include "limb_kernels.hpp"
+
+namespace apintext {
+namespace detail {
+/// Split the bit pattern of an unsigned representation in 64-bit limbs,
+/// least significant first.
+template <uint32_t w>
+constexpr limbs_t<limbCount(w)> toLimbs(ap_repr<w, false> const& value) {
+  limbs_t<limbCount(w)> res {};
+  limbFor<limbCount(w)>([&](std::size_t i) {
+    res[i] = static_cast<uint64_t>(value >> (64 * i));
+  });
+  return res;
+}
+
+template <uint32_t w>
+constexpr ap_repr<w, false> fromLimbs(limbs_t<limbCount(w)> const& limbs) {
+  ap_repr<w, false> res { 0 };
+  limbFor<limbCount(w)>([&](std::size_t i) {
+    res |= static_cast<ap_repr<w, false>>(limbs[i]) << (64 * i);
+  });
+  return res;
+}
+
+/// Number of significant bits of an unsigned value, 0 for 0
+template <uint32_t w>
+constexpr uint32_t bitLength(ap_repr<w, false> const& value) {
+  auto const limbs = toLimbs<w>(value);
+  for (std::size_t i = limbs.size(); i-- > 0;)
+    if (limbs[i] != 0)
+      return static_cast<uint32_t>(64 * i + std::bit_width(limbs[i]));
+  return 0;
+}
+
+/// Whether the representation is stored as little-endian 64-bit limbs, so
+/// that a single limb of a value can be accessed in place
+template <uint32_t w, bool s>
+constexpr bool limbAddressable =
+    std::endian::native == std::endian::little &&
+    sizeof(ap_repr<w, s>) == 8 * limbCount(w) &&
+    std::is_trivially_copyable_v<ap_repr<w, s>>;
+
+template <uint32_t w, bool s>
+inline uint64_t loadLimb(ap_repr<w, s> const& value, std::size_t idx) {
+  uint64_t limb;
+  std::memcpy(&limb, reinterpret_cast<char const*>(&value) + 8 * idx,
+              sizeof(limb));
+  return limb;
+}
+
+template <uint32_t w, bool s>
+inline void storeLimb(ap_repr<w, s>& value, std::size_t idx, uint64_t limb) {
+  std::memcpy(reinterpret_cast<char*>(&value) + 8 * idx, &limb, sizeof(limb));
+}
+} // namespace detail
+} // namespace apintext
+
+#endif // LIMBS_HPP
@@ -0,0 +1,219 @@
+#ifndef NEWTON_HPP
+#define NEWTON_HPP
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#include "aliases.hpp"
+#include "constant_time.hpp"
+#include "cost.hpp"
+#include "expression.hpp"
+#include "limbs.hpp"
+
+namespace apintext {
+/// Integer square roots and fixed-point reciprocals, computed by Newton
+/// iterations from a seed read in a 256-entry table. The number of
+/// iterations only depends on the operand width, and a final correction
+/// makes the results bit-exact floors.
+namespace detail {
+/// Newton iterations bringing a seed accurate to seedBits bits to bits,
+/// each one doubling the accurate bits but for a bit lost to rounding
+constexpr uint32_t newtonIterations(uint32_t seedBits, uint32_t bits) {
+  uint32_t res = 0;
+  for (; seedBits < bits; seedBits = 2 * seedBits - 2)
+    ++res;
+  return res;
+}
+
+/// ceil(16 * sqrt(i + 1)): the root of values whose 8 leading bits are i is
+/// below this, scaled by 16
+constexpr std::array<uint16_t, 256> sqrtSeeds = [] {
+  std::array<uint16_t, 256> res {};
+  uint32_t u = 0;
+  for (uint32_t i = 0; i < 256; ++i) {
+    while (u * u < 256 * (i + 1))
+      ++u;
+    res[i] = static_cast<uint16_t>(u);
+  }
+  return res;
+}();
+
+/// 2^16 / (i + 0.5) rounded to nearest, for i in [128, 256): the
+/// reciprocal of values whose 8 leading bits are i, scaled by 2^16
+constexpr std::array<uint16_t, 128> recipSeeds = [] {
+  std::array<uint16_t, 128> res {};
+  for (uint32_t i = 0; i < 128; ++i) {
+    uint32_t const twice = (uint32_t { 1 } << 18) / (2 * i + 257);
+    res[i] = static_cast<uint16_t>((twice + 1) / 2);
+  }
+  return res;
+}();
+} // namespace detail
+
+/// floor(sqrt(x)), ceil(w / 2) bits wide. Signed sources are read as their
+/// unsigned bit pattern.
+///
+/// The root is refined from above by x_{k+1} = (x_k + n / x_k) / 2, which
+/// never goes below the floor r of the root. It ends on r or r + 1, which a
+/// single comparison fixes.
+template <ExprType ET> class ExprIsqrt {
+ public:
+  static constexpr uint32_t width = (ET::width + 1) / 2;
+  static constexpr bool signedness = false;
+  /// The seed holds 6 accurate bits
+  static constexpr uint32_t iterations =
+      detail::newtonIterations(6, width + 1);
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  /// Room for the scaled seed of the root and the sums of the iterations
+  static constexpr uint32_t workWidth =
+      (ET::width > width + 10) ? ET::width : width + 10;
+  using work_t = ap_repr<workWidth, false>;
+  ET const source;
+
+ public:
+  constexpr ExprIsqrt(ET const& src)
+      : source { src } {}
+
+  constexpr res_t compute() const {
+    auto const value =
+        static_cast<ap_repr<ET::width, false>>(source.compute());
+    if (value == ap_repr<ET::width, false> { 0 })
+      return res_t { 0 };
+    work_t const n = static_cast<work_t>(value);
+    // Even shift leaving 7 or 8 leading bits to index the seeds
+    uint32_t const length = detail::bitLength<ET::width>(value);
+    uint32_t const shift = (length > 8) ? (length - 7) & ~uint32_t { 1 } : 0;
+    auto const seed =
+        detail::sqrtSeeds[static_cast<uint64_t>(n >> shift)];
+    work_t x = ((work_t { seed } << (shift / 2)) + work_t { 15 }) >> 4;
+    for (uint32_t i = 0; i < iterations; ++i)
+      x = (x + n / x) >> 1;
+    auto const tooLarge = ct::lessThan<workWidth, false>(n / x, x);
+    return static_cast<res_t>(x - static_cast<work_t>(tooLarge));
+  }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ExprIsqrt<mapped_t> { f(source) };
+  }
+};
+
+template <ExprType ET> constexpr auto isqrt(ET const& expr) {
+  using node_t = ExprIsqrt<operand_t<ET>>;
+  return node_t { toOperand(expr) };
+}
+
+/// One division per iteration, and one for the correction
+template <ExprType ET> struct NodeCost<ExprIsqrt<ET>> {
+  static constexpr uint64_t value =
+      (ExprIsqrt<ET>::iterations + 1) * detail::divisionCost(ET::width);
+};
+
+/// floor(2^fracBits / x): the reciprocal of x with fracBits fractional
+/// bits, fracBits + 1 bits wide. Signed sources are read as their unsigned
+/// bit pattern, and 0 yields all ones.
+///
+/// x is normalized to P = fracBits + 2 bits, and r = 2^(2P - 1) / x is
+/// refined by r_{k+1} = r_k + r_k * (2^(2P - 1) - x * r_k) / 2^(2P - 1),
+/// which only takes multiplications. The shifted estimate is then within
+/// two units of the result, which the remainder corrects without branches.
+template <uint32_t fracBits, ExprType ET> class ExprRecip {
+ public:
+  static constexpr uint32_t width = fracBits + 1;
+  static constexpr bool signedness = false;
+
+ private:
+  static constexpr uint32_t precision = (fracBits + 2 > 9) ? fracBits + 2 : 9;
+
+ public:
+  /// The seed holds 7 accurate bits
+  static constexpr uint32_t iterations =
+      detail::newtonIterations(7, precision + 1);
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  static constexpr uint32_t P = precision;
+  static constexpr uint32_t w = ET::width;
+  /// Products of the estimate with the scaled error
+  using newton_t = ap_repr<3 * P + 2, true>;
+  /// Remainders of 2^fracBits by the estimates of the result
+  static constexpr uint32_t remWidth = fracBits + w + 3;
+  using rem_t = ap_repr<remWidth, true>;
+  ET const source;
+
+ public:
+  constexpr ExprRecip(ET const& src)
+      : source { src } {}
+
+  constexpr res_t compute() const {
+    using u_t = ap_repr<w, false>;
+    auto const value = static_cast<u_t>(source.compute());
+    auto const nonZero = ct::isNonZero<w>(value);
+    u_t const x = ct::maskSelect<w, false>(nonZero, value, u_t { 1 });
+    uint32_t const length = detail::bitLength<w>(x);
+
+    // m in [2^(P-1), 2^P), exact unless the result is 0
+    using m_t = ap_repr<(w > P) ? w : P, false>;
+    m_t const m = (length <= P) ? static_cast<m_t>(x) << (P - length)
+                                : static_cast<m_t>(x) >> (length - P);
+    auto const seed =
+        detail::recipSeeds[static_cast<uint64_t>(m >> (P - 8)) - 128];
+    newton_t const one = newton_t { 1 } << (2 * P - 1);
+    newton_t const mn = static_cast<newton_t>(m);
+    newton_t r = newton_t { seed } << (P - 9);
+    for (uint32_t i = 0; i < iterations; ++i)
+      r = r + ((r * (one - mn * r)) >> (2 * P - 1));
+
+    // x = m * 2^(length - P), so that 2^fracBits / x = r >> shift, and
+    // r < 2^(P + 1) makes larger shifts useless
+    uint32_t const shift = P + length - 1 - fracBits;
+    ap_repr<P + 2, false> const rounded =
+        static_cast<ap_repr<P + 2, false>>(r) >> ((shift < P + 1) ? shift
+                                                                  : P + 1);
+    rem_t q = static_cast<rem_t>(rounded);
+    rem_t const xr = static_cast<rem_t>(x);
+    rem_t rem = (rem_t { 1 } << fracBits) - q * xr;
+    for (int i = 0; i < 2; ++i) {
+      auto const negative = ct::msb<remWidth, true>(rem);
+      q = ct::maskSelect<remWidth, true>(negative, q - rem_t { 1 }, q);
+      rem = ct::maskSelect<remWidth, true>(negative, rem + xr, rem);
+    }
+    for (int i = 0; i < 2; ++i) {
+      auto const below = ct::lessThan<remWidth, true>(rem, xr);
+      q = ct::maskSelect<remWidth, true>(below, q, q + rem_t { 1 });
+      rem = ct::maskSelect<remWidth, true>(below, rem, rem - xr);
+    }
+    return ct::maskSelect<width, false>(nonZero, static_cast<res_t>(q),
+                                        ~res_t { 0 });
+  }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ExprRecip<fracBits, mapped_t> { f(source) };
+  }
+};
+
+template <uint32_t fracBits, ExprType ET>
+constexpr auto recip(ET const& expr) {
+  using node_t = ExprRecip<fracBits, operand_t<ET>>;
+  return node_t { toOperand(expr) };
+}
+
+/// Two products of about three times the precision per iteration
+template <uint32_t fracBits, ExprType ET>
+struct NodeCost<ExprRecip<fracBits, ET>> {
+  static constexpr uint64_t value =
+      2 * uint64_t { ExprRecip<fracBits, ET>::iterations } *
+          detail::limbCount(3 * fracBits + 8) *
+          detail::limbCount(3 * fracBits + 8) +
+      detail::limbCount(fracBits + ET::width + 3);
+};
+} // namespace apintext
+
+#endif // NEWTON_HPP
@@ -0,0 +1,263 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "batch.hpp"
+#include "cost.hpp"
+#include "expression.hpp"
+
+namespace apintext {
+
+/// Fixed set of worker threads running chunked loops with work stealing.
+///
+/// Each participant (the workers and the calling thread) starts with a
+/// contiguous range of chunks, which it consumes from the front. Once its
+/// range is exhausted it steals the back half of the range of another
+/// participant.
+class ThreadPool {
+ private:
+  /// Remaining chunks [front, back) of a participant, packed in a single
+  /// word so that the owner and the thieves can update it with one CAS.
+  struct alignas(64) WorkRange {
+    std::atomic<uint64_t> bounds { 0 };
+
+    static constexpr uint64_t pack(uint64_t front, uint64_t back) {
+      return (back << 32) | front;
+    }
+
+    void reset(uint64_t front, uint64_t back) {
+      bounds.store(pack(front, back), std::memory_order_release);
+    }
+
+    bool popFront(uint64_t& chunk) {
+      uint64_t cur = bounds.load(std::memory_order_acquire);
+      while (true) {
+        uint64_t front = cur & 0xFFFFFFFF;
+        uint64_t back = cur >> 32;
+        if (front >= back)
+          return false;
+        if (bounds.compare_exchange_weak(cur, pack(front + 1, back),
+                                         std::memory_order_acq_rel)) {
+          chunk = front;
+          return true;
+        }
+      }
+    }
+
+    bool stealBack(uint64_t& first, uint64_t& last) {
+      uint64_t cur = bounds.load(std::memory_order_acquire);
+      while (true) {
+        uint64_t front = cur & 0xFFFFFFFF;
+        uint64_t back = cur >> 32;
+        if (front >= back)
+          return false;
+        uint64_t stolen = (back - front + 1) / 2;
+        if (bounds.compare_exchange_weak(cur, pack(front, back - stolen),
+                                         std::memory_order_acq_rel)) {
+          first = back - stolen;
+          last = back;
+          return true;
+        }
+      }
+    }
+  };
+
+  struct Job {
+    void (*run)(void*, uint64_t);
+    void* context;
+  };
+
+  std::vector<std::thread> workers;
+  std::unique_ptr<WorkRange[]> ranges;
+  std::size_t participantCount;
+
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  std::condition_variable done;
+  Job job { nullptr, nullptr };
+  uint64_t generation = 0;
+  std::size_t busyWorkers = 0;
+  bool stopping = false;
+  std::exception_ptr error;
+
+  void workerLoop(std::size_t participant) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+      Job current;
+      {
+        std::unique_lock lock { mutex };
+        wakeUp.wait(lock,
+                    [&] { return stopping || generation != seenGeneration; });
+        if (stopping)
+          return;
+        seenGeneration = generation;
+        current = job;
+      }
+      runParticipant(current, participant);
+      std::lock_guard lock { mutex };
+      if (--busyWorkers == 0)
+        done.notify_one();
+    }
+  }
+
+  void runParticipant(Job const& current, std::size_t participant) {
+    try {
+      uint64_t chunk;
+      while (true) {
+        while (ranges[participant].popFront(chunk))
+          current.run(current.context, chunk);
+        if (!steal(participant))
+          return;
+      }
+    } catch (...) {
+      std::lock_guard lock { mutex };
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+
+  bool steal(std::size_t thief) {
+    for (std::size_t offset = 1; offset < participantCount; ++offset) {
+      std::size_t victim = (thief + offset) % participantCount;
+      uint64_t first, last;
+      if (ranges[victim].stealBack(first, last)) {
+        ranges[thief].reset(first, last);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ public:
+  /// Largest number of chunks of a single loop
+  static constexpr uint64_t maxChunkCount = (uint64_t { 1 } << 32) - 1;
+
+  /// The calling thread takes part in the loops, so threadCount - 1 worker
+  /// threads are created.
+  explicit ThreadPool(
+      std::size_t threadCount = std::thread::hardware_concurrency())
+      : ranges { new WorkRange[std::max<std::size_t>(threadCount, 1)] }
+      , participantCount { std::max<std::size_t>(threadCount, 1) } {
+    workers.reserve(participantCount - 1);
+    for (std::size_t i = 1; i < participantCount; ++i)
+      workers.emplace_back([this, i] { workerLoop(i); });
+  }
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock { mutex };
+      stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  std::size_t size() const { return participantCount; }
+
+  /// Call task(chunk) for each chunk of [0, chunkCount) and wait for
+  /// completion. The first exception thrown by a task is rethrown.
+  /// Loops should not be started concurrently on the same pool.
+  template <typename F> void forEachChunk(uint64_t chunkCount, F&& task) {
+    if (chunkCount == 0)
+      return;
+    if (chunkCount > maxChunkCount)
+      throw std::invalid_argument("Too many chunks for a parallel loop");
+    std::size_t const active = static_cast<std::size_t>(
+        std::min<uint64_t>(participantCount, chunkCount));
+    for (std::size_t p = 0; p < participantCount; ++p) {
+      uint64_t first = (p < active) ? chunkCount * p / active : 0;
+      uint64_t last = (p < active) ? chunkCount * (p + 1) / active : 0;
+      ranges[p].reset(first, last);
+    }
+
+    using task_t = std::remove_reference_t<F>;
+    Job const current { [](void* context, uint64_t chunk) {
+                         (*static_cast<task_t*>(context))(chunk);
+                       },
+                        const_cast<void*>(static_cast<void const*>(&task)) };
+    {
+      std::lock_guard lock { mutex };
+      job = current;
+      error = nullptr;
+      busyWorkers = workers.size();
+      ++generation;
+    }
+    wakeUp.notify_all();
+    runParticipant(current, 0);
+
+    std::unique_lock lock { mutex };
+    done.wait(lock, [&] { return busyWorkers == 0; });
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  /// Pool shared by the calls which do not provide one, with one thread per
+  /// hardware thread.
+  static ThreadPool& global() {
+    static ThreadPool pool;
+    return pool;
+  }
+};
+
+namespace detail {
+/// Work amount (see NodeCost) of a chunk: large enough to amortise the
+/// scheduling, small enough to allow balancing between participants.
+constexpr uint64_t targetChunkCost = uint64_t { 1 } << 16;
+constexpr uint64_t chunksPerParticipant = 8;
+
+constexpr uint64_t chunkSize(uint64_t elementCost, uint64_t count,
+                             uint64_t participants, uint64_t granularity) {
+  uint64_t size = std::max<uint64_t>(
+      targetChunkCost / std::max<uint64_t>(elementCost, 1), 1);
+  uint64_t const balanced =
+      (count + participants * chunksPerParticipant - 1) /
+      (participants * chunksPerParticipant);
+  size = std::max<uint64_t>(std::min(size, balanced), 1);
+  size = std::max(size, count / ThreadPool::maxChunkCount + 1);
+  return (size + granularity - 1) / granularity * granularity;
+}
+} // namespace detail
+
+/// Parallel version of evaluate(): the ranges are split into chunks whose
+/// size depends on the estimated cost of shape, which are distributed over
+/// the participants of pool.
+template <typename Config = BatchConfig<>, ExprType ET, typename... Ranges>
+void parallelEvaluate(ThreadPool& pool, ET const& shape, Ranges&&... ranges) {
+  auto const spans = detail::makeBatchSpans(std::forward<Ranges>(ranges)...);
+  constexpr std::size_t inputCount = sizeof...(Ranges) - 1;
+  uint64_t const count = std::get<inputCount>(spans).size();
+  uint64_t const chunk = detail::chunkSize(exprCost<ET>, count, pool.size(),
+                                           Config::unrollFactor);
+  pool.forEachChunk((count + chunk - 1) / chunk, [&](uint64_t idx) {
+    uint64_t const begin = idx * chunk;
+    uint64_t const end = std::min(begin + chunk, count);
+    detail::evaluateRange<Config>(shape, spans, begin, end,
+                                  std::make_index_sequence<inputCount> {});
+  });
+}
+
+template <typename Config = BatchConfig<>, ExprType ET, typename... Ranges>
+void parallelEvaluate(ET const& shape, Ranges&&... ranges) {
+  parallelEvaluate<Config>(ThreadPool::global(), shape,
+                           std::forward<Ranges>(ranges)...);
+}
+
+} // namespace apintext
+
+#endif // PARALLEL_HPP
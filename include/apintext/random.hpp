@@ -0,0 +1,326 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "aliases.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
+#include "parallel.hpp"
+#include "serialization.hpp"
+#include "value.hpp"
+
+namespace apintext {
+/// Random values for fuzzing and Monte-Carlo simulation, drawn from the
+/// Philox4x32-10 counter-based generator: the bits of the element of index
+/// i only depend on the seed and on i, so that spans are filled the same
+/// way whatever their split over calls or threads. Indices times the words
+/// drawn per element should fit 64 bits.
+///
+/// Distributions map the 64-bit words drawn for an element to a value:
+/// Uniform draws all the bit patterns, UniformIn the values of a range and
+/// EdgeBiased favours the corner cases of the format.
+namespace detail {
+/// Generator blocks computed at once, one lane each, so that the rounds of
+/// the generator are vectorized
+constexpr std::size_t randomLanes = 16;
+
+template <std::size_t L>
+using philox_lanes_t = std::array<std::array<uint32_t, L>, 4>;
+
+/// Philox4x32-10 rounds applied to L counters of four 32-bit words, in place.
+/// The rounds of a lane are fully unrolled, leaving a loop over independent
+/// lanes for the vectorizer.
+template <std::size_t L>
+constexpr void philoxRounds(philox_lanes_t<L>& ctr, uint64_t key) {
+  constexpr uint64_t m0 = 0xD2511F53;
+  constexpr uint64_t m1 = 0xCD9E8D57;
+  for (std::size_t l = 0; l < L; ++l) {
+    uint32_t c0 = ctr[0][l], c1 = ctr[1][l], c2 = ctr[2][l], c3 = ctr[3][l];
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+    unrolledFor<10>([&](auto) {
+      uint64_t const p0 = m0 * c0;
+      uint64_t const p1 = m1 * c2;
+      c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+      c1 = static_cast<uint32_t>(p1);
+      c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+      c3 = static_cast<uint32_t>(p0);
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    });
+    ctr[0][l] = c0;
+    ctr[1][l] = c1;
+    ctr[2][l] = c2;
+    ctr[3][l] = c3;
+  }
+}
+
+/// Philox4x32-10 block of a single counter
+constexpr std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> ctr,
+                                             uint64_t key) {
+  philox_lanes_t<1> lanes { { { ctr[0] }, { ctr[1] }, { ctr[2] },
+                              { ctr[3] } } };
+  philoxRounds(lanes, key);
+  return { lanes[0][0], lanes[1][0], lanes[2][0], lanes[3][0] };
+}
+
+/// Call sink(k, repr) with the values of the elements of index
+/// first + k drawn from dist, for k in [0, count).
+///
+/// The words drawn for the element i are the words [i * n, (i + 1) * n) of
+/// the sequence of seed, n being the word count of the distribution, whose
+/// words 2b and 2b + 1 are the block of counter b. The blocks covering the
+/// words of a batch of elements are generated at once, one per lane.
+template <uint32_t w, bool s, typename Dist, typename Sink>
+void generateRandom(uint64_t seed, Dist const& dist, uint64_t first,
+                    uint64_t count, Sink&& sink) {
+  constexpr std::size_t L = randomLanes;
+  constexpr std::size_t wordCount = Dist::template wordCount<w>;
+  constexpr std::size_t batch =
+      std::max<std::size_t>((2 * L - 1) / wordCount, 1);
+  // The words of a batch may start in the middle of a block
+  constexpr std::size_t groups = (batch * wordCount + 2 * L) / (2 * L);
+  std::array<uint64_t, 2 * L * groups> words;
+  for (uint64_t base = 0; base < count; base += batch) {
+    uint64_t const firstWord = (first + base) * wordCount;
+    for (std::size_t g = 0; g < groups; ++g) {
+      philox_lanes_t<L> ctr;
+      for (std::size_t l = 0; l < L; ++l) {
+        uint64_t const block = firstWord / 2 + g * L + l;
+        ctr[0][l] = static_cast<uint32_t>(block);
+        ctr[1][l] = static_cast<uint32_t>(block >> 32);
+        ctr[2][l] = 0;
+        ctr[3][l] = 0;
+      }
+      philoxRounds(ctr, seed);
+      for (std::size_t l = 0; l < L; ++l) {
+        words[2 * (g * L + l)] = ctr[0][l] | uint64_t { ctr[1][l] } << 32;
+        words[2 * (g * L + l) + 1] = ctr[2][l] | uint64_t { ctr[3][l] } << 32;
+      }
+    }
+    std::size_t const elements = std::min<uint64_t>(batch, count - base);
+    for (std::size_t k = 0; k < elements; ++k) {
+      limbs_t<wordCount> elementWords;
+      std::copy_n(words.begin() + firstWord % 2 + k * wordCount, wordCount,
+                  elementWords.begin());
+      sink(base + k, dist.template sample<w, s>(elementWords));
+    }
+  }
+}
+
+/// Elements per chunk of the parallel fills are a multiple of this, so
+/// that the packed chunks start on a word boundary
+constexpr uint64_t randomChunkGranularity = 64;
+
+template <typename Dist, uint32_t w>
+constexpr uint64_t randomElementCost = 4 * Dist::template wordCount<w>;
+
+/// OR the w low bits of value in words, from bit offset
+template <uint32_t w>
+void orPacked(std::span<uint64_t> words, uint64_t offset,
+              ap_repr<w, false> const& value) {
+  auto const limbs = toLimbs<w>(value);
+  for (std::size_t i = 0; i < limbs.size(); ++i) {
+    uint32_t const bits = (i + 1 < limbs.size()) ? 64 : w - 64 * i;
+    uint64_t const idx = (offset + 64 * i) / 64;
+    uint32_t const shift = offset % 64;
+    words[idx] |= limbs[i] << shift;
+    if (shift != 0 && shift + bits > 64)
+      words[idx + 1] |= limbs[i] >> (64 - shift);
+  }
+}
+
+/// Pack the elements of index first + k, for k in [begin, end), in the
+/// words of the output; begin is a multiple of 64
+template <uint32_t w, bool s, typename Dist>
+void generatePacked(std::span<uint64_t> words, uint64_t seed,
+                    Dist const& dist, uint64_t first, uint64_t begin,
+                    uint64_t end) {
+  uint64_t const firstWord = begin * w / 64;
+  uint64_t const lastWord = (end * w + 63) / 64;
+  std::fill(words.begin() + firstWord, words.begin() + lastWord, 0);
+  generateRandom<w, s>(seed, dist, first + begin, end - begin,
+                       [&](uint64_t k, ap_repr<w, s> const& repr) {
+                         orPacked<w>(words, (begin + k) * w,
+                                     static_cast<ap_repr<w, false>>(repr));
+                       });
+  for (uint64_t i = firstWord; i < lastWord; ++i)
+    words[i] = toLittleEndian(words[i]);
+}
+
+template <typename R>
+using random_elem_t = std::remove_cvref_t<std::ranges::range_reference_t<R>>;
+} // namespace detail
+
+/// All the bit patterns of the format, with the same probability
+struct Uniform {
+  template <uint32_t w>
+  static constexpr std::size_t wordCount = detail::limbCount(w);
+
+  template <uint32_t w, bool s>
+  constexpr ap_repr<w, s>
+  sample(detail::limbs_t<wordCount<w>> const& words) const {
+    return static_cast<ap_repr<w, s>>(detail::fromLimbs<w>(words));
+  }
+};
+
+/// Values of [low, high] with the same probability, up to a relative bias
+/// below 2^-64: the offset from low is the high part of the product of the
+/// size of the range by w + 64 random bits, which takes no rejection loop.
+template <uint32_t w, bool s> class UniformIn {
+  ap_repr<w, false> lowBits;
+  ap_repr<w + 1, false> rangeSize;
+
+ public:
+  template <uint32_t>
+  static constexpr std::size_t wordCount = detail::limbCount(w + 64);
+
+  UniformIn(Value<w, s> const& low, Value<w, s> const& high)
+      : lowBits { static_cast<ap_repr<w, false>>(low.compute()) } {
+    if (high < low)
+      throw std::invalid_argument("Empty random range");
+    rangeSize = static_cast<ap_repr<w + 1, false>>(
+                    static_cast<ap_repr<w, false>>(high.compute()) - lowBits) +
+                ap_repr<w + 1, false> { 1 };
+  }
+
+  template <uint32_t wo, bool so>
+  constexpr ap_repr<wo, so>
+  sample(detail::limbs_t<wordCount<wo>> const& words) const {
+    static_assert(wo == w && so == s,
+                  "Random ranges should have the format of the values");
+    using product_t = ap_repr<2 * w + 65, false>;
+    product_t const scaled =
+        static_cast<product_t>(detail::fromLimbs<w + 64>(words)) *
+        static_cast<product_t>(rangeSize);
+    auto const offset = static_cast<ap_repr<w, false>>(scaled >> (w + 64));
+    return static_cast<ap_repr<w, s>>(lowBits + offset);
+  }
+};
+
+/// Uniform bit patterns, replaced with probability edgeProbability by one
+/// of the edge cases of the format, equally likely: 0, 1, all ones (-1 for
+/// signed formats), the minimum, the maximum and the w single-bit values.
+class EdgeBiased {
+  /// Threshold on 32 random bits, scaled from the edge probability
+  uint64_t threshold;
+
+  static constexpr uint64_t fixedEdges = 5;
+
+  template <uint32_t w, bool s>
+  static constexpr ap_repr<w, false> edge(uint64_t kind) {
+    using u_t = ap_repr<w, false>;
+    switch (kind) {
+    case 0:
+      return u_t { 0 };
+    case 1:
+      return u_t { 1 };
+    case 2:
+      return ~u_t { 0 };
+    case 3:
+      return s ? u_t { 1 } << (w - 1) : u_t { 0 };
+    case 4:
+      return s ? ~u_t { 0 } >> 1 : ~u_t { 0 };
+    default:
+      return u_t { 1 } << static_cast<uint32_t>(kind - fixedEdges);
+    }
+  }
+
+ public:
+  explicit EdgeBiased(double edgeProbability = 0.25) {
+    if (!(edgeProbability >= 0. && edgeProbability <= 1.))
+      throw std::invalid_argument("Edge probability outside of [0, 1]");
+    threshold = static_cast<uint64_t>(edgeProbability * 4294967296.);
+  }
+
+  /// The words of the value, followed by the one choosing the edge case
+  template <uint32_t w>
+  static constexpr std::size_t wordCount = detail::limbCount(w) + 1;
+
+  template <uint32_t w, bool s>
+  constexpr ap_repr<w, s>
+  sample(detail::limbs_t<wordCount<w>> const& words) const {
+    uint64_t const choice = words.back();
+    detail::limbs_t<detail::limbCount(w)> limbs;
+    std::copy_n(words.begin(), limbs.size(), limbs.begin());
+    auto value = detail::fromLimbs<w>(limbs);
+    if ((choice >> 32) < threshold) {
+      uint64_t const kind = ((choice & 0xFFFFFFFF) * (fixedEdges + w)) >> 32;
+      value = edge<w, s>(kind);
+    }
+    return static_cast<ap_repr<w, s>>(value);
+  }
+};
+
+/// Fill out with values drawn from dist, element k being the element of
+/// index firstIndex + k of the sequence of seed
+template <typename Dist = Uniform, std::ranges::contiguous_range R>
+void randomFill(R&& out, uint64_t seed, Dist const& dist = {},
+                uint64_t firstIndex = 0) {
+  using elem_t = detail::random_elem_t<R>;
+  auto* const data = std::ranges::data(out);
+  detail::generateRandom<elem_t::width, elem_t::signedness>(
+      seed, dist, firstIndex, std::ranges::size(out),
+      [&](uint64_t k, auto const& repr) { data[k] = elem_t { repr }; });
+}
+
+/// Parallel version of randomFill(), whose result does not depend on the
+/// number of participants of pool
+template <typename Dist = Uniform, std::ranges::contiguous_range R>
+void randomFill(ThreadPool& pool, R&& out, uint64_t seed,
+                Dist const& dist = {}, uint64_t firstIndex = 0) {
+  using elem_t = detail::random_elem_t<R>;
+  constexpr uint32_t w = elem_t::width;
+  auto* const data = std::ranges::data(out);
+  uint64_t const count = std::ranges::size(out);
+  uint64_t const chunk =
+      detail::chunkSize(detail::randomElementCost<Dist, w>, count, pool.size(),
+                        detail::randomChunkGranularity);
+  pool.forEachChunk((count + chunk - 1) / chunk, [&](uint64_t idx) {
+    uint64_t const begin = idx * chunk;
+    uint64_t const end = std::min(begin + chunk, count);
+    detail::generateRandom<w, elem_t::signedness>(
+        seed, dist, firstIndex + begin, end - begin,
+        [&](uint64_t k, auto const& repr) {
+          data[begin + k] = elem_t { repr };
+        });
+  });
+}
+
+/// Fill words with count (w, s) values drawn as by randomFill(), bit-packed
+/// in the layout of the payload of traces (see TraceHeader)
+template <uint32_t w, bool s, typename Dist = Uniform>
+void randomFillPacked(std::span<uint64_t> words, uint64_t count,
+                      uint64_t seed, Dist const& dist = {},
+                      uint64_t firstIndex = 0) {
+  if (words.size() < TraceHeader { w, s, count }.payloadWords())
+    throw std::invalid_argument("Too few words to pack the values");
+  detail::generatePacked<w, s>(words, seed, dist, firstIndex, 0, count);
+}
+
+template <uint32_t w, bool s, typename Dist = Uniform>
+void randomFillPacked(ThreadPool& pool, std::span<uint64_t> words,
+                      uint64_t count, uint64_t seed, Dist const& dist = {},
+                      uint64_t firstIndex = 0) {
+  if (words.size() < TraceHeader { w, s, count }.payloadWords())
+    throw std::invalid_argument("Too few words to pack the values");
+  uint64_t const chunk =
+      detail::chunkSize(detail::randomElementCost<Dist, w>, count, pool.size(),
+                        detail::randomChunkGranularity);
+  pool.forEachChunk((count + chunk - 1) / chunk, [&](uint64_t idx) {
+    uint64_t const begin = idx * chunk;
+    detail::generatePacked<w, s>(words, seed, dist, firstIndex, begin,
+                                 std::min(begin + chunk, count));
+  });
+}
+} // namespace apintext
+
+#endif // RANDOM_HPP
@@ -0,0 +1,365 @@
+#ifndef RUNTIME_IR_HPP
+#define RUNTIME_IR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "arith_prop.hpp"
+#include "limb_kernels.hpp"
+
+namespace apintext {
+/// Expressions built at run time.
+///
+/// A Program is a DAG of nodes mirroring the expression templates, with the
+/// same format rules, stored in topological order: the operands of a node
+/// are previous nodes. Programs have a list of inputs and a list of
+/// outputs, and are evaluated on values stored as little-endian 64-bit
+/// limbs, limbCount(width) per value. The bits of the input limbs above the
+/// input width are ignored, and outputs are sign or zero extended to fill
+/// their limbs.
+///
+/// As opposed to the templates, division and modulo by zero are defined:
+/// the quotient is all ones and the remainder is the dividend, both taken
+/// in the division format of the operands.
+namespace ir {
+enum class Opcode : uint8_t {
+  Input,
+  Constant,
+  Sum,
+  Sub,
+  Prod,
+  Div,
+  Mod,
+  ZExt,
+  SExt,
+  Reinterpret,
+  Slice,
+  DynSlice,
+  And,
+  Or,
+  Xor,
+  Not,
+  OrReduce,
+  AndReduce,
+  NorReduce,
+  XorReduce,
+  Eq,
+  Ne,
+  Lt,
+  Le,
+  Gt,
+  Ge
+};
+
+/// Node of a program. The immediates depend on the opcode:
+///   Input     input index
+///   Constant  offset of the value limbs in the constant pool
+///   Slice     high bit, low bit
+///   DynSlice  low bit
+/// and are zero otherwise, as are the unused operands.
+struct Node {
+  Opcode op;
+  Format format;
+  std::array<uint32_t, 2> operands;
+  std::array<uint32_t, 2> imm;
+
+  friend bool operator==(Node const&, Node const&) = default;
+};
+
+/// Handle to a node of a program
+struct NodeRef {
+  uint32_t id;
+};
+
+namespace detail {
+constexpr uint64_t hashCombine(uint64_t seed, uint64_t value) {
+  uint64_t z = seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6));
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+constexpr uint64_t hashNode(Node const& node) {
+  uint64_t res = hashCombine(static_cast<uint64_t>(node.op),
+                             (uint64_t { node.format.width } << 1) |
+                                 node.format.signedness);
+  for (uint32_t operand : node.operands)
+    res = hashCombine(res, operand);
+  for (uint32_t imm : node.imm)
+    res = hashCombine(res, imm);
+  return res;
+}
+
+struct NodeHasher {
+  std::size_t operator()(Node const& node) const { return hashNode(node); }
+};
+} // namespace detail
+
+class Program {
+ private:
+  std::vector<Node> nodeList;
+  std::vector<uint64_t> constantPool;
+  std::vector<uint32_t> inputList;
+  std::vector<uint32_t> outputList;
+  /// Identical nodes are only stored once
+  std::unordered_map<Node, uint32_t, detail::NodeHasher> uniqueNodes;
+
+  static void checkWidth(uint32_t width) {
+    if (width == 0)
+      throw std::invalid_argument("Null expression width");
+  }
+
+  void checkRef(NodeRef ref) const {
+    if (ref.id >= nodeList.size())
+      throw std::out_of_range("Node reference out of program");
+  }
+
+  NodeRef addNode(Node const& node) {
+    checkWidth(node.format.width);
+    auto const [it, inserted] = uniqueNodes.emplace(
+        node, static_cast<uint32_t>(nodeList.size()));
+    if (inserted)
+      nodeList.push_back(node);
+    return { it->second };
+  }
+
+  NodeRef unary(Opcode op, Format format, NodeRef src, uint32_t imm0 = 0,
+                uint32_t imm1 = 0) {
+    checkRef(src);
+    return addNode({ op, format, { src.id, 0 }, { imm0, imm1 } });
+  }
+
+  NodeRef binary(Opcode op, Format format, NodeRef lhs, NodeRef rhs) {
+    checkRef(lhs);
+    checkRef(rhs);
+    return addNode({ op, format, { lhs.id, rhs.id }, { 0, 0 } });
+  }
+
+  NodeRef bitwise(Opcode op, NodeRef lhs, NodeRef rhs) {
+    checkRef(lhs);
+    checkRef(rhs);
+    if (format(lhs).width != format(rhs).width)
+      throw std::invalid_argument(
+          "Bitwise operation on operands of different widths");
+    return binary(op, { format(lhs).width, false }, lhs, rhs);
+  }
+
+  NodeRef comparison(Opcode op, NodeRef lhs, NodeRef rhs) {
+    return binary(op, { 1, false }, lhs, rhs);
+  }
+
+ public:
+  NodeRef input(Format format) {
+    checkWidth(format.width);
+    uint32_t const idx = static_cast<uint32_t>(inputList.size());
+    NodeRef const res =
+        addNode({ Opcode::Input, format, { 0, 0 }, { idx, 0 } });
+    inputList.push_back(res.id);
+    return res;
+  }
+
+  /// Constant of the given format, whose limbs are the extended value
+  NodeRef constant(Format format, std::span<uint64_t const> limbs) {
+    checkWidth(format.width);
+    std::size_t const count = apintext::detail::limbCount(format.width);
+    if (limbs.size() < count)
+      throw std::invalid_argument("Too few limbs for the constant width");
+    uint32_t const offset = static_cast<uint32_t>(constantPool.size());
+    constantPool.insert(constantPool.end(), limbs.begin(),
+                        limbs.begin() + count);
+    uint32_t const topBits = format.width % 64;
+    if (topBits != 0) {
+      uint64_t& top = constantPool.back();
+      top &= (uint64_t { 1 } << topBits) - 1;
+    }
+    return addNode({ Opcode::Constant, format, { 0, 0 }, { offset, 0 } });
+  }
+
+  NodeRef constant(Format format, int64_t value) {
+    std::vector<uint64_t> limbs(apintext::detail::limbCount(format.width),
+                                (value < 0) ? ~uint64_t { 0 } : 0);
+    limbs[0] = static_cast<uint64_t>(value);
+    return constant(format, limbs);
+  }
+
+  NodeRef sum(NodeRef lhs, NodeRef rhs) {
+    return binary(Opcode::Sum,
+                  arithmeticFormats(format(lhs), format(rhs)).sum, lhs, rhs);
+  }
+
+  NodeRef sub(NodeRef lhs, NodeRef rhs) {
+    return binary(Opcode::Sub,
+                  arithmeticFormats(format(lhs), format(rhs)).sum, lhs, rhs);
+  }
+
+  NodeRef prod(NodeRef lhs, NodeRef rhs) {
+    return binary(Opcode::Prod,
+                  arithmeticFormats(format(lhs), format(rhs)).prod, lhs,
+                  rhs);
+  }
+
+  NodeRef div(NodeRef lhs, NodeRef rhs) {
+    return binary(Opcode::Div,
+                  arithmeticFormats(format(lhs), format(rhs)).div, lhs, rhs);
+  }
+
+  NodeRef mod(NodeRef lhs, NodeRef rhs) {
+    return binary(Opcode::Mod,
+                  arithmeticFormats(format(lhs), format(rhs)).mod, lhs, rhs);
+  }
+
+  NodeRef zeroExtend(NodeRef src, uint32_t width) {
+    if (width <= format(src).width)
+      throw std::invalid_argument(
+          "Zero extension to a width smaller than the source width");
+    return unary(Opcode::ZExt, { width, format(src).signedness }, src);
+  }
+
+  /// Extension by the sign bit for signed sources, by zeros otherwise
+  NodeRef signExtend(NodeRef src, uint32_t width) {
+    if (width <= format(src).width)
+      throw std::invalid_argument(
+          "Sign extension to a width smaller than the source width");
+    return unary(Opcode::SExt, { width, format(src).signedness }, src);
+  }
+
+  NodeRef reinterpretSign(NodeRef src, bool signedness) {
+    if (signedness == format(src).signedness)
+      throw std::invalid_argument("Useless sign reinterpretation");
+    return unary(Opcode::Reinterpret, { format(src).width, signedness }, src);
+  }
+
+  NodeRef slice(NodeRef src, uint32_t highBit, uint32_t lowBit) {
+    if (highBit < lowBit || highBit >= format(src).width)
+      throw std::invalid_argument("Slice out of the source bounds");
+    return unary(Opcode::Slice, { highBit - lowBit + 1, false }, src,
+                 highBit, lowBit);
+  }
+
+  NodeRef getBit(NodeRef src, uint32_t idx) { return slice(src, idx, idx); }
+
+  /// Slice of width bits starting at lowBit, reading zeros past the source
+  NodeRef dynSlice(NodeRef src, uint32_t width, uint32_t lowBit) {
+    return unary(Opcode::DynSlice, { width, false }, src, lowBit);
+  }
+
+  /// Adaptation with the default policies of Value: extension by the sign,
+  /// truncation and sign reinterpretation
+  NodeRef adapt(NodeRef src, Format target) {
+    Format const source = format(src);
+    if (target.width > source.width)
+      return adapt(signExtend(src, target.width), target);
+    if (target.width < source.width)
+      return adapt(slice(src, target.width - 1, 0), target);
+    if (target.signedness != source.signedness)
+      return reinterpretSign(src, target.signedness);
+    return src;
+  }
+
+  NodeRef bitwiseAnd(NodeRef lhs, NodeRef rhs) {
+    return bitwise(Opcode::And, lhs, rhs);
+  }
+
+  NodeRef bitwiseOr(NodeRef lhs, NodeRef rhs) {
+    return bitwise(Opcode::Or, lhs, rhs);
+  }
+
+  NodeRef bitwiseXor(NodeRef lhs, NodeRef rhs) {
+    return bitwise(Opcode::Xor, lhs, rhs);
+  }
+
+  NodeRef bitInvert(NodeRef src) {
+    return unary(Opcode::Not, { format(src).width, false }, src);
+  }
+
+  NodeRef orReduce(NodeRef src) {
+    return unary(Opcode::OrReduce, { 1, false }, src);
+  }
+
+  NodeRef andReduce(NodeRef src) {
+    return unary(Opcode::AndReduce, { 1, false }, src);
+  }
+
+  NodeRef norReduce(NodeRef src) {
+    return unary(Opcode::NorReduce, { 1, false }, src);
+  }
+
+  NodeRef xorReduce(NodeRef src) {
+    return unary(Opcode::XorReduce, { 1, false }, src);
+  }
+
+  /// Comparisons are performed in the tight overset of the operand formats,
+  /// and yield a 1-bit unsigned value
+  NodeRef equal(NodeRef lhs, NodeRef rhs) {
+    return comparison(Opcode::Eq, lhs, rhs);
+  }
+
+  NodeRef notEqual(NodeRef lhs, NodeRef rhs) {
+    return comparison(Opcode::Ne, lhs, rhs);
+  }
+
+  NodeRef less(NodeRef lhs, NodeRef rhs) {
+    return comparison(Opcode::Lt, lhs, rhs);
+  }
+
+  NodeRef lessEqual(NodeRef lhs, NodeRef rhs) {
+    return comparison(Opcode::Le, lhs, rhs);
+  }
+
+  NodeRef greater(NodeRef lhs, NodeRef rhs) {
+    return comparison(Opcode::Gt, lhs, rhs);
+  }
+
+  NodeRef greaterEqual(NodeRef lhs, NodeRef rhs) {
+    return comparison(Opcode::Ge, lhs, rhs);
+  }
+
+  /// Add an output, returning its index
+  uint32_t output(NodeRef ref) {
+    checkRef(ref);
+    outputList.push_back(ref.id);
+    return static_cast<uint32_t>(outputList.size() - 1);
+  }
+
+  Format format(NodeRef ref) const {
+    checkRef(ref);
+    return nodeList[ref.id].format;
+  }
+
+  std::span<Node const> nodes() const { return nodeList; }
+  std::span<uint32_t const> inputs() const { return inputList; }
+  std::span<uint32_t const> outputs() const { return outputList; }
+
+  /// Limbs of a constant node
+  std::span<uint64_t const> constantLimbs(Node const& node) const {
+    return std::span<uint64_t const> { constantPool }.subspan(
+        node.imm[0], apintext::detail::limbCount(node.format.width));
+  }
+
+  /// Hash of the structure of the program, equal for equal programs
+  uint64_t structuralHash() const {
+    uint64_t res = detail::hashCombine(nodeList.size(), inputList.size());
+    for (Node const& node : nodeList)
+      res = detail::hashCombine(res, detail::hashNode(node));
+    for (uint64_t limb : constantPool)
+      res = detail::hashCombine(res, limb);
+    for (uint32_t output : outputList)
+      res = detail::hashCombine(res, output);
+    return res;
+  }
+
+  friend bool operator==(Program const& lhs, Program const& rhs) {
+    return lhs.nodeList == rhs.nodeList &&
+           lhs.constantPool == rhs.constantPool &&
+           lhs.inputList == rhs.inputList && lhs.outputList == rhs.outputList;
+  }
+};
+} // namespace ir
+} // namespace apintext
+
+#endif // RUNTIME_IR_HPP
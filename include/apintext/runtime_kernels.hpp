@@ -0,0 +1,183 @@
+#ifndef RUNTIME_KERNELS_HPP
+#define RUNTIME_KERNELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "arith_prop.hpp"
+#include "limb_kernels.hpp"
+
+namespace apintext {
+namespace detail {
+/// Kernels on values whose format is only known at run time.
+///
+/// Values are stored as limbCount(width) little-endian limbs, extended to
+/// whole limbs by the sign bit for signed formats and by zeros otherwise.
+/// Results are written to limbs that do not overlap the operands.
+
+/// Extend the top limb of limbs according to format
+inline void normalizeLimbs(uint64_t* limbs, Format format) {
+  uint32_t const topBits = format.width % 64;
+  if (topBits == 0)
+    return;
+  uint64_t& top = limbs[limbCount(format.width) - 1];
+  if (format.signedness) {
+    top = static_cast<uint64_t>(static_cast<int64_t>(top << (64 - topBits)) >>
+                                (64 - topBits));
+  } else {
+    top &= (uint64_t { 1 } << topBits) - 1;
+  }
+}
+
+/// idx-th limb of a value extended past its limbs
+inline uint64_t extendedLimb(uint64_t const* limbs, Format format,
+                             std::size_t idx) {
+  std::size_t const n = limbCount(format.width);
+  if (idx < n)
+    return limbs[idx];
+  return (format.signedness && static_cast<int64_t>(limbs[n - 1]) < 0)
+             ? ~uint64_t { 0 }
+             : 0;
+}
+
+/// idx-th limb of a value read as unsigned, zero past its width
+inline uint64_t unsignedLimb(uint64_t const* limbs, Format format,
+                             std::size_t idx) {
+  std::size_t const n = limbCount(format.width);
+  if (idx >= n)
+    return 0;
+  uint32_t const topBits = format.width % 64;
+  if (idx == n - 1 && topBits != 0)
+    return limbs[idx] & ((uint64_t { 1 } << topBits) - 1);
+  return limbs[idx];
+}
+
+inline void copyExtended(uint64_t* dst, std::size_t n, uint64_t const* src,
+                         Format format) {
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = extendedLimb(src, format, i);
+}
+
+inline void negateLimbs(uint64_t* limbs, std::size_t n) {
+  uint64_t carry = 1;
+  for (std::size_t i = 0; i < n; ++i)
+    limbs[i] = addCarry(~limbs[i], 0, carry, carry);
+}
+
+inline bool limbsZero(uint64_t const* limbs, std::size_t n) {
+  return std::all_of(limbs, limbs + n, [](uint64_t l) { return l == 0; });
+}
+
+/// Three-way comparison of two values in the tight overset of their formats
+inline int compareExtended(uint64_t const* lhs, Format lhsFormat,
+                           uint64_t const* rhs, Format rhsFormat) {
+  Format const format = tightOverset(lhsFormat, rhsFormat);
+  std::size_t const n = limbCount(format.width);
+  for (std::size_t i = n; i-- > 0;) {
+    uint64_t const a = extendedLimb(lhs, lhsFormat, i);
+    uint64_t const b = extendedLimb(rhs, rhsFormat, i);
+    if (a == b)
+      continue;
+    if (format.signedness && i == n - 1)
+      return (static_cast<int64_t>(a) < static_cast<int64_t>(b)) ? -1 : 1;
+    return (a < b) ? -1 : 1;
+  }
+  return 0;
+}
+
+/// n low limbs of the sum of the extended operands
+inline void addExtended(uint64_t* dst, std::size_t n, uint64_t const* lhs,
+                        Format lhsFormat, uint64_t const* rhs,
+                        Format rhsFormat) {
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = addCarry(extendedLimb(lhs, lhsFormat, i),
+                      extendedLimb(rhs, rhsFormat, i), carry, carry);
+}
+
+inline void subExtended(uint64_t* dst, std::size_t n, uint64_t const* lhs,
+                        Format lhsFormat, uint64_t const* rhs,
+                        Format rhsFormat) {
+  uint64_t borrow = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = subBorrow(extendedLimb(lhs, lhsFormat, i),
+                       extendedLimb(rhs, rhsFormat, i), borrow, borrow);
+}
+
+/// n low limbs of the product of the extended operands, by a truncated
+/// schoolbook multiplication
+inline void mulExtended(uint64_t* dst, std::size_t n, uint64_t const* lhs,
+                        Format lhsFormat, uint64_t const* rhs,
+                        Format rhsFormat) {
+  std::fill(dst, dst + n, 0);
+  for (std::size_t i = 0; i < n; ++i) {
+    uint64_t const a = extendedLimb(lhs, lhsFormat, i);
+    if (a == 0)
+      continue;
+    uint64_t carry = 0;
+    for (std::size_t j = 0; i + j < n; ++j) {
+      uint64_t high, c1, c2;
+      uint64_t low = mulWide(a, extendedLimb(rhs, rhsFormat, j), high);
+      low = addCarry(low, dst[i + j], 0, c1);
+      dst[i + j] = addCarry(low, carry, 0, c2);
+      carry = high + c1 + c2;
+    }
+  }
+}
+
+/// n limbs of src starting at lowBit, reading zeros past the source width
+inline void sliceLimbs(uint64_t* dst, std::size_t n, uint64_t const* src,
+                       Format srcFormat, uint32_t lowBit) {
+  if (lowBit >= srcFormat.width) {
+    std::fill(dst, dst + n, 0);
+    return;
+  }
+  std::size_t const first = lowBit / 64;
+  uint32_t const shift = lowBit % 64;
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = funnelShr(unsignedLimb(src, srcFormat, first + i + 1),
+                       unsignedLimb(src, srcFormat, first + i), shift);
+}
+
+/// Limbs of scratch space needed by divModExtended for n-limb operands
+constexpr std::size_t divModScratch(std::size_t n) { return 4 * n + 1; }
+
+/// Truncated division of the operands adapted to their division format,
+/// whose limb count n is that of quot and rem. Division by zero yields an
+/// all-ones quotient and the dividend as remainder.
+inline void divModExtended(uint64_t* quot, uint64_t* rem, uint64_t const* lhs,
+                           Format lhsFormat, uint64_t const* rhs,
+                           Format rhsFormat, uint64_t* scratch) {
+  Format const format = divisionFormat(lhsFormat, rhsFormat);
+  std::size_t const n = limbCount(format.width);
+  uint64_t* const u = scratch;
+  uint64_t* const v = u + n;
+  copyExtended(u, n, lhs, lhsFormat);
+  copyExtended(v, n, rhs, rhsFormat);
+  normalizeLimbs(u, format);
+  normalizeLimbs(v, format);
+  if (limbsZero(v, n)) {
+    std::fill(quot, quot + n, ~uint64_t { 0 });
+    std::copy(u, u + n, rem);
+  } else {
+    // Divide the magnitudes, then restore the signs
+    bool const uNeg = format.signedness && static_cast<int64_t>(u[n - 1]) < 0;
+    bool const vNeg = format.signedness && static_cast<int64_t>(v[n - 1]) < 0;
+    if (uNeg)
+      negateLimbs(u, n);
+    if (vNeg)
+      negateLimbs(v, n);
+    limbDivModN(u, v, quot, rem, n, v + n);
+    if (uNeg != vNeg)
+      negateLimbs(quot, n);
+    if (uNeg)
+      negateLimbs(rem, n);
+  }
+  normalizeLimbs(quot, format);
+  normalizeLimbs(rem, format);
+}
+} // namespace detail
+} // namespace apintext
+
+#endif // RUNTIME_KERNELS_HPP
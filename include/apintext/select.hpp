@@ -0,0 +1,193 @@
+#ifndef SELECT_HPP
+#define SELECT_HPP
+
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#include "aliases.hpp"
+#include "arith_prop.hpp"
+#include "constant_time.hpp"
+#include "expression.hpp"
+
+namespace apintext {
+/// Conditional expressions computed without branches: both alternatives are
+/// evaluated and blended with a mask built from the condition, so that
+/// batched evaluation loops stay free of data dependent control flow.
+namespace detail {
+/// Both operands adapted to their tight overset, as in comparisons
+template <ExprType ET1, ExprType ET2> struct OversetOperands {
+  using overset = TightOverset<ET1, ET2>;
+  static constexpr uint32_t width = overset::width;
+  static constexpr bool signedness = overset::signedness;
+  using adaptor = Adaptor<SignExtension, Forbid, ReinterpretSign>;
+
+  template <ExprType ET>
+  static constexpr ap_repr<width, signedness> compute(ET const& expr) {
+    return adaptor::template adapt<width, signedness>(expr).compute();
+  }
+};
+} // namespace detail
+
+/// Value of ifSet when the one-bit condition is set, of ifUnset otherwise,
+/// in the tight overset of their formats
+template <ExprType Cond, ExprType ET1, ExprType ET2> class SelectExpr {
+  static_assert(Cond::width == 1, "Select conditions should be one bit wide");
+  using operands_t = detail::OversetOperands<ET1, ET2>;
+
+ public:
+  static constexpr uint32_t width = operands_t::width;
+  static constexpr bool signedness = operands_t::signedness;
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  Cond const cond;
+  ET1 const ifSet;
+  ET2 const ifUnset;
+
+ public:
+  constexpr SelectExpr(Cond const& c, ET1 const& val1, ET2 const& val2)
+      : cond { c }
+      , ifSet { val1 }
+      , ifUnset { val2 } {}
+
+  constexpr res_t compute() const {
+    return ct::maskSelect<width, signedness>(
+        static_cast<ap_repr<1, false>>(cond.compute()),
+        operands_t::compute(ifSet), operands_t::compute(ifUnset));
+  }
+
+  constexpr auto operands() const { return std::tie(cond, ifSet, ifUnset); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using cond_t = std::decay_t<decltype(f(cond))>;
+    using set_t = std::decay_t<decltype(f(ifSet))>;
+    using unset_t = std::decay_t<decltype(f(ifUnset))>;
+    return SelectExpr<cond_t, set_t, unset_t> { f(cond), f(ifSet),
+                                                f(ifUnset) };
+  }
+};
+
+template <ExprType Cond, ExprType ET1, ExprType ET2>
+constexpr auto select(Cond const& cond, ET1 const& ifSet,
+                      ET2 const& ifUnset) {
+  using node_t = SelectExpr<operand_t<Cond>, operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(cond), toOperand(ifSet), toOperand(ifUnset) };
+}
+
+/// Smaller (or, with max, larger) of two expressions, in the tight overset
+/// of their formats
+template <ExprType ET1, ExprType ET2, bool max> class MinMaxExpr {
+  using operands_t = detail::OversetOperands<ET1, ET2>;
+
+ public:
+  static constexpr uint32_t width = operands_t::width;
+  static constexpr bool signedness = operands_t::signedness;
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  ET1 const leftOp;
+  ET2 const rightOp;
+
+ public:
+  constexpr MinMaxExpr(ET1 const& val1, ET2 const& val2)
+      : leftOp { val1 }
+      , rightOp { val2 } {}
+
+  constexpr res_t compute() const {
+    auto const left = operands_t::compute(leftOp);
+    auto const right = operands_t::compute(rightOp);
+    auto const less = ct::lessThan<width, signedness>(left, right);
+    if constexpr (max) {
+      return ct::maskSelect<width, signedness>(less, right, left);
+    } else {
+      return ct::maskSelect<width, signedness>(less, left, right);
+    }
+  }
+
+  constexpr auto operands() const { return std::tie(leftOp, rightOp); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using left_t = std::decay_t<decltype(f(leftOp))>;
+    using right_t = std::decay_t<decltype(f(rightOp))>;
+    return MinMaxExpr<left_t, right_t, max> { f(leftOp), f(rightOp) };
+  }
+};
+
+template <ExprType ET1, ExprType ET2>
+using ExprMin = MinMaxExpr<ET1, ET2, false>;
+
+template <ExprType ET1, ExprType ET2>
+using ExprMax = MinMaxExpr<ET1, ET2, true>;
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto min(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprMin<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+template <ExprType ET1, ExprType ET2>
+constexpr auto max(ET1 const& expr1, ET2 const& expr2) {
+  using node_t = ExprMax<operand_t<ET1>, operand_t<ET2>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+/// Operands of the same type: the template heads match those of std::min
+/// and std::max, so that these more constrained overloads are preferred
+/// when both are visible, as with using namespace std
+template <typename ET>
+  requires ExprType<ET>
+constexpr auto min(ET const& expr1, ET const& expr2) {
+  using node_t = ExprMin<operand_t<ET>, operand_t<ET>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+template <typename ET>
+  requires ExprType<ET>
+constexpr auto max(ET const& expr1, ET const& expr2) {
+  using node_t = ExprMax<operand_t<ET>, operand_t<ET>>;
+  return node_t { toOperand(expr1), toOperand(expr2) };
+}
+
+/// Absolute value, one bit wider than signed sources so that the most
+/// negative value has a representable magnitude. Unsigned sources are left
+/// unchanged.
+template <ExprType ET> class ExprAbs {
+  static constexpr Format format = absFormat({ ET::width, ET::signedness });
+
+ public:
+  static constexpr uint32_t width = format.width;
+  static constexpr bool signedness = format.signedness;
+
+ private:
+  using res_t = ap_repr<width, signedness>;
+  ET const source;
+
+ public:
+  constexpr ExprAbs(ET const& src)
+      : source { src } {}
+
+  constexpr res_t compute() const {
+    auto const value = source.compute();
+    if constexpr (signedness) {
+      using u_t = ap_repr<width, false>;
+      auto const negative = ct::msb<ET::width, true>(value);
+      return static_cast<res_t>(ct::conditionalNegate<width>(
+          static_cast<u_t>(static_cast<res_t>(value)), negative));
+    } else {
+      return value;
+    }
+  }
+
+  constexpr auto operands() const { return std::tie(source); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(source))>;
+    return ExprAbs<mapped_t> { f(source) };
+  }
+};
+
+template <ExprType ET> constexpr auto abs(ET const& expr) {
+  using node_t = ExprAbs<operand_t<ET>>;
+  return node_t { toOperand(expr) };
+}
+} // namespace apintext
+
+#endif // SELECT_HPP
@@ -0,0 +1,371 @@
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define APINTEXT_HAS_MMAP 1
+#endif
+
+#include "aliases.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
+#include "value.hpp"
+
+namespace apintext {
+
+/// Binary traces of values of a single format.
+///
+/// A trace starts with a 32-byte header:
+///   bytes  0-3   magic "APXT"
+///   bytes  4-5   format version
+///   byte   6     signedness
+///   bytes  8-11  width
+///   bytes 16-23  element count
+/// the other bytes being zero. It is followed by the bit-packed payload:
+/// element i occupies the bits [i * width, (i + 1) * width) of a sequence of
+/// 64-bit words, least significant bits first. All the integers are stored
+/// little-endian, and the payload is 8-byte aligned when the trace is.
+struct TraceHeader {
+  static constexpr std::size_t size = 32;
+  uint32_t width;
+  bool signedness;
+  uint64_t count;
+
+  constexpr uint64_t payloadWords() const {
+    return (uint64_t { width } * count + 63) / 64;
+  }
+
+  constexpr uint64_t traceSize() const { return size + 8 * payloadWords(); }
+};
+
+namespace detail {
+constexpr std::array<char, 4> traceMagic { 'A', 'P', 'X', 'T' };
+constexpr uint16_t traceVersion = 1;
+
+constexpr uint64_t toLittleEndian(uint64_t word) {
+  if constexpr (std::endian::native == std::endian::big) {
+    return __builtin_bswap64(word);
+  } else {
+    return word;
+  }
+}
+
+template <typename T> inline T loadLittleEndian(std::byte const* src) {
+  T res = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    res |= static_cast<T>(std::to_integer<uint8_t>(src[i])) << (8 * i);
+  return res;
+}
+
+template <typename T> inline void storeLittleEndian(std::byte* dst, T val) {
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    dst[i] = static_cast<std::byte>(val >> (8 * i));
+}
+
+inline uint64_t loadWord(std::byte const* payload, uint64_t idx) {
+  uint64_t word;
+  std::memcpy(&word, payload + 8 * idx, sizeof(word));
+  return toLittleEndian(word);
+}
+
+inline std::array<std::byte, TraceHeader::size>
+encodeHeader(TraceHeader const& header) {
+  std::array<std::byte, TraceHeader::size> res {};
+  for (std::size_t i = 0; i < traceMagic.size(); ++i)
+    res[i] = static_cast<std::byte>(traceMagic[i]);
+  storeLittleEndian(res.data() + 4, traceVersion);
+  res[6] = static_cast<std::byte>(header.signedness);
+  storeLittleEndian(res.data() + 8, header.width);
+  storeLittleEndian(res.data() + 16, header.count);
+  return res;
+}
+} // namespace detail
+
+/// Decode and validate the header of the trace stored in data
+inline TraceHeader readTraceHeader(std::span<std::byte const> data) {
+  if (data.size() < TraceHeader::size)
+    throw std::invalid_argument("Trace smaller than its header");
+  for (std::size_t i = 0; i < detail::traceMagic.size(); ++i)
+    if (std::to_integer<char>(data[i]) != detail::traceMagic[i])
+      throw std::invalid_argument("Not a value trace");
+  if (detail::loadLittleEndian<uint16_t>(data.data() + 4) !=
+      detail::traceVersion)
+    throw std::invalid_argument("Unsupported trace version");
+  TraceHeader const header {
+    detail::loadLittleEndian<uint32_t>(data.data() + 8),
+    std::to_integer<uint8_t>(data[6]) != 0,
+    detail::loadLittleEndian<uint64_t>(data.data() + 16)
+  };
+  if (header.width == 0 ||
+      header.count > (UINT64_MAX - 63) / header.width ||
+      data.size() < header.traceSize())
+    throw std::invalid_argument("Truncated trace payload");
+  return header;
+}
+
+/// Element of a trace, unpacked on each compute()
+template <uint32_t w, bool s> class PackedElement {
+ public:
+  static constexpr uint32_t width = w;
+  static constexpr bool signedness = s;
+
+ private:
+  std::byte const* payload;
+  uint64_t wordCount;
+  uint64_t bitOffset;
+
+ public:
+  PackedElement(std::byte const* payload, uint64_t wordCount,
+                uint64_t bitOffset)
+      : payload { payload }
+      , wordCount { wordCount }
+      , bitOffset { bitOffset } {}
+
+  ap_repr<w, s> compute() const {
+    uint64_t const first = bitOffset / 64;
+    uint32_t const shift = bitOffset % 64;
+    detail::limbs_t<detail::limbCount(w)> limbs;
+    detail::limbFor<detail::limbCount(w)>([&](std::size_t i) {
+      uint64_t const idx = first + i;
+      uint64_t limb = detail::loadWord(payload, idx) >> shift;
+      if (shift != 0 && idx + 1 < wordCount)
+        limb |= detail::loadWord(payload, idx + 1) << (64 - shift);
+      limbs[i] = limb;
+    });
+    return static_cast<ap_repr<w, s>>(detail::fromLimbs<w>(limbs));
+  }
+};
+
+/// Zero-copy view of a trace of (w, s) values, whose elements are
+/// expressions. The viewed memory should outlive the view and its elements.
+template <uint32_t w, bool s> class TraceView {
+ private:
+  std::byte const* payload;
+  uint64_t wordCount;
+  uint64_t count;
+
+ public:
+  using value_type = PackedElement<w, s>;
+
+  class iterator {
+   private:
+    TraceView const* view;
+    uint64_t idx;
+
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = PackedElement<w, s>;
+    using difference_type = std::ptrdiff_t;
+
+    iterator()
+        : view { nullptr }
+        , idx { 0 } {}
+    iterator(TraceView const* view, uint64_t idx)
+        : view { view }
+        , idx { idx } {}
+
+    value_type operator*() const { return (*view)[idx]; }
+    iterator& operator++() {
+      ++idx;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator res { *this };
+      ++idx;
+      return res;
+    }
+    bool operator==(iterator const& rhs) const { return idx == rhs.idx; }
+  };
+
+  explicit TraceView(std::span<std::byte const> data) {
+    TraceHeader const header = readTraceHeader(data);
+    if (header.width != w || header.signedness != s)
+      throw std::invalid_argument("Trace format mismatch");
+    payload = data.data() + TraceHeader::size;
+    wordCount = header.payloadWords();
+    count = header.count;
+  }
+
+  uint64_t size() const { return count; }
+
+  value_type operator[](uint64_t idx) const {
+    return value_type { payload, wordCount, idx * w };
+  }
+
+  iterator begin() const { return iterator { this, 0 }; }
+  iterator end() const { return iterator { this, count }; }
+};
+
+/// Streaming trace writer. The header is written first with a null count,
+/// which is patched by close(), so the stream should be seekable.
+template <uint32_t w, bool s> class TraceWriter {
+ private:
+  static constexpr std::size_t bufferWords = 1024;
+
+  std::ostream& out;
+  std::ostream::pos_type start;
+  uint64_t count = 0;
+  std::array<uint64_t, bufferWords> buffer;
+  std::size_t bufferedWords = 0;
+  /// Bits of the word being packed, and how many of them are used
+  uint64_t pending = 0;
+  uint32_t pendingBits = 0;
+  bool closed = false;
+
+  void writeHeader() {
+    auto const header = detail::encodeHeader(TraceHeader { w, s, count });
+    out.write(reinterpret_cast<char const*>(header.data()), header.size());
+  }
+
+  void flushBuffer() {
+    for (std::size_t i = 0; i < bufferedWords; ++i)
+      buffer[i] = detail::toLittleEndian(buffer[i]);
+    out.write(reinterpret_cast<char const*>(buffer.data()),
+              bufferedWords * sizeof(uint64_t));
+    bufferedWords = 0;
+  }
+
+  void pushWord(uint64_t word) {
+    buffer[bufferedWords++] = word;
+    if (bufferedWords == bufferWords)
+      flushBuffer();
+  }
+
+ public:
+  explicit TraceWriter(std::ostream& out)
+      : out { out }
+      , start { out.tellp() } {
+    writeHeader();
+  }
+
+  TraceWriter(TraceWriter const&) = delete;
+  TraceWriter& operator=(TraceWriter const&) = delete;
+
+  ~TraceWriter() {
+    if (!closed) {
+      try {
+        close();
+      } catch (...) {
+      }
+    }
+  }
+
+  uint64_t size() const { return count; }
+
+  void write(Value<w, s> const& value) {
+    auto const limbs =
+        detail::toLimbs<w>(static_cast<ap_repr<w, false>>(value.compute()));
+    detail::limbFor<detail::limbCount(w)>([&](std::size_t i) {
+      uint32_t const bits = (i + 1 < limbs.size()) ? 64 : w - 64 * i;
+      pending |= limbs[i] << pendingBits;
+      if (pendingBits + bits >= 64) {
+        pushWord(pending);
+        pending = (pendingBits != 0) ? limbs[i] >> (64 - pendingBits) : 0;
+        pendingBits = pendingBits + bits - 64;
+      } else {
+        pendingBits += bits;
+      }
+    });
+    ++count;
+  }
+
+  template <typename Range> void writeAll(Range const& values) {
+    for (auto const& value : values)
+      write(value);
+  }
+
+  /// Flush the payload and write the final count in the header
+  void close() {
+    closed = true;
+    if (pendingBits != 0)
+      pushWord(pending);
+    flushBuffer();
+    auto const end = out.tellp();
+    out.seekp(start);
+    writeHeader();
+    out.seekp(end);
+    out.flush();
+    if (!out)
+      throw std::runtime_error("Failed to write trace");
+  }
+};
+
+#ifdef APINTEXT_HAS_MMAP
+/// Read-only memory mapping of a trace file
+template <uint32_t w, bool s> class MappedTrace {
+ private:
+  void* address = nullptr;
+  std::size_t length = 0;
+
+  void unmap() {
+    if (address != nullptr)
+      ::munmap(address, length);
+    address = nullptr;
+  }
+
+ public:
+  explicit MappedTrace(std::string const& path) {
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(), path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      int const err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), path);
+    }
+    length = static_cast<std::size_t>(st.st_size);
+    if (length < TraceHeader::size) {
+      ::close(fd);
+      throw std::invalid_argument("Trace smaller than its header");
+    }
+    address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    int const err = errno;
+    ::close(fd);
+    if (address == MAP_FAILED) {
+      address = nullptr;
+      throw std::system_error(err, std::generic_category(), path);
+    }
+    ::madvise(address, length, MADV_SEQUENTIAL);
+  }
+
+  MappedTrace(MappedTrace&& other) noexcept
+      : address { std::exchange(other.address, nullptr) }
+      , length { other.length } {}
+
+  MappedTrace& operator=(MappedTrace&& other) noexcept {
+    unmap();
+    address = std::exchange(other.address, nullptr);
+    length = other.length;
+    return *this;
+  }
+
+  ~MappedTrace() { unmap(); }
+
+  std::span<std::byte const> bytes() const {
+    return { static_cast<std::byte const*>(address), length };
+  }
+
+  TraceView<w, s> view() const { return TraceView<w, s> { bytes() }; }
+};
+#endif
+
+} // namespace apintext
+
+#endif // SERIALIZATION_HPP
@@ -0,0 +1,253 @@
+#ifndef SORT_HPP
+#define SORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aliases.hpp"
+#include "constant_time.hpp"
+#include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "parallel.hpp"
+#include "value.hpp"
+
+namespace apintext {
+/// Sorting of values and of records keyed on expressions: least significant
+/// digit radix sorts, whose digits are slices of the keys, and sorting
+/// networks for small fixed sizes, whose compare-exchanges are branch free.
+namespace detail {
+/// Digits of digitBits bits of keys of type K, least significant first.
+/// The sign bit of signed keys is flipped so that the unsigned order of the
+/// digits is the order of the keys.
+template <uint32_t digitBits, ExprType K> struct RadixDigits {
+  static_assert(digitBits >= 1 && digitBits <= 12,
+                "Radix digits should be 1 to 12 bits wide");
+  static constexpr std::size_t count =
+      (K::width + digitBits - 1) / digitBits;
+  static constexpr std::size_t buckets = std::size_t { 1 } << digitBits;
+
+  template <std::size_t d> static constexpr std::size_t get(K const& key) {
+    constexpr uint32_t low = d * digitBits;
+    constexpr uint32_t high = std::min(low + digitBits, K::width) - 1;
+    auto const digit = static_cast<std::size_t>(
+        static_cast<uint64_t>(SliceExpr<high, low, K> { key }.compute()));
+    if constexpr (K::signedness && high == K::width - 1)
+      return digit ^ (std::size_t { 1 } << (high - low));
+    return digit;
+  }
+};
+
+/// Records in a chunk are read sequentially and scattered over the buckets
+/// of a digit, so chunks much smaller than this are not worth scheduling
+constexpr std::size_t minRadixChunk = std::size_t { 1 } << 14;
+
+/// Stable LSD radix sort of records on key(record), splitting the records
+/// in chunkCount chunks whose digits are counted and scattered by
+/// forEach(chunkCount, task), which calls task(chunk) for each chunk.
+///
+/// A single pass over the records counts all the digits, which is enough
+/// for a single chunk, while several chunks recount their digit after the
+/// first scatter. Passes whose digit is the same for all the records are
+/// skipped.
+template <uint32_t digitBits, typename T, typename KeyFn, typename ForEach>
+void radixSort(std::span<T> records, KeyFn const& key,
+               std::size_t chunkCount, ForEach const& forEach) {
+  using key_t = std::decay_t<std::invoke_result_t<KeyFn const&, T const&>>;
+  static_assert(ExprType<key_t>, "Radix sort keys should be expressions");
+  using digits = RadixDigits<digitBits, key_t>;
+  constexpr std::size_t B = digits::buckets;
+  constexpr std::size_t D = digits::count;
+
+  std::size_t const n = records.size();
+  if (n < 2)
+    return;
+  chunkCount = std::clamp<std::size_t>(n / minRadixChunk, 1, chunkCount);
+  auto const chunkBegin = [&](std::size_t c) { return n * c / chunkCount; };
+
+  // counts[(c * D + d) * B + b]: records of chunk c whose digit d is b
+  std::vector<std::size_t> counts(chunkCount * D * B, 0);
+  forEach(chunkCount, [&](std::size_t c) {
+    std::size_t* const chunkCounts = counts.data() + c * D * B;
+    for (std::size_t i = chunkBegin(c); i < chunkBegin(c + 1); ++i) {
+      auto const k = std::invoke(key, std::as_const(records[i]));
+      unrolledFor<D>([&](auto d) {
+        ++chunkCounts[d * B + digits::template get<d>(k)];
+      });
+    }
+  });
+
+  std::vector<T> scratch(n);
+  std::span<T> src = records;
+  std::span<T> dst = scratch;
+  std::vector<std::size_t> offsets(chunkCount * B);
+  bool reordered = false;
+  unrolledFor<D>([&](auto d) {
+    // The counts of the chunks only hold for the initial order, the totals
+    // of the buckets being the same for any order
+    if (reordered && chunkCount > 1) {
+      forEach(chunkCount, [&](std::size_t c) {
+        std::size_t* const chunkCounts = counts.data() + (c * D + d) * B;
+        std::fill_n(chunkCounts, B, 0);
+        for (std::size_t i = chunkBegin(c); i < chunkBegin(c + 1); ++i)
+          ++chunkCounts[digits::template get<d>(
+              std::invoke(key, std::as_const(src[i])))];
+      });
+    }
+    // Running offsets of the buckets of each chunk, the chunks of a bucket
+    // being placed in order to keep the sort stable
+    std::size_t offset = 0;
+    for (std::size_t b = 0; b < B; ++b) {
+      for (std::size_t c = 0; c < chunkCount; ++c) {
+        offsets[c * B + b] = offset;
+        offset += counts[(c * D + d) * B + b];
+      }
+      if (offsets[b] == 0 && offset == n)
+        return;
+    }
+    forEach(chunkCount, [&](std::size_t c) {
+      // Local copy, which the stores to dst cannot alias
+      std::array<std::size_t, B> chunkOffsets;
+      std::copy_n(offsets.data() + c * B, B, chunkOffsets.begin());
+      for (std::size_t i = chunkBegin(c); i < chunkBegin(c + 1); ++i) {
+        auto const k = std::invoke(key, std::as_const(src[i]));
+        dst[chunkOffsets[digits::template get<d>(k)]++] = std::move(src[i]);
+      }
+    });
+    std::swap(src, dst);
+    reordered = true;
+  });
+
+  if (src.data() != records.data()) {
+    forEach(chunkCount, [&](std::size_t c) {
+      std::move(src.begin() + chunkBegin(c), src.begin() + chunkBegin(c + 1),
+                records.begin() + chunkBegin(c));
+    });
+  }
+}
+
+template <std::ranges::contiguous_range R>
+auto recordSpan(R&& records) {
+  return std::span { std::ranges::data(records), std::ranges::size(records) };
+}
+
+/// Key of values sorted on themselves
+struct IdentityKey {
+  template <ExprType ET> constexpr ET const& operator()(ET const& v) const {
+    return v;
+  }
+};
+
+/// Pair of indices compared and exchanged by a sorting network
+struct Comparator {
+  uint32_t low;
+  uint32_t high;
+};
+
+/// Batcher's odd-even merge sort of bit_ceil(N) inputs, calling
+/// emit(low, high) for its comparators. Inputs past N are +infinity and
+/// never exchanged, so the comparators reading them are left out.
+template <typename F>
+constexpr void oddEvenMergeNetwork(uint32_t N, F&& emit) {
+  uint32_t const padded = std::bit_ceil(N);
+  for (uint32_t p = 1; p < padded; p *= 2)
+    for (uint32_t k = p; k >= 1; k /= 2)
+      for (uint32_t j = k % p; j + k < padded; j += 2 * k)
+        for (uint32_t i = 0; i < k; ++i)
+          if ((i + j) / (2 * p) == (i + j + k) / (2 * p) && i + j + k < N)
+            emit(i + j, i + j + k);
+}
+
+template <std::size_t N> constexpr std::size_t networkSize() {
+  std::size_t res = 0;
+  oddEvenMergeNetwork(N, [&](uint32_t, uint32_t) { ++res; });
+  return res;
+}
+} // namespace detail
+
+/// Sort records by key(record) in increasing order, keeping the order of
+/// records with equal keys. key should return an expression, like a
+/// slice of a field of the record; it is called once per record for the
+/// digit counts and once per pass.
+///
+/// The keys are split in digits of digitBits bits, so that records are
+/// sorted in ceil(width / digitBits) linear passes at most, with a scratch
+/// copy of the records. Records should be default constructible and
+/// movable.
+template <uint32_t digitBits = 8, std::ranges::contiguous_range R,
+          typename KeyFn>
+void radixSort(R&& records, KeyFn const& key) {
+  detail::radixSort<digitBits>(
+      detail::recordSpan(records), key, 1,
+      [](std::size_t chunkCount, auto const& task) {
+        for (std::size_t c = 0; c < chunkCount; ++c)
+          task(c);
+      });
+}
+
+/// Sort values (or any expressions) in increasing order
+template <uint32_t digitBits = 8, std::ranges::contiguous_range R>
+void radixSort(R&& values) {
+  radixSort<digitBits>(values, detail::IdentityKey {});
+}
+
+/// Parallel radix sort: the digits of chunks of the records are counted and
+/// scattered by the participants of pool, giving the same result as the
+/// sequential sort.
+template <uint32_t digitBits = 8, std::ranges::contiguous_range R,
+          typename KeyFn>
+void radixSort(ThreadPool& pool, R&& records, KeyFn const& key) {
+  detail::radixSort<digitBits>(
+      detail::recordSpan(records), key,
+      pool.size() * detail::chunksPerParticipant,
+      [&pool](std::size_t chunkCount, auto const& task) {
+        pool.forEachChunk(chunkCount,
+                          [&](uint64_t c) { task(std::size_t(c)); });
+      });
+}
+
+template <uint32_t digitBits = 8, std::ranges::contiguous_range R>
+void radixSort(ThreadPool& pool, R&& values) {
+  radixSort<digitBits>(pool, values, detail::IdentityKey {});
+}
+
+/// Comparators of a sorting network of N inputs, from Batcher's odd-even
+/// merge sort: comparing and exchanging the inputs low and high of each one
+/// in order sorts any input
+template <std::size_t N>
+constexpr auto sortingNetwork = [] {
+  std::array<detail::Comparator, detail::networkSize<N>()> res {};
+  std::size_t idx = 0;
+  detail::oddEvenMergeNetwork(N, [&](uint32_t low, uint32_t high) {
+    res[idx++] = { low, high };
+  });
+  return res;
+}();
+
+/// Sort N values in increasing order with a sorting network. Each
+/// compare-exchange is lowered like min and max: a single comparison
+/// selects both results without branches, so that the sequence of
+/// operations does not depend on the values.
+template <uint32_t w, bool s, typename... Policies, std::size_t N>
+constexpr void networkSort(std::array<Value<w, s, Policies...>, N>& values) {
+  constexpr auto& network = sortingNetwork<N>;
+  detail::unrolledFor<network.size()>([&](auto i) {
+    constexpr detail::Comparator comparator = network[i];
+    auto const low = values[comparator.low].compute();
+    auto const high = values[comparator.high].compute();
+    auto const swap = ct::lessThan<w, s>(high, low);
+    values[comparator.low] = ct::maskSelect<w, s>(swap, high, low);
+    values[comparator.high] = ct::maskSelect<w, s>(swap, low, high);
+  });
+}
+} // namespace apintext
+
+#endif // SORT_HPP
@@ -0,0 +1,228 @@
+#ifndef TABLE_HPP
+#define TABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "aliases.hpp"
+#include "batch.hpp"
+#include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
+#include "traversal.hpp"
+
+namespace apintext {
+/// Tables are indexed by the placeholders of the tabulated expression, at
+/// most this many bits in total
+constexpr uint32_t maxTableInputBits = 16;
+
+namespace detail {
+/// Smallest unsigned word holding w bits
+template <uint32_t w>
+using table_word_t = std::conditional_t<
+    (w <= 8), uint8_t,
+    std::conditional_t<(w <= 16), uint16_t,
+                       std::conditional_t<(w <= 32), uint32_t, uint64_t>>>;
+
+/// count entries of w bits, each stored in the smallest word holding it
+template <uint32_t w, std::size_t count, bool packed> class TableStorage {
+  std::array<table_word_t<w>, count> entries {};
+
+ public:
+  constexpr uint64_t get(std::size_t idx) const { return entries[idx]; }
+  constexpr void set(std::size_t idx, uint64_t bits) {
+    entries[idx] = static_cast<table_word_t<w>>(bits);
+  }
+};
+
+/// count entries of w bits stored back to back, with a trailing limb so
+/// that the two limbs spanned by an entry can always be read
+template <uint32_t w, std::size_t count> class TableStorage<w, count, true> {
+  static constexpr uint64_t mask =
+      (w == 64) ? ~uint64_t { 0 } : (uint64_t { 1 } << w) - 1;
+  std::array<uint64_t, (count * w + 63) / 64 + 1> limbs {};
+
+ public:
+  constexpr uint64_t get(std::size_t idx) const {
+    std::size_t const offset = idx * w;
+    return funnelShr(limbs[offset / 64 + 1], limbs[offset / 64],
+                     offset % 64) &
+           mask;
+  }
+  constexpr void set(std::size_t idx, uint64_t bits) {
+    std::size_t const offset = idx * w;
+    limbs[offset / 64] |= bits << (offset % 64);
+    if (offset % 64 != 0)
+      limbs[offset / 64 + 1] |= bits >> (64 - offset % 64);
+  }
+};
+
+/// Placeholders of ET by increasing index, which are its table inputs
+template <ExprType ET, typename Seq> struct TableInputs;
+
+template <ExprType ET, std::size_t... I>
+struct TableInputs<ET, std::index_sequence<I...>> {
+  static_assert(
+      (!std::is_void_v<placeholder_t<ET, I>> && ...),
+      "Placeholder indices of tabulated expressions should be contiguous");
+  using type = std::tuple<placeholder_t<ET, I>...>;
+};
+
+template <ExprType ET>
+using table_inputs_t = typename TableInputs<
+    ET, std::make_index_sequence<placeholderCount<ET>>>::type;
+
+template <typename Tuple> struct TupleBits;
+
+template <typename... Ps> struct TupleBits<std::tuple<Ps...>> {
+  static constexpr uint32_t value = (uint32_t { 0 } + ... + Ps::width);
+};
+
+/// Bit pattern of the value of an expression of at most 64 bits
+template <ExprType ET> constexpr uint64_t patternOf(ET const& expr) {
+  return toLimbs<ET::width>(
+      static_cast<ap_repr<ET::width, false>>(expr.compute()))[0];
+}
+
+/// Table index of the inputs: the first one in the low bits
+template <typename... Ps>
+constexpr std::size_t tableIndex(Ps const&... inputs) {
+  std::size_t idx = 0;
+  uint32_t offset = 0;
+  ((idx |= patternOf(inputs) << offset, offset += Ps::width), ...);
+  return idx;
+}
+} // namespace detail
+
+template <typename Table, ExprType... Inputs> class TableLookupExpr;
+
+/// Table of the values of an expression for all the combinations of its
+/// placeholders, built by tabulate(). It is an expression of the format of
+/// the tabulated one, whose evaluation is a single load. With packed, the
+/// entries are stored at bit granularity instead of in the smallest
+/// machine word holding them.
+///
+/// The table is meant to be built at compile time and kept in static
+/// storage: expressions substituted from it refer to it, and should not
+/// outlive it.
+template <ExprType ET, bool packed = false> class LookupTable {
+ public:
+  static constexpr uint32_t width = ET::width;
+  static constexpr bool signedness = ET::signedness;
+  using res_t = ap_repr<width, signedness>;
+  using inputs_t = detail::table_inputs_t<ET>;
+  static constexpr uint32_t inputBits = detail::TupleBits<inputs_t>::value;
+  static_assert(inputBits <= maxTableInputBits,
+                "Too many input bits to tabulate the expression");
+  static_assert(width <= 64, "Tabulated expressions should fit 64 bits");
+  static constexpr std::size_t entryCount = std::size_t { 1 } << inputBits;
+
+ private:
+  detail::TableStorage<width, entryCount, packed> storage;
+  inputs_t inputs;
+
+  template <std::size_t... I>
+  constexpr void build(ET const& expr, std::index_sequence<I...>) {
+    constexpr std::array<uint32_t, sizeof...(I)> offsets = [] {
+      std::array<uint32_t, sizeof...(I)> res {};
+      uint32_t offset = 0;
+      ((res[I] = offset, offset += std::tuple_element_t<I, inputs_t>::width),
+       ...);
+      return res;
+    }();
+    for (std::size_t idx = 0; idx < entryCount; ++idx) {
+      auto const value = substitute(
+          expr, inputRepr<std::tuple_element_t<I, inputs_t>>(
+                    idx >> offsets[I])...);
+      storage.set(idx, detail::patternOf(value));
+    }
+  }
+
+  /// Representation of the input P whose bits are the low bits of index
+  template <typename P> static constexpr auto inputRepr(uint64_t index) {
+    uint64_t const bits = index & ((uint64_t { 1 } << P::width) - 1);
+    return static_cast<ap_repr<P::width, P::signedness>>(
+        static_cast<ap_repr<P::width, false>>(bits));
+  }
+
+ public:
+  constexpr explicit LookupTable(ET const& expr) {
+    build(expr, std::make_index_sequence<std::tuple_size_v<inputs_t>> {});
+  }
+
+  template <ExprType... Ps> constexpr res_t lookup(Ps const&... ps) const {
+    auto const bits = storage.get(detail::tableIndex(ps...));
+    return static_cast<res_t>(detail::fromLimbs<width>({ bits }));
+  }
+
+  constexpr res_t compute() const {
+    return std::apply([this](auto const&... ps) { return lookup(ps...); },
+                      inputs);
+  }
+
+  constexpr auto operands() const {
+    return std::apply([](auto const&... ps) { return std::tie(ps...); },
+                      inputs);
+  }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    return std::apply(
+        [&](auto const&... ps) {
+          return TableLookupExpr<LookupTable,
+                                 std::decay_t<decltype(f(ps))>...> {
+            *this, f(ps)...
+          };
+        },
+        inputs);
+  }
+};
+
+/// Lookup in a table whose inputs are the given expressions
+template <typename Table, ExprType... Inputs> class TableLookupExpr {
+ public:
+  static constexpr uint32_t width = Table::width;
+  static constexpr bool signedness = Table::signedness;
+  using res_t = ap_repr<width, signedness>;
+
+ private:
+  Table const* table;
+  std::tuple<Inputs...> inputs;
+
+ public:
+  constexpr TableLookupExpr(Table const& table, Inputs const&... inputs)
+      : table { &table }
+      , inputs { inputs... } {}
+
+  constexpr res_t compute() const {
+    return std::apply(
+        [this](auto const&... ps) { return table->lookup(ps...); }, inputs);
+  }
+
+  constexpr auto operands() const {
+    return std::apply([](auto const&... ps) { return std::tie(ps...); },
+                      inputs);
+  }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    return std::apply(
+        [&](auto const&... ps) {
+          return TableLookupExpr<Table, std::decay_t<decltype(f(ps))>...> {
+            *table, f(ps)...
+          };
+        },
+        inputs);
+  }
+};
+
+/// Table of the values of expr for all the combinations of its
+/// placeholders, whose indices should be contiguous from 0. Every
+/// combination should be valid for expr: divisions by zero are undefined.
+template <bool packed = false, ExprType ET>
+constexpr LookupTable<ET, packed> tabulate(ET const& expr) {
+  return LookupTable<ET, packed> { expr };
+}
+} // namespace apintext
+
+#endif // TABLE_HPP
@@ -0,0 +1,81 @@
+#ifndef TRAVERSAL_HPP
+#define TRAVERSAL_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "expression.hpp"
+
+namespace apintext {
+template <typename... Ts> struct TypeList {
+  static constexpr std::size_t size = sizeof...(Ts);
+};
+
+namespace detail {
+template <typename Tuple> struct TupleToTypeList;
+
+template <typename... Ts> struct TupleToTypeList<std::tuple<Ts...>> {
+  using type = TypeList<std::decay_t<Ts>...>;
+};
+
+template <typename... Lists> struct ConcatTypeLists {
+  using type = TypeList<>;
+};
+
+template <typename... Ts> struct ConcatTypeLists<TypeList<Ts...>> {
+  using type = TypeList<Ts...>;
+};
+
+template <typename... T1s, typename... T2s, typename... Rest>
+struct ConcatTypeLists<TypeList<T1s...>, TypeList<T2s...>, Rest...>
+    : ConcatTypeLists<TypeList<T1s..., T2s...>, Rest...> {};
+} // namespace detail
+
+/// Types of the direct operands of an expression, empty for leaves
+template <ExprType ET> struct OperandTypes {
+  using type = TypeList<>;
+};
+
+template <CompositeExpr ET> struct OperandTypes<ET> {
+  using type = typename detail::TupleToTypeList<
+      decltype(std::declval<ET const&>().operands())>::type;
+};
+
+template <ExprType ET>
+using operand_types_t = typename OperandTypes<ET>::type;
+
+/// Types of the leaves of an expression tree, in depth first order
+template <ExprType ET> struct LeafTypes {
+  using type = TypeList<ET>;
+};
+
+namespace detail {
+template <typename List> struct LeafTypesOfAll;
+
+template <typename... ETs> struct LeafTypesOfAll<TypeList<ETs...>> {
+  using type =
+      typename ConcatTypeLists<typename LeafTypes<ETs>::type...>::type;
+};
+} // namespace detail
+
+template <CompositeExpr ET> struct LeafTypes<ET> {
+  using type = typename detail::LeafTypesOfAll<operand_types_t<ET>>::type;
+};
+
+template <ExprType ET> using leaf_types_t = typename LeafTypes<ET>::type;
+
+/// Rebuild an expression tree, replacing each leaf by f(leaf)
+template <ExprType ET, typename F>
+constexpr auto transformLeaves(ET const& expr, F const& f) {
+  if constexpr (CompositeExpr<ET>) {
+    return expr.mapOperands(
+        [&f](auto const& operand) { return transformLeaves(operand, f); });
+  } else {
+    return f(expr);
+  }
+}
+} // namespace apintext
+
+#endif // TRAVERSAL_HPP
@@ -2,13 +2,21 @@
 #define VALUE_HPP
 
 #include <concepts>
+#include <cstddef>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include "aliases.hpp"
 #include "expression.hpp"
+#include "limb_kernels.hpp"
+#include "limbs.hpp"
 
 namespace apintext {
 
+template <uint32_t highBit, uint32_t lowBit, typename ValueType>
+class SliceRef;
+
 template <uint32_t w, bool s, typename ExtensionPolicy = SignExtension,
           typename TruncationPolicy = Truncation,
           typename WrongSignPolicy = ReinterpretSign>
@@ -22,7 +30,13 @@ class Value {
   val_t value;
   using adaptor = Adaptor<ExtensionPolicy, TruncationPolicy, WrongSignPolicy>;
 
+  template <uint32_t, uint32_t, typename> friend class SliceRef;
+
  public:
+  /// Zero value, so that values can be stored in containers
+  constexpr Value()
+      : value { 0 } {}
+
   constexpr Value(val_t src_repr)
       : value { src_repr } {}
 
@@ -37,15 +51,28 @@ class Value {
   constexpr Value(I const& val)
       : Value { toExpr(val) } {}
 
+#ifdef APINTEXT_NATIVE_INT
   template <uint32_t ws>
-  constexpr Value(unsigned _ExtInt(ws) const& val)
+  constexpr Value(unsigned APINTEXT_NATIVE_INT(ws) const& val)
       : Value { toExpr(val) } {}
 
   template <uint32_t ws>
-  constexpr Value(signed _ExtInt(ws) const& val)
+  constexpr Value(signed APINTEXT_NATIVE_INT(ws) const& val)
+      : Value { toExpr(val) } {}
+#endif
+
+  template <uint32_t ws, bool ss>
+    requires std::same_as<ap_repr<ws, ss>, LimbInt<ws, ss>>
+  constexpr Value(LimbInt<ws, ss> const& val)
+      : Value { toExpr(val) } {}
+
+  template <uint32_t ws, bool ss>
+    requires std::same_as<ap_repr<ws, ss>, SmallInt<ws, ss>>
+  constexpr Value(SmallInt<ws, ss> const& val)
       : Value { toExpr(val) } {}
 
   constexpr val_t compute() const { return value; }
+  constexpr val_t const& stored() const { return value; }
 
   template<std::integral IT>
   constexpr explicit operator IT() const {
@@ -65,6 +92,184 @@ constexpr IT getAs(ExprType auto const& expression) {
           .compute());
 }
 
+/// Writable view of the bits [lowBit, highBit] of a value, as returned by
+/// sliceRef() and bitRef(), which reads as an unsigned expression of the
+/// slice width. Assigned expressions are adapted to that width, and only
+/// the limbs of the value overlapping the range are read and written,
+/// using masks known at compile time.
+///
+/// The view refers to the value, which should outlive it. Nodes built on
+/// the view hold a read-only slice of a copy of the value instead, so that
+/// expressions do not refer to the value.
+template <uint32_t highBit, uint32_t lowBit, typename ValueType>
+class SliceRef {
+ public:
+  static_assert(highBit >= lowBit,
+                "Slicing high index should be greater than low index");
+  static_assert(ValueType::width > highBit,
+                "Trying to slice out of input bounds");
+  static constexpr uint32_t width = highBit - lowBit + 1;
+  static constexpr bool signedness = false;
+
+ private:
+  static constexpr uint32_t valueWidth = ValueType::width;
+  static constexpr bool valueSignedness = ValueType::signedness;
+  using res_t = ap_repr<width, false>;
+  using src_t = detail::limbs_t<detail::limbCount(width)>;
+  static constexpr std::size_t firstLimb = lowBit / 64;
+  static constexpr std::size_t spannedLimbs = highBit / 64 - firstLimb + 1;
+  static constexpr uint32_t offset = lowBit % 64;
+  static constexpr bool inPlace =
+      detail::limbAddressable<valueWidth, valueSignedness>;
+
+  ValueType* target;
+
+  /// Bits of the range in the i-th limb it spans
+  static constexpr uint64_t limbMask(std::size_t i) {
+    constexpr uint64_t allOnes = ~uint64_t { 0 };
+    uint64_t mask = (i == 0) ? allOnes << offset : allOnes;
+    if (i == spannedLimbs - 1)
+      mask &= ~((allOnes << (highBit % 64)) << 1);
+    return mask;
+  }
+
+  /// Bits of src to store in the i-th limb spanned by the range
+  static constexpr uint64_t alignedLimb(src_t const& src, std::size_t i) {
+    uint64_t res = (i < src.size()) ? src[i] << offset : 0;
+    if (offset != 0 && i > 0)
+      res |= src[i - 1] >> (64 - offset);
+    return res;
+  }
+
+  /// Bits of the range starting at the i-th limb it spans, given the
+  /// spanned limbs
+  template <typename Load>
+  static constexpr uint64_t extractedLimb(Load const& load, std::size_t i) {
+    uint64_t res = load(i) >> offset;
+    if (offset != 0 && i + 1 < spannedLimbs)
+      res |= load(i + 1) << (64 - offset);
+    return res;
+  }
+
+  template <typename Load> static constexpr res_t extract(Load const& load) {
+    src_t res;
+    detail::limbFor<detail::limbCount(width)>(
+        [&](std::size_t i) { res[i] = extractedLimb(load, i); });
+    if constexpr (width % 64 != 0)
+      res.back() &= (uint64_t { 1 } << (width % 64)) - 1;
+    return detail::fromLimbs<width>(res);
+  }
+
+  template <typename Load, typename Store>
+  static constexpr void insert(src_t const& src, Load const& load,
+                               Store const& store) {
+    detail::limbFor<spannedLimbs>([&](std::size_t i) {
+      uint64_t const mask = limbMask(i);
+      store(i, (load(i) & ~mask) | (alignedLimb(src, i) & mask));
+    });
+  }
+
+ public:
+  constexpr SliceRef(ValueType& target)
+      : target { &target } {}
+  constexpr SliceRef(SliceRef const&) = default;
+
+  constexpr res_t compute() const {
+    auto const& repr = target->value;
+    if constexpr (inPlace) {
+      if (!std::is_constant_evaluated()) {
+        return extract([&](std::size_t i) {
+          return detail::loadLimb<valueWidth, valueSignedness>(
+              repr, firstLimb + i);
+        });
+      }
+    }
+    return SliceExpr<highBit, lowBit, ValueType> { *target }.compute();
+  }
+
+  constexpr SliceRef& operator=(Value<width, false> const& src) {
+    auto const srcLimbs = detail::toLimbs<width>(src.compute());
+    auto& repr = target->value;
+    if constexpr (inPlace) {
+      if (!std::is_constant_evaluated()) {
+        insert(
+            srcLimbs,
+            [&](std::size_t i) {
+              return detail::loadLimb<valueWidth, valueSignedness>(
+                  repr, firstLimb + i);
+            },
+            [&](std::size_t i, uint64_t limb) {
+              detail::storeLimb<valueWidth, valueSignedness>(
+                  repr, firstLimb + i, limb);
+            });
+        constexpr uint32_t topBits = valueWidth % 64;
+        if constexpr (valueSignedness && topBits != 0 &&
+                      firstLimb + spannedLimbs ==
+                          detail::limbCount(valueWidth)) {
+          // Keep the bits above the width a copy of the sign bit
+          constexpr std::size_t top = detail::limbCount(valueWidth) - 1;
+          uint64_t const limb =
+              detail::loadLimb<valueWidth, valueSignedness>(repr, top);
+          detail::storeLimb<valueWidth, valueSignedness>(
+              repr, top,
+              static_cast<uint64_t>(
+                  static_cast<int64_t>(limb << (64 - topBits)) >>
+                  (64 - topBits)));
+        }
+        return *this;
+      }
+    }
+    auto limbs = detail::toLimbs<valueWidth>(
+        static_cast<ap_repr<valueWidth, false>>(repr));
+    insert(
+        srcLimbs, [&](std::size_t i) { return limbs[firstLimb + i]; },
+        [&](std::size_t i, uint64_t limb) { limbs[firstLimb + i] = limb; });
+    repr = static_cast<ap_repr<valueWidth, valueSignedness>>(
+        detail::fromLimbs<valueWidth>(limbs));
+    return *this;
+  }
+
+  template <std::same_as<bool> B> constexpr SliceRef& operator=(B bitVal) {
+    return *this = Value<width, false> { static_cast<res_t>(bitVal) };
+  }
+
+  constexpr SliceRef& operator=(SliceRef const& other) {
+    return *this = Value<width, false> { other };
+  }
+
+  constexpr ValueType const& value() const { return *target; }
+
+  /// Traversals see the view as a read-only slice of the value
+  constexpr auto operands() const { return std::tie(std::as_const(*target)); }
+  template <typename F> constexpr auto mapOperands(F&& f) const {
+    using mapped_t = std::decay_t<decltype(f(std::as_const(*target)))>;
+    return SliceExpr<highBit, lowBit, mapped_t> { f(std::as_const(*target)) };
+  }
+};
+
+template <uint32_t bitIdx, typename ValueType>
+using BitRef = SliceRef<bitIdx, bitIdx, ValueType>;
+
+template <uint32_t highBit, uint32_t lowBit, typename ValueType>
+constexpr auto toOperand(SliceRef<highBit, lowBit, ValueType> const& view) {
+  return SliceExpr<highBit, lowBit, ValueType> { view.value() };
+}
+
+/// Writable slice of a value. Unlike slice(), which reads a copy of its
+/// source, the view refers to the value.
+template <uint32_t highBit, uint32_t lowBit, uint32_t w, bool s,
+          typename... Policies>
+constexpr auto sliceRef(Value<w, s, Policies...>& value) {
+  return SliceRef<highBit, lowBit, Value<w, s, Policies...>> { value };
+}
+
+/// Writable bit of a value, assigned with the least significant bit of the
+/// assigned expression
+template <uint32_t bitIdx, uint32_t w, bool s, typename... Policies>
+constexpr auto bitRef(Value<w, s, Policies...>& value) {
+  return BitRef<bitIdx, Value<w, s, Policies...>> { value };
+}
+
 } //  namespace apintext
 
 #endif // VALUE_HPP
@@ -0,0 +1,250 @@
+#ifndef VERIFICATION_HPP
+#define VERIFICATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aliases.hpp"
+#include "batch.hpp"
+#include "expression.hpp"
+#include "limbs.hpp"
+#include "parallel.hpp"
+#include "value.hpp"
+
+namespace apintext {
+
+struct VerificationOptions {
+  /// Inputs are enumerated exhaustively when the placeholders of the checked
+  /// expression have at most this many bits in total (at most 63)
+  uint32_t exhaustiveInputBits = 32;
+  /// Number of random input combinations checked otherwise
+  uint64_t sampleCount = uint64_t { 1 } << 24;
+  uint64_t seed = 0;
+};
+
+/// Precondition accepting every input combination
+struct AcceptAll {
+  template <typename... Args> constexpr bool operator()(Args const&...) const {
+    return true;
+  }
+};
+
+/// Argument given to reference models and preconditions for an input of
+/// format (w, s): a 64-bit integer when it fits, a Value otherwise.
+template <uint32_t w, bool s>
+using reference_arg_t =
+    std::conditional_t<(w <= 64), std::conditional_t<s, int64_t, uint64_t>,
+                       Value<w, s>>;
+
+namespace detail {
+template <ExprType ET, typename Seq> struct ReferenceArgs;
+
+template <ExprType ET, std::size_t... I>
+struct ReferenceArgs<ET, std::index_sequence<I...>> {
+  using type = std::tuple<reference_arg_t<placeholder_t<ET, I>::width,
+                                          placeholder_t<ET, I>::signedness>...>;
+};
+} // namespace detail
+
+template <ExprType ET> struct VerificationReport {
+  using inputs_t = typename detail::ReferenceArgs<
+      ET, std::make_index_sequence<placeholderCount<ET>>>::type;
+
+  bool exhaustive = false;
+  /// Input combinations that satisfied the precondition
+  uint64_t checked = 0;
+  uint64_t failures = 0;
+  /// Failing inputs with the smallest enumeration or sample index
+  std::optional<inputs_t> firstFailure;
+
+  explicit operator bool() const { return failures == 0; }
+};
+
+namespace detail {
+/// splitmix64 finaliser
+constexpr uint64_t mix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+  return x ^ (x >> 31);
+}
+
+template <ExprType ET, typename Seq> class DifferentialChecker;
+
+template <ExprType ET, std::size_t... I>
+class DifferentialChecker<ET, std::index_sequence<I...>> {
+  static_assert(
+      (!std::is_void_v<placeholder_t<ET, I>> && ...),
+      "Placeholder indices of checked expressions should be contiguous");
+
+  template <std::size_t k> using input_t = placeholder_t<ET, k>;
+  template <std::size_t k>
+  using input_repr_t = ap_repr<input_t<k>::width, input_t<k>::signedness>;
+  using report_t = VerificationReport<ET>;
+
+  static constexpr std::array<uint32_t, sizeof...(I)> widths {
+    input_t<I>::width...
+  };
+
+  static constexpr uint32_t bitOffset(std::size_t k) {
+    uint32_t offset = 0;
+    for (std::size_t j = 0; j < k; ++j)
+      offset += widths[j];
+    return offset;
+  }
+
+  static constexpr uint32_t limbOffset(std::size_t k) {
+    uint32_t offset = 0;
+    for (std::size_t j = 0; j < k; ++j)
+      offset += limbCount(widths[j]);
+    return offset;
+  }
+
+  /// Chunk of input combinations built and evaluated at once
+  static constexpr uint64_t blockSize = 4096;
+
+ public:
+  static constexpr uint32_t totalInputBits = bitOffset(sizeof...(I));
+
+ private:
+  /// Input k of the combination of index n: bits of n in exhaustive mode,
+  /// hashed from the seed and n otherwise
+  template <std::size_t k>
+  static input_repr_t<k> inputRepr(uint64_t n, bool exhaustive, uint64_t seed) {
+    constexpr uint32_t w = input_t<k>::width;
+    limbs_t<limbCount(w)> limbs {};
+    if (exhaustive) {
+      limbs[0] = n >> bitOffset(k);
+    } else {
+      constexpr uint64_t totalLimbs = limbOffset(sizeof...(I));
+      for (std::size_t j = 0; j < limbs.size(); ++j)
+        limbs[j] = mix64(seed ^ mix64(n * totalLimbs + limbOffset(k) + j));
+    }
+    return static_cast<input_repr_t<k>>(fromLimbs<w>(limbs));
+  }
+
+  template <std::size_t k>
+  static reference_arg_t<input_t<k>::width, input_t<k>::signedness>
+  referenceArg(input_repr_t<k> const& repr) {
+    using arg_t = reference_arg_t<input_t<k>::width, input_t<k>::signedness>;
+    if constexpr (std::is_integral_v<arg_t>) {
+      return getAs<arg_t>(input_t<k> { repr });
+    } else {
+      return arg_t { repr };
+    }
+  }
+
+ public:
+  template <typename Config, typename Reference, typename Precondition>
+  static report_t run(ThreadPool& pool, ET const& shape,
+                      Reference const& reference,
+                      Precondition const& precondition,
+                      VerificationOptions const& options) {
+    report_t report;
+    report.exhaustive =
+        totalInputBits <= std::min<uint32_t>(options.exhaustiveInputBits, 63);
+    uint64_t total = options.sampleCount;
+    // Shifting by 64 or more bits is invalid even in the untaken branch
+    if constexpr (totalInputBits < 64) {
+      if (report.exhaustive)
+        total = uint64_t { 1 } << totalInputBits;
+    }
+    std::atomic<uint64_t> checked { 0 }, failures { 0 };
+    std::mutex firstFailureMutex;
+    uint64_t firstFailureIndex = total;
+
+    pool.forEachChunk((total + blockSize - 1) / blockSize, [&](uint64_t chunk) {
+      uint64_t const begin = chunk * blockSize;
+      uint64_t const end = std::min(begin + blockSize, total);
+      std::tuple<std::vector<input_repr_t<I>>...> inputs;
+      (std::get<I>(inputs).reserve(blockSize), ...);
+      std::vector<uint64_t> indices;
+      indices.reserve(blockSize);
+      for (uint64_t n = begin; n < end; ++n) {
+        std::tuple<input_repr_t<I>...> const reprs {
+          inputRepr<I>(n, report.exhaustive, options.seed)...
+        };
+        if (!precondition(referenceArg<I>(std::get<I>(reprs))...))
+          continue;
+        (std::get<I>(inputs).push_back(std::get<I>(reprs)), ...);
+        indices.push_back(n);
+      }
+
+      std::vector<res_t<ET>> results(indices.size());
+      evaluateRange<Config>(
+          shape,
+          std::tuple { std::span { std::get<I>(inputs) }...,
+                       std::span { results } },
+          0, results.size(), std::index_sequence<I...> {});
+
+      uint64_t localFailures = 0;
+      for (std::size_t j = 0; j < results.size(); ++j) {
+        auto const expected =
+            Value<ET::width, ET::signedness> {
+              reference(referenceArg<I>(std::get<I>(inputs)[j])...)
+            }.compute();
+        if (expected == results[j])
+          continue;
+        if (localFailures++ == 0) {
+          std::lock_guard lock { firstFailureMutex };
+          if (indices[j] < firstFailureIndex) {
+            firstFailureIndex = indices[j];
+            report.firstFailure.emplace(
+                referenceArg<I>(std::get<I>(inputs)[j])...);
+          }
+        }
+      }
+      checked += results.size();
+      failures += localFailures;
+    });
+
+    report.checked = checked;
+    report.failures = failures;
+    return report;
+  }
+};
+} // namespace detail
+
+/// Compare shape, whose inputs are placeholders of indices 0, 1, ..., with
+/// a reference model, for all the input combinations if they have few
+/// enough bits, for random samples otherwise.
+///
+/// reference and precondition are called with one reference_arg_t per
+/// placeholder; combinations rejected by precondition (e.g. null divisors)
+/// are skipped. The reference result is converted to the format of shape
+/// as a Value would be.
+template <typename Config = BatchConfig<>, ExprType ET, typename Reference,
+          typename Precondition = AcceptAll>
+VerificationReport<ET>
+differentialCheck(ThreadPool& pool, ET const& shape, Reference const& reference,
+                  Precondition const& precondition = {},
+                  VerificationOptions const& options = {}) {
+  using checker_t = detail::DifferentialChecker<
+      ET, std::make_index_sequence<placeholderCount<ET>>>;
+  return checker_t::template run<Config>(pool, shape, reference, precondition,
+                                         options);
+}
+
+template <typename Config = BatchConfig<>, ExprType ET, typename Reference,
+          typename Precondition = AcceptAll>
+VerificationReport<ET>
+differentialCheck(ET const& shape, Reference const& reference,
+                  Precondition const& precondition = {},
+                  VerificationOptions const& options = {}) {
+  return differentialCheck<Config>(ThreadPool::global(), shape, reference,
+                                   precondition, options);
+}
+
+} // namespace apintext
+
+#endif // VERIFICATION_HPP
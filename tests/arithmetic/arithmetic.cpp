@@ -2,7 +2,7 @@
 #define BOOST_TEST_MODULE SimpleArithmetic
 
 #include <cstdint>
-#include <type_traits>
+#include <tuple>
 
 #include <boost/test/unit_test.hpp>
 
@@ -16,24 +16,23 @@ using namespace apintext;
 
 struct Dummy {};
 
-template <uint32_t targetWidth, bool targetSignedness>
-constexpr typename std::conditional<targetSignedness, int32_t, uint32_t>::type
-getValueForFormat(uint32_t val) {
-  constexpr uint32_t mask = (1 << targetWidth) - 1;
-  uint32_t masked = val & mask;
-  if constexpr (!targetSignedness) {
-    return masked;
-  } else {
-    constexpr uint32_t s_mask = 1 << (targetWidth - 1);
-    int32_t pos_bits = masked & (mask >> 1);
-    return (masked & s_mask) ? pos_bits - s_mask : pos_bits;
+/// Report the first failure of a differential check of an operator
+template <typename Report>
+bool reportCheck(Report const& report, char const* op, uint32_t wA, bool sA,
+                 uint32_t wB, bool sB) {
+  if (!report && report.firstFailure) {
+    cerr << "Error in " << wA << " (" << sA << ") " << op << " " << wB << " ("
+         << sB << "): " << report.failures << " failures, first on "
+         << get<0>(*report.firstFailure) << " " << op << " "
+         << get<1>(*report.firstFailure) << "\n";
   }
+  return static_cast<bool>(report);
 }
 
 template <uint32_t a, uint32_t b, uint32_t res> constexpr void check_sum_8() {
   constexpr Value<8, false> x { a };
   constexpr Value<8, false> y { b };
-  constexpr unsigned _ExtInt(8) expected_res { res };
+  constexpr ap_repr<8, false> expected_res { res };
   constexpr Value<8, false> sum = a + b;
   static_assert(sum.compute() == expected_res, "Unexpected sum result");
 }
@@ -46,29 +45,11 @@ BOOST_AUTO_TEST_CASE(StaticSum) {
 
 template <uint32_t wA, uint32_t wB, bool sA, bool sB>
 bool sum_extensive_check() {
-  constexpr uint32_t aUpperBound = 1 << wA;
-  constexpr uint32_t bUpperBound = 1 << wB;
-  using arithprop = ArithmeticProp<wA, wB, sA, sB>;
-  using sumtype = ap_repr<arithprop::sumWidth, arithprop::sumSigned>;
-  for (uint32_t aRepr = 0; aRepr < aUpperBound; ++aRepr) {
-    auto aVal = getValueForFormat<wA, sA>(aRepr);
-    Value<wA, sA> aValue { aVal };
-    for (uint32_t bRepr = 0; bRepr < bUpperBound; ++bRepr) {
-      auto bVal = getValueForFormat<wB, sB>(bRepr);
-      auto sum = aVal + bVal;
-      Value<wB, sB> bValue { bVal };
-      sumtype extintsum { static_cast<sumtype>(sum) };
-      auto exprsum = aValue + bValue;
-      if (extintsum != exprsum.compute()) {
-        cerr << "Error in " << wA << " (" << sA << ") + " << wB << " (" << sB
-             << ") product\n";
-        cerr << "Op A - iter: " << aRepr << ", value: " << aVal << "\n";
-        cerr << "Op B - iter: " << bRepr << ", value: " << bVal << "\n";
-        return false;
-      }
-    }
-  }
-  return true;
+  Placeholder<0, wA, sA> a;
+  Placeholder<1, wB, sB> b;
+  auto report = differentialCheck(
+      a + b, [](auto aVal, auto bVal) { return aVal + bVal; });
+  return reportCheck(report, "+", wA, sA, wB, sB);
 }
 
 BOOST_AUTO_TEST_CASE(DynamicSums) {
@@ -103,12 +84,14 @@ BOOST_AUTO_TEST_CASE(DynamicSums) {
   BOOST_REQUIRE(res);
   res = sum_extensive_check<5, 8, false, true>();
   BOOST_REQUIRE(res);
+  res = sum_extensive_check<10, 10, true, false>();
+  BOOST_REQUIRE(res);
 }
 
 template <uint32_t a, uint32_t b, uint32_t res> constexpr void check_sub_8() {
   constexpr Value<8, false> x { a };
   constexpr Value<8, false> y { b };
-  constexpr unsigned _ExtInt(8) expected_res { res };
+  constexpr ap_repr<8, false> expected_res { res };
   constexpr Value<8, false> sum = a - b;
   static_assert(sum.compute() == expected_res, "Unexpected sum result");
 }
@@ -122,29 +105,11 @@ BOOST_AUTO_TEST_CASE(StaticSub) {
 
 template <uint32_t wA, uint32_t wB, bool sA, bool sB>
 bool sub_extensive_check() {
-  constexpr uint32_t aUpperBound = 1 << wA;
-  constexpr uint32_t bUpperBound = 1 << wB;
-  using arithprop = ArithmeticProp<wA, wB, sA, sB>;
-  using sumtype = ap_repr<arithprop::sumWidth, arithprop::sumSigned>;
-  for (uint32_t aRepr = 0; aRepr < aUpperBound; ++aRepr) {
-    auto aVal = getValueForFormat<wA, sA>(aRepr);
-    Value<wA, sA> aValue { aVal };
-    for (uint32_t bRepr = 0; bRepr < bUpperBound; ++bRepr) {
-      auto bVal = getValueForFormat<wB, sB>(bRepr);
-      auto sum = aVal - bVal;
-      Value<wB, sB> bValue { bVal };
-      sumtype extintsum { static_cast<sumtype>(sum) };
-      auto exprsum = aValue - bValue;
-      if (extintsum != exprsum.compute()) {
-        cerr << "Error in " << wA << " (" << sA << ") - " << wB << " (" << sB
-             << ") product\n";
-        cerr << "Op A - iter: " << aRepr << ", value: " << aVal << "\n";
-        cerr << "Op B - iter: " << bRepr << ", value: " << bVal << "\n";
-        return false;
-      }
-    }
-  }
-  return true;
+  Placeholder<0, wA, sA> a;
+  Placeholder<1, wB, sB> b;
+  auto report = differentialCheck(
+      a - b, [](auto aVal, auto bVal) { return aVal - bVal; });
+  return reportCheck(report, "-", wA, sA, wB, sB);
 }
 
 BOOST_AUTO_TEST_CASE(DynamicSubs) {
@@ -184,7 +149,7 @@ BOOST_AUTO_TEST_CASE(DynamicSubs) {
 template <uint32_t a, uint32_t b, uint32_t res> constexpr void check_prod_8() {
   constexpr Value<8, false> x { a };
   constexpr Value<8, false> y { b };
-  constexpr unsigned _ExtInt(8) expected_res { res };
+  constexpr ap_repr<8, false> expected_res { res };
   constexpr Value<8, false> prod = a * b;
   static_assert(prod.compute() == expected_res, "Unexpected product result");
 }
@@ -204,29 +169,11 @@ BOOST_AUTO_TEST_CASE(StaticProducts) {
 
 template <uint32_t wA, uint32_t wB, bool sA, bool sB>
 bool prod_extensive_check() {
-  constexpr uint32_t aUpperBound = 1 << wA;
-  constexpr uint32_t bUpperBound = 1 << wB;
-  using arithprop = ArithmeticProp<wA, wB, sA, sB>;
-  using prodtype = ap_repr<arithprop::prodWidth, arithprop::prodSigned>;
-  for (uint32_t aRepr = 0; aRepr < aUpperBound; ++aRepr) {
-    auto aVal = getValueForFormat<wA, sA>(aRepr);
-    Value<wA, sA> aValue { aVal };
-    for (uint32_t bRepr = 0; bRepr < bUpperBound; ++bRepr) {
-      auto bVal = getValueForFormat<wB, sB>(bRepr);
-      auto prod = aVal * bVal;
-      Value<wB, sB> bValue { bVal };
-      prodtype extintprod { static_cast<prodtype>(prod) };
-      auto exprprod = aValue * bValue;
-      if (extintprod != exprprod.compute()) {
-        cerr << "Error in " << wA << " (" << sA << ") x " << wB << " (" << sB
-             << ") product\n";
-        cerr << "Op A - iter: " << aRepr << ", value: " << aVal << "\n";
-        cerr << "Op B - iter: " << bRepr << ", value: " << bVal << "\n";
-        return false;
-      }
-    }
-  }
-  return true;
+  Placeholder<0, wA, sA> a;
+  Placeholder<1, wB, sB> b;
+  auto report = differentialCheck(
+      a * b, [](auto aVal, auto bVal) { return aVal * bVal; });
+  return reportCheck(report, "*", wA, sA, wB, sB);
 }
 
 BOOST_AUTO_TEST_CASE(DynamicProducts) {
@@ -261,6 +208,81 @@ BOOST_AUTO_TEST_CASE(DynamicProducts) {
   BOOST_REQUIRE(res);
   res = prod_extensive_check<5, 8, false, true>();
   BOOST_REQUIRE(res);
+  res = prod_extensive_check<10, 10, true, true>();
+  BOOST_REQUIRE(res);
+}
+
+BOOST_AUTO_TEST_CASE(SampledProducts) {
+  Placeholder<0, 30, true> a;
+  Placeholder<1, 31, false> b;
+  VerificationOptions options;
+  options.sampleCount = 1 << 16;
+  auto report = differentialCheck(
+      a * b - b, [](int64_t aVal, uint64_t bVal) {
+        return aVal * int64_t(bVal) - int64_t(bVal);
+      },
+      AcceptAll {}, options);
+  BOOST_REQUIRE(!report.exhaustive);
+  BOOST_REQUIRE_EQUAL(report.checked, options.sampleCount);
+  BOOST_REQUIRE(report);
+}
+
+BOOST_AUTO_TEST_CASE(StaticSquares) {
+  constexpr Value<8, true> x { -128 };
+  constexpr auto sq = square(x);
+  static_assert(decltype(sq)::width == 15 && !decltype(sq)::signedness,
+                "Error in square format");
+  static_assert(sq.compute() == ap_repr<15, false> { 16384 },
+                "Unexpected square result");
+  static_assert(decltype(square(Value<8, false> {}))::width == 16,
+                "Error in square format");
+  static_assert(decltype(square(Value<1, true> {}))::width == 1,
+                "Error in square format");
+  constexpr Value<16, true> xx = x * x;
+  static_assert(xx.compute() == ap_repr<16, true> { 16384 },
+                "Unexpected product of a value by itself");
+  // Only products of a stored expression by itself keep a square flag
+  using sum_t = decltype(x + x);
+  static_assert(sizeof(decltype(x * x)) > 2 * sizeof(x),
+                "Missing square flag");
+  static_assert(sizeof(ExprProd<sum_t, sum_t>) == 2 * sizeof(sum_t),
+                "Unexpected square flag");
+}
+
+template <uint32_t w, bool s> bool square_extensive_check() {
+  Placeholder<0, w, s> a;
+  auto reference = [](auto aVal) { return aVal * aVal; };
+  return differentialCheck(square(a), reference) &&
+         differentialCheck(a * a, reference);
+}
+
+BOOST_AUTO_TEST_CASE(DynamicSquares) {
+  BOOST_REQUIRE((square_extensive_check<1, false>()));
+  BOOST_REQUIRE((square_extensive_check<1, true>()));
+  BOOST_REQUIRE((square_extensive_check<7, true>()));
+  BOOST_REQUIRE((square_extensive_check<16, false>()));
+  BOOST_REQUIRE((square_extensive_check<16, true>()));
+}
+
+/// Wide squares, of a value by itself in the reference, should match the
+/// square node and the generic product of placeholders
+template <uint32_t w, bool s> bool wide_square_check() {
+  Placeholder<0, w, s> a;
+  VerificationOptions options;
+  options.sampleCount = 1 << 12;
+  auto reference = [](Value<w, s> const& aVal) {
+    return Value<2 * w, s> { aVal * aVal };
+  };
+  return differentialCheck(square(a), reference, AcceptAll {}, options) &&
+         differentialCheck(a * a, reference, AcceptAll {}, options);
+}
+
+BOOST_AUTO_TEST_CASE(SampledSquares) {
+  BOOST_REQUIRE((wide_square_check<65, true>()));
+  BOOST_REQUIRE((wide_square_check<128, false>()));
+  BOOST_REQUIRE((wide_square_check<200, true>()));
+  BOOST_REQUIRE((wide_square_check<512, false>()));
+  BOOST_REQUIRE((wide_square_check<777, true>()));
 }
 
 BOOST_AUTO_TEST_CASE(StaticGetBit) {
@@ -309,28 +331,16 @@ BOOST_AUTO_TEST_CASE(StaticComparison) {
 template <uint32_t dividendWidth, bool dividendSignedness,
           uint32_t divisorWidth, bool divisorSignedness>
 bool testAllMod() {
-  uint32_t ofDividend = 1 << dividendWidth;
-  uint32_t ofDivisor = 1 << divisorWidth;
-  for (uint32_t dividendRepr = 0; dividendRepr < ofDividend; ++dividendRepr) {
-    int32_t dividendIntVal =
-        getValueForFormat<dividendWidth, dividendSignedness>(dividendRepr);
-    Value<dividendWidth, dividendSignedness> dividend { dividendRepr };
-    for (uint32_t divisorRepr = 1; divisorRepr < ofDivisor; ++divisorRepr) {
-      int32_t divisorIntVal =
-          getValueForFormat<divisorWidth, divisorSignedness>(divisorRepr);
-      Value<divisorWidth, divisorSignedness> divisor { divisorRepr };
-      auto modulus = dividend % divisor;
-      auto modulusVal = getAs<int>(modulus);
-      if (modulusVal != (dividendIntVal % divisorIntVal)) {
-        cerr << dividendIntVal << " (" << dividendRepr << ") % "
-             << divisorIntVal << " (" << divisorRepr << ") :  got "
-             << modulusVal << " while expecting "
-             << (dividendIntVal % divisorIntVal) << "\n";
-        return false;
-      }
-    }
-  }
-  return true;
+  Placeholder<0, dividendWidth, dividendSignedness> dividend;
+  Placeholder<1, divisorWidth, divisorSignedness> divisor;
+  auto report = differentialCheck(
+      dividend % divisor,
+      [](auto dividendVal, auto divisorVal) {
+        return int64_t(dividendVal) % int64_t(divisorVal);
+      },
+      [](auto, auto divisorVal) { return divisorVal != 0; });
+  return reportCheck(report, "%", dividendWidth, dividendSignedness,
+                     divisorWidth, divisorSignedness);
 }
 
 BOOST_AUTO_TEST_CASE(DynamicModulo) {
@@ -383,30 +393,16 @@ BOOST_AUTO_TEST_CASE(DynamicModulo) {
 template <uint32_t dividendWidth, bool dividendSignedness,
           uint32_t divisorWidth, bool divisorSignedness>
 bool testAllDiv() {
-  uint32_t ofDividend = 1 << dividendWidth;
-  uint32_t ofDivisor = 1 << divisorWidth;
-  for (uint32_t dividendRepr = 0; dividendRepr < ofDividend; ++dividendRepr) {
-    int32_t dividendIntVal =
-        getValueForFormat<dividendWidth, dividendSignedness>(dividendRepr);
-    Value<dividendWidth, dividendSignedness> dividend { dividendRepr };
-    for (uint32_t divisorRepr = 1; divisorRepr < ofDivisor; ++divisorRepr) {
-      int32_t divisorIntVal =
-          getValueForFormat<divisorWidth, divisorSignedness>(divisorRepr);
-      Value<divisorWidth, divisorSignedness> divisor { divisorRepr };
-      auto div = dividend / divisor;
-      auto divVal = getAs<int>(div);
-      if (divVal != (dividendIntVal / divisorIntVal)) {
-        cerr << dividendWidth << ", " << dividendSignedness << ", " << divisorWidth << ", " << divisorSignedness << "\n";
-        cerr << decltype(div)::width << ", " << decltype(div)::signedness << "\n";
-        cerr << dividendIntVal << " (" << dividendRepr << ") / "
-             << divisorIntVal << " (" << divisorRepr << ") :  got "
-             << divVal << " while expecting "
-             << (dividendIntVal / divisorIntVal) << endl;
-        return false;
-      }
-    }
-  }
-  return true;
+  Placeholder<0, dividendWidth, dividendSignedness> dividend;
+  Placeholder<1, divisorWidth, divisorSignedness> divisor;
+  auto report = differentialCheck(
+      dividend / divisor,
+      [](auto dividendVal, auto divisorVal) {
+        return int64_t(dividendVal) / int64_t(divisorVal);
+      },
+      [](auto, auto divisorVal) { return divisorVal != 0; });
+  return reportCheck(report, "/", dividendWidth, dividendSignedness,
+                     divisorWidth, divisorSignedness);
 }
 
 BOOST_AUTO_TEST_CASE(DynamicDivision) {
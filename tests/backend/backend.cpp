@@ -0,0 +1,129 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Backend
+
+#include <array>
+#include <cstdint>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext/aliases.hpp"
+#include "apintext/limb_kernels.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+#ifdef APINTEXT_NATIVE_INT
+using Reference = NativeBackend;
+#else
+/// Without native integers, the word-sized representations of the limb
+/// backend are checked against the limb arrays
+struct Reference {
+  template <uint32_t w, bool s> using repr = LimbInt<w, s>;
+};
+#endif
+
+template <uint32_t w> using limbs = detail::limbs_t<detail::limbCount(w)>;
+
+template <uint32_t w, bool s, typename B>
+ap_repr<w, s, B> build(limbs<w> const& src) {
+  using unsigned_t = ap_repr<w, false, B>;
+  unsigned_t res { 0 };
+  for (size_t i = src.size(); i-- > 0;) {
+    if constexpr (w > 64)
+      res = res << 64;
+    res = res | static_cast<unsigned_t>(src[i]);
+  }
+  return static_cast<ap_repr<w, s, B>>(res);
+}
+
+/// Bits of the value, without sign extension
+template <uint32_t w, bool s, typename B>
+limbs<w> bitsOf(ap_repr<w, s, B> const& value) {
+  auto bits = static_cast<ap_repr<w, false, B>>(value);
+  limbs<w> res;
+  for (auto& limb : res) {
+    limb = static_cast<uint64_t>(bits);
+    if constexpr (w > 64)
+      bits = bits >> 64;
+  }
+  return res;
+}
+
+/// The limb backend should compute the same bits as the reference
+template <uint32_t w, bool s> void compareBackends() {
+  using ref_t = ap_repr<w, s, Reference>;
+  using limb_t = ap_repr<w, s, LimbBackend>;
+  limbs<w> one {};
+  one[0] = 1;
+  auto const minValue = static_cast<ref_t>(
+      build<w, false, Reference>(one) << (w - 1));
+  for (int i = 0; i < 500; ++i) {
+    auto const la = randomLimbs<w>();
+    auto const lb = randomLimbs<w>();
+    ref_t const na = build<w, s, Reference>(la);
+    ref_t const nb = build<w, s, Reference>(lb);
+    limb_t const a = build<w, s, LimbBackend>(la);
+    limb_t const b = build<w, s, LimbBackend>(lb);
+    auto check = [](ref_t const& expected, limb_t const& res) {
+      BOOST_REQUIRE((bitsOf<w, s, Reference>(expected) ==
+                     bitsOf<w, s, LimbBackend>(res)));
+    };
+    // Signed overflow is undefined for native integers
+    if constexpr (!s) {
+      check(na + nb, a + b);
+      check(na - nb, a - b);
+      check(na * nb, a * b);
+    }
+    bool const overflows = s && na == minValue && nb == ref_t(-1);
+    if (nb != ref_t(0) && !overflows) {
+      check(na / nb, a / b);
+      check(na % nb, a % b);
+    }
+    uint32_t const shift = next() % w;
+    check(na << shift, a << shift);
+    check(na >> shift, a >> shift);
+    check(na & nb, a & b);
+    check(na | nb, a | b);
+    check(na ^ nb, a ^ b);
+    check(~na, ~a);
+    BOOST_REQUIRE((na < nb) == (a < b));
+    BOOST_REQUIRE((na == nb) == (a == b));
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LimbBackendMatchesReference) {
+  compareBackends<13, false>();
+  compareBackends<13, true>();
+  compareBackends<64, false>();
+  compareBackends<64, true>();
+  compareBackends<65, true>();
+  compareBackends<128, false>();
+  compareBackends<128, true>();
+  compareBackends<200, true>();
+  compareBackends<512, false>();
+  compareBackends<777, true>();
+}
+
+BOOST_AUTO_TEST_CASE(Conversions) {
+  using small_t = ap_repr<100, true, LimbBackend>;
+  using wide_t = ap_repr<300, true, LimbBackend>;
+  using uwide_t = ap_repr<300, false, LimbBackend>;
+  static_assert(std::is_same_v<small_t, SmallInt<100, true>>);
+  static_assert(std::is_same_v<wide_t, LimbInt<300, true>>);
+  BOOST_REQUIRE(static_cast<wide_t>(small_t { -5 }) == wide_t { -5 });
+  BOOST_REQUIRE(static_cast<small_t>(wide_t { -5 }) == small_t { -5 });
+  auto const big = uwide_t { 3 } << 120;
+  BOOST_REQUIRE(static_cast<uint64_t>(static_cast<small_t>(big) >> 64) ==
+                uint64_t { 0 });
+  BOOST_REQUIRE(static_cast<small_t>(big >> 60) == small_t { 3 } << 60);
+  BOOST_REQUIRE((static_cast<uwide_t>(small_t { -1 }) >> 100 ==
+                 (uwide_t { 1 } << 200) - 1));
+  using word_t = ap_repr<64, false, LimbBackend>;
+  BOOST_REQUIRE(static_cast<word_t>(small_t { -2 }) ==
+                word_t { ~uint64_t { 1 } });
+}
@@ -0,0 +1,69 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BatchEvaluation
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+
+using namespace std;
+
+using namespace apintext;
+
+BOOST_AUTO_TEST_CASE(StaticSubstitution) {
+  constexpr Placeholder<0, 8, false> a;
+  constexpr Placeholder<1, 6, true> b;
+  constexpr auto shape = a * b + a;
+  static_assert(getAs<int>(substitute(shape, 3, -2)) == -3);
+  static_assert(getAs<int>(substitute(shape, Value<8, false> { 200 },
+                                      Value<6, true> { 31 })) == 6400);
+}
+
+BOOST_AUTO_TEST_CASE(ExhaustiveBatch) {
+  Placeholder<0, 8, false> a;
+  Placeholder<1, 6, true> b;
+  auto shape = (a * b + a) / (b - a);
+  using shape_t = decltype(shape);
+
+  vector<Value<8, false>> as;
+  vector<Value<6, true>> bs;
+  for (uint32_t aRepr = 0; aRepr < (1 << 8); ++aRepr) {
+    for (uint32_t bRepr = 0; bRepr < (1 << 6); ++bRepr) {
+      if (getAs<int>(Value<8, false> { aRepr }) ==
+          getAs<int>(Value<6, true> { bRepr }))
+        continue;
+      as.emplace_back(aRepr);
+      bs.emplace_back(bRepr);
+    }
+  }
+
+  vector<Value<shape_t::width, shape_t::signedness>> out(as.size());
+  evaluate(shape, as, bs, out);
+  for (size_t i = 0; i < out.size(); ++i) {
+    auto expected = (as[i] * bs[i] + as[i]) / (bs[i] - as[i]);
+    BOOST_REQUIRE(out[i].compute() == expected.compute());
+  }
+
+  // Unrolled and prefetched, with a remainder loop and a raw representation
+  // output
+  vector<res_t<shape_t>> rawOut(1001);
+  evaluate<BatchConfig<4, 16>>(shape, as, bs, rawOut);
+  for (size_t i = 0; i < rawOut.size(); ++i)
+    BOOST_REQUIRE(rawOut[i] == out[i].compute());
+}
+
+BOOST_AUTO_TEST_CASE(IntegerBatch) {
+  Placeholder<0, 32, true> x;
+  Placeholder<1, 32, true> y;
+  vector<int32_t> xs { 1, -5, 1 << 30, 7 };
+  vector<int32_t> ys { 2, 3, 1 << 30, -7 };
+  vector<int64_t> out(xs.size());
+  evaluate<BatchConfig<2>>(x * y - y, xs, ys, out);
+  for (size_t i = 0; i < out.size(); ++i)
+    BOOST_REQUIRE_EQUAL(out[i], int64_t { xs[i] } * ys[i] - ys[i]);
+
+  vector<int64_t> tooLarge(xs.size() + 1);
+  BOOST_REQUIRE_THROW(evaluate(x * y, xs, ys, tooLarge), std::invalid_argument);
+}
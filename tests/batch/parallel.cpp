@@ -0,0 +1,91 @@
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+BOOST_AUTO_TEST_CASE(StaticCost) {
+  using wide_t = Placeholder<0, 512, false>;
+  static_assert(exprCost<ExprDiv<wide_t, wide_t>> >
+                100 * exprCost<ExprSum<wide_t, wide_t>>);
+  static_assert(exprCost<ExprSum<wide_t, wide_t>> <
+                exprCost<ExprProd<wide_t, wide_t>>);
+  static_assert(exprCost<ExprSum<ExprSum<wide_t, wide_t>, wide_t>> >
+                exprCost<ExprSum<wide_t, wide_t>>);
+}
+
+BOOST_AUTO_TEST_CASE(WorkStealingCoversAllChunks) {
+  for (size_t threads : { 1, 3, 8 }) {
+    ThreadPool pool { threads };
+    for (uint64_t chunkCount : { 1, 2, 7, 1000 }) {
+      vector<atomic<int>> seen(chunkCount);
+      pool.forEachChunk(chunkCount, [&](uint64_t chunk) { ++seen[chunk]; });
+      for (auto const& count : seen)
+        BOOST_REQUIRE_EQUAL(count.load(), 1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TaskExceptionIsRethrown) {
+  ThreadPool pool { 4 };
+  BOOST_REQUIRE_THROW(pool.forEachChunk(100,
+                                        [](uint64_t chunk) {
+                                          if (chunk == 42)
+                                            throw std::runtime_error("fail");
+                                        }),
+                      std::runtime_error);
+  // The pool is still usable afterwards
+  atomic<uint64_t> sum { 0 };
+  pool.forEachChunk(10, [&](uint64_t chunk) { sum += chunk; });
+  BOOST_REQUIRE_EQUAL(sum.load(), 45);
+}
+
+template <typename Shape, typename In0, typename In1>
+void checkParallel(ThreadPool& pool, Shape const& shape, In0 const& in0,
+                   In1 const& in1) {
+  using out_t = Value<Shape::width, Shape::signedness>;
+  vector<out_t> expected(in0.size()), out(in0.size());
+  evaluate(shape, in0, in1, expected);
+  parallelEvaluate<BatchConfig<4>>(pool, shape, in0, in1, out);
+  for (size_t i = 0; i < out.size(); ++i)
+    BOOST_REQUIRE(out[i].compute() == expected[i].compute());
+}
+
+BOOST_AUTO_TEST_CASE(ParallelEvaluate) {
+  vector<Value<16, true>> narrow0, narrow1;
+  vector<Value<300, true>> wide0, wide1;
+  for (size_t i = 0; i < 20011; ++i) {
+    narrow0.emplace_back(next());
+    narrow1.emplace_back(next());
+    wide0.emplace_back(Value<64, false> { next() } *
+                       Value<64, false> { next() } *
+                       Value<64, false> { next() } *
+                       Value<64, false> { next() } *
+                       Value<64, false> { next() });
+    wide1.emplace_back(Value<64, false> { next() } *
+                       Value<64, false> { next() | 1 });
+  }
+
+  Placeholder<0, 16, true> a;
+  Placeholder<1, 16, true> b;
+  Placeholder<0, 300, true> x;
+  Placeholder<1, 300, true> y;
+  for (size_t threads : { 1, 4 }) {
+    ThreadPool pool { threads };
+    checkParallel(pool, a * b + a, narrow0, narrow1);
+    checkParallel(pool, x / y - x % y, wide0, wide1);
+  }
+  vector<Value<17, true>> out(narrow0.size());
+  parallelEvaluate(a + b, narrow0, narrow1, out);
+  for (size_t i = 0; i < out.size(); ++i)
+    BOOST_REQUIRE(out[i].compute() == (narrow0[i] + narrow1[i]).compute());
+}
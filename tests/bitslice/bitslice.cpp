@@ -0,0 +1,75 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BitSlice
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+BOOST_AUTO_TEST_CASE(Transpose) {
+  array<uint64_t, 64> rows;
+  for (auto& row : rows)
+    row = next();
+  auto transposed = rows;
+  detail::transpose64(transposed);
+  for (uint32_t i = 0; i < 64; ++i)
+    for (uint32_t j = 0; j < 64; ++j)
+      BOOST_REQUIRE_EQUAL((rows[i] >> j) & 1, (transposed[j] >> i) & 1);
+}
+
+/// Bit-sliced evaluation should match the element by element one
+template <typename Word> void checkBitSliced() {
+  Placeholder<0, 12, true> a;
+  Placeholder<1, 9, false> b;
+  Placeholder<2, 16, false> c;
+  // The slices make the signed operands of the bitwise operations unsigned
+  auto const shape =
+      slice<13, 0>(a + b - Value<5, true> { -7 }) ^
+      slice<13, 0>(signExtendToWidth<14>(a)) ^
+      (slice<13, 0>(~c) & zeroExtendToWidth<14>(b) |
+       zeroExtendToWidth<14>(Value<4, false> { 9 })) ^
+      slice<13, 0>(zeroExtendToWidth<14>(
+          xorReduce(c) + andReduce(slice<2, 0>(b)) - norReduce(a) +
+          getBit<15>(c) + orReduce(a)));
+  using shape_t = decltype(shape);
+
+  for (size_t count : { 1, 64, 1000 }) {
+    vector<Value<12, true>> as(count);
+    vector<uint32_t> bs(count);
+    vector<Value<16, false>> cs(count);
+    for (size_t i = 0; i < count; ++i) {
+      as[i] = Value<12, true> { static_cast<int16_t>(next()) };
+      bs[i] = next() % 512;
+      cs[i] = Value<16, false> { static_cast<uint16_t>(next()) };
+    }
+    vector<res_t<shape_t>> expected(count), sliced(count);
+    evaluate(shape, as, bs, cs, expected);
+    evaluate<BitSliced<Word>>(shape, as, bs, cs, sliced);
+    BOOST_REQUIRE(sliced == expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BitSlicedMatchesScalar) {
+  checkBitSliced<uint64_t>();
+  checkBitSliced<WideLanes>();
+}
+
+BOOST_AUTO_TEST_CASE(BitSlicedVerification) {
+  Placeholder<0, 8, true> a;
+  Placeholder<1, 8, false> b;
+  auto report = differentialCheck<BitSliced<>>(
+      a - b, [](int64_t aVal, uint64_t bVal) {
+        return aVal - static_cast<int64_t>(bVal);
+      });
+  BOOST_REQUIRE(report.exhaustive);
+  BOOST_REQUIRE(report);
+}
@@ -0,0 +1,161 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CharConv
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <system_error>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+/// Random hexadecimal string of at most digitCount digits
+string randomHex(size_t digitCount) {
+  string res;
+  size_t const length = 1 + next() % digitCount;
+  for (size_t i = 0; i < length; ++i)
+    res += "0123456789abcdef"[next() % 16];
+  size_t const firstNonZero = res.find_first_not_of('0');
+  return (firstNonZero == string::npos) ? "0" : res.substr(firstNonZero);
+}
+
+/// Decimal conversion by repeated doubling of a decimal string
+string hexToDecimal(string const& hex) {
+  string dec = "0";
+  for (char c : hex) {
+    int const digit = (c <= '9') ? c - '0' : c - 'a' + 10;
+    for (int bit = 3; bit >= 0; --bit) {
+      int carry = (digit >> bit) & 1;
+      for (size_t i = dec.size(); i-- > 0;) {
+        int const d = (dec[i] - '0') * 2 + carry;
+        dec[i] = static_cast<char>('0' + d % 10);
+        carry = d / 10;
+      }
+      if (carry)
+        dec.insert(dec.begin(), '1');
+    }
+  }
+  return dec;
+}
+} // namespace
+
+template <uint32_t w, bool s, typename IT> void checkAgainstStd(IT val) {
+  Value<w, s> const value { val };
+  IT const expected = getAs<IT>(value);
+  for (int base = 2; base <= 36; ++base) {
+    array<char, 80> ref, res;
+    auto const refEnd = std::to_chars(ref.begin(), ref.end(), expected, base);
+    auto const resEnd = apintext::to_chars(res.begin(), res.end(), value, base);
+    BOOST_REQUIRE(resEnd.ec == errc {});
+    BOOST_REQUIRE_EQUAL(string(res.begin(), resEnd.ptr),
+                        string(ref.begin(), refEnd.ptr));
+
+    Value<w, s> parsed;
+    auto const parseEnd = apintext::from_chars(res.data(), resEnd.ptr, parsed,
+                                               base);
+    BOOST_REQUIRE(parseEnd.ec == errc {});
+    BOOST_REQUIRE(parseEnd.ptr == resEnd.ptr);
+    BOOST_REQUIRE(parsed.compute() == value.compute());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NarrowMatchesStd) {
+  for (int64_t edge : { 0l, 1l, -1l, numeric_limits<int64_t>::min(),
+                        numeric_limits<int64_t>::max() }) {
+    checkAgainstStd<64, true>(edge);
+    checkAgainstStd<64, false>(static_cast<uint64_t>(edge));
+    checkAgainstStd<13, true>(edge);
+    checkAgainstStd<1, false>(static_cast<uint64_t>(edge));
+  }
+  for (int i = 0; i < 200; ++i) {
+    checkAgainstStd<64, true>(static_cast<int64_t>(next()));
+    checkAgainstStd<64, false>(next());
+    checkAgainstStd<37, true>(static_cast<int64_t>(next()));
+    checkAgainstStd<5, false>(next());
+  }
+}
+
+template <uint32_t w> void checkWide(size_t iterations) {
+  for (size_t i = 0; i < iterations; ++i) {
+    string const hex = randomHex(w / 4);
+    Value<w, false> value;
+    auto const parsed =
+        from_chars(hex.data(), hex.data() + hex.size(), value, 16);
+    BOOST_REQUIRE(parsed.ec == errc {});
+    BOOST_REQUIRE_EQUAL(toString(value, 16), hex);
+
+    string const dec = toString(value);
+    BOOST_REQUIRE_EQUAL(dec, hexToDecimal(hex));
+    Value<w, false> fromDec;
+    BOOST_REQUIRE(from_chars(dec.data(), dec.data() + dec.size(), fromDec).ec ==
+                  errc {});
+    BOOST_REQUIRE(fromDec.compute() == value.compute());
+
+    // Signed interpretation of the same bits
+    Value<w, true> const negative { Value<1, false> { 0 } - value };
+    string const negDec = toString(negative);
+    Value<w, true> fromNegDec;
+    BOOST_REQUIRE(
+        from_chars(negDec.data(), negDec.data() + negDec.size(), fromNegDec)
+            .ec == errc {});
+    BOOST_REQUIRE(fromNegDec.compute() == negative.compute());
+    for (int base : { 2, 7, 32, 36 }) {
+      string const str = toString(negative, base);
+      Value<w, true> fromStr;
+      BOOST_REQUIRE(
+          from_chars(str.data(), str.data() + str.size(), fromStr, base).ec ==
+          errc {});
+      BOOST_REQUIRE(fromStr.compute() == negative.compute());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WideRoundTrip) {
+  checkWide<65>(200);
+  checkWide<200>(200);
+  checkWide<1000>(50);
+  checkWide<4096>(20);
+}
+
+BOOST_AUTO_TEST_CASE(Errors) {
+  Value<8, true> value { 5 };
+  string const tooLarge = "128";
+  auto res = from_chars(tooLarge.data(), tooLarge.data() + 3, value);
+  BOOST_REQUIRE(res.ec == errc::result_out_of_range);
+  BOOST_REQUIRE(res.ptr == tooLarge.data() + 3);
+  BOOST_REQUIRE_EQUAL(getAs<int>(value), 5);
+
+  string const minimum = "-80 ";
+  res = from_chars(minimum.data(), minimum.data() + 4, value, 16);
+  BOOST_REQUIRE(res.ec == errc {});
+  BOOST_REQUIRE(res.ptr == minimum.data() + 3);
+  BOOST_REQUIRE_EQUAL(getAs<int>(value), -128);
+
+  string const notANumber = "-x";
+  res = from_chars(notANumber.data(), notANumber.data() + 2, value);
+  BOOST_REQUIRE(res.ec == errc::invalid_argument);
+  BOOST_REQUIRE(res.ptr == notANumber.data());
+
+  Value<8, false> unsignedValue;
+  string const negative = "-1";
+  res = from_chars(negative.data(), negative.data() + 2, unsignedValue);
+  BOOST_REQUIRE(res.ec == errc::invalid_argument);
+  string const binary = "100000000";
+  res = from_chars(binary.data(), binary.data() + 9, unsignedValue, 2);
+  BOOST_REQUIRE(res.ec == errc::result_out_of_range);
+
+  array<char, 3> small;
+  auto const written =
+      apintext::to_chars(small.begin(), small.end(), Value<8, true> { -100 });
+  BOOST_REQUIRE(written.ec == errc::value_too_large);
+}
@@ -0,0 +1,69 @@
+#ifndef TESTS_COMMON_RANDOM_HPP
+#define TESTS_COMMON_RANDOM_HPP
+
+#include <cstdint>
+
+#include "apintext/limbs.hpp"
+#include "apintext/value.hpp"
+
+/// Reproducible random inputs of the tests and benchmarks
+namespace test {
+/// State of the xorshift generator, shared by the callers of next()
+inline uint64_t state = 0x2545F4914F6CDD1D;
+
+inline uint64_t next() {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545F4914F6CDD1D;
+}
+
+template <uint32_t w>
+using limbs_t = apintext::detail::limbs_t<apintext::detail::limbCount(w)>;
+
+/// Uniformly random limbs of w bits, the bits above w being set too
+template <uint32_t w> limbs_t<w> uniformLimbs() {
+  limbs_t<w> res;
+  for (auto& limb : res)
+    limb = next();
+  return res;
+}
+
+/// Clear the drop top bits of limbs of w bits
+template <uint32_t w> void clearTopBits(limbs_t<w>& limbs, uint32_t drop) {
+  for (uint32_t i = w - drop; i < 64 * limbs.size(); ++i)
+    limbs[i / 64] &= ~(uint64_t { 1 } << (i % 64));
+}
+
+/// Random limbs of w bits whose top bits, a random number of them, are
+/// cleared: small values make the corner cases of the division more likely
+template <uint32_t w> limbs_t<w> randomLimbs() {
+  auto res = uniformLimbs<w>();
+  clearTopBits<w>(res, next() % w);
+  return res;
+}
+
+/// Value of random limbs as given by randomLimbs<w>(), sign extended from
+/// the remaining bits for signed values, so that small negative values are
+/// as likely
+template <uint32_t w, bool s> apintext::Value<w, s> randomValue() {
+  auto limbs = uniformLimbs<w>();
+  uint32_t const drop = next() % w;
+  clearTopBits<w>(limbs, drop);
+  auto const bits = apintext::detail::fromLimbs<w>(limbs);
+  if constexpr (s) {
+    auto const shifted = static_cast<apintext::ap_repr<w, s>>(bits << drop);
+    return { shifted >> drop };
+  } else {
+    return { bits };
+  }
+}
+
+/// Uniformly random value of w bits
+template <uint32_t w, bool s> apintext::Value<w, s> uniformValue() {
+  return { static_cast<apintext::ap_repr<w, s>>(
+      apintext::detail::fromLimbs<w>(uniformLimbs<w>())) };
+}
+} // namespace test
+
+#endif // TESTS_COMMON_RANDOM_HPP
@@ -0,0 +1,179 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ApIntCompat
+#define APINTEXT_AP_INT_GLOBAL
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+
+using namespace std;
+
+using namespace apintext;
+
+BOOST_AUTO_TEST_CASE(StaticFormats) {
+  static_assert(is_same_v<ap_int<8>, compat::ApInt<8, true>>);
+  static_assert(ExprType<ap_uint<12>>);
+  static_assert(is_same_v<decltype(ap_int<8> {} + ap_int<8> {}), ap_int<9>>);
+  static_assert(is_same_v<decltype(ap_uint<8> {} * ap_uint<4> {}),
+                          ap_uint<12>>);
+  static_assert(
+      is_same_v<decltype(ap_int<8> {} & ap_uint<8> {}), ap_int<9>>);
+  static_assert(is_same_v<decltype(-ap_uint<8> {}), ap_int<9>>);
+
+  constexpr ap_uint<8> a { 200 };
+  constexpr ap_uint<8> b { 100 };
+  constexpr ap_uint<8> wrapped = a + b;
+  static_assert(wrapped.to_int() == 44);
+  static_assert((a + b).to_int() == 300);
+  static_assert(a > b && b < a && a != b && a == 200);
+  static_assert(ap_int<4> { 7 } + 1 == 8);
+  static_assert((1 + ap_int<4> { -8 }).to_int() == -7);
+}
+
+BOOST_AUTO_TEST_CASE(Arithmetic) {
+  ap_int<12> a = -1000;
+  ap_uint<7> b = 100;
+  BOOST_REQUIRE_EQUAL((a * b).to_int(), -100000);
+  BOOST_REQUIRE_EQUAL((a / b).to_int(), -10);
+  BOOST_REQUIRE_EQUAL((a % b).to_int(), 0);
+  BOOST_REQUIRE_EQUAL((a - b).to_int(), -1100);
+  BOOST_REQUIRE_EQUAL((~b).to_int(), 27);
+  BOOST_REQUIRE_EQUAL((a | 1).to_int(), -999);
+
+  a += b;
+  BOOST_REQUIRE_EQUAL(a.to_int(), -900);
+  a *= 5;
+  // -4500 wraps in 12 bits
+  BOOST_REQUIRE_EQUAL(a.to_int(), -4500 + 4096);
+  ++a;
+  a--;
+  BOOST_REQUIRE_EQUAL(a.to_int(), -404);
+  b ^= 0x7F;
+  BOOST_REQUIRE_EQUAL(b.to_uint(), 27u);
+
+  long long native = a;
+  BOOST_REQUIRE_EQUAL(native, -404);
+  BOOST_REQUIRE(a < 0);
+  BOOST_REQUIRE(0 > a);
+}
+
+BOOST_AUTO_TEST_CASE(Shifts) {
+  ap_uint<100> x = 1;
+  x <<= 99;
+  BOOST_REQUIRE(x.get_bit(99));
+  BOOST_REQUIRE_EQUAL(x.countLeadingZeros(), 0);
+  BOOST_REQUIRE_EQUAL((x >> 98).to_int(), 2);
+  BOOST_REQUIRE((x << 1).iszero());
+  BOOST_REQUIRE_EQUAL((x >> 200).to_int(), 0);
+
+  ap_int<10> y = -64;
+  BOOST_REQUIRE_EQUAL((y >> 3).to_int(), -8);
+  BOOST_REQUIRE_EQUAL((y >> 20).to_int(), -1);
+  BOOST_REQUIRE_EQUAL((y << -3).to_int(), -8);
+  BOOST_REQUIRE_EQUAL((y << ap_uint<3> { 2 }).to_int(), -256);
+}
+
+BOOST_AUTO_TEST_CASE(BitsAndRanges) {
+  ap_uint<16> x = 0xABCD;
+  BOOST_REQUIRE_EQUAL(x.range(7, 0).to_uint(), 0xCDu);
+  BOOST_REQUIRE_EQUAL(x(15, 12).to_uint(), 0xAu);
+  BOOST_REQUIRE_EQUAL(x.range(11, 4).length(), 8);
+
+  x.range(11, 4) = 0x1234; // Truncated to the 8 selected bits
+  BOOST_REQUIRE_EQUAL(x.to_uint(), 0xA34Du);
+  x(3, 0) = x(15, 12);
+  BOOST_REQUIRE_EQUAL(x.to_uint(), 0xA34Au);
+
+  BOOST_REQUIRE(x[1]);
+  BOOST_REQUIRE(!x[0]);
+  x[0] = true;
+  x[1] = x[2];
+  x[15] = 0;
+  BOOST_REQUIRE_EQUAL(x.to_uint(), 0x2349u);
+  x[3].flip();
+  BOOST_REQUIRE_EQUAL(x.to_uint(), 0x2341u);
+  BOOST_REQUIRE_EQUAL((x[0] + x[6]).to_int(), 2);
+  BOOST_REQUIRE_EQUAL((x.range(7, 4) + 1).to_int(), 5);
+
+  ap_uint<16> const constant = x;
+  BOOST_REQUIRE_EQUAL(constant.range(15, 8).to_uint(), 0x23u);
+  BOOST_REQUIRE(constant[0]);
+
+  // Selections with static bounds have the width of the selection
+  static_assert(decltype(x.range<11, 4>())::width == 8);
+  static_assert(is_same_v<decltype(constant.range<11, 4>()), ap_uint<8>>);
+  BOOST_REQUIRE_EQUAL((x.range<15, 8>().to_uint()), 0x23u);
+  BOOST_REQUIRE_EQUAL((x.range<3, 0>() + 15).to_int(), 16);
+  x.range<15, 12>() = 0x1F; // Truncated to the 4 selected bits
+  x.bit<4>() = 1;
+  BOOST_REQUIRE_EQUAL(x.to_uint(), 0xF351u);
+  BOOST_REQUIRE(x.bit<0>().to_uint() == 1 && !constant.bit<1>());
+  BOOST_REQUIRE((x.range<15, 12>().and_reduce()));
+  BOOST_REQUIRE((x.range<3, 0>().xor_reduce()));
+  BOOST_REQUIRE((!x.range<7, 4>().xor_reduce()));
+  BOOST_REQUIRE((!x.range<11, 10>().or_reduce()));
+
+  // Operands are read by value, so that expressions keep their value
+  auto const sum = x.range<7, 0>() + x[0];
+  x = 0;
+  BOOST_REQUIRE_EQUAL(sum.to_int(), 0x52);
+
+  ap_uint<130> wide = 0;
+  wide.range(129, 60) = ap_int<70> { -1 };
+  BOOST_REQUIRE(wide.range(129, 60).and_reduce());
+  BOOST_REQUIRE(!wide.range(129, 59).and_reduce());
+  BOOST_REQUIRE(!wide.range(59, 0).or_reduce());
+  wide.reverse();
+  BOOST_REQUIRE(wide.range(69, 0).and_reduce());
+  BOOST_REQUIRE_EQUAL(wide.countLeadingZeros(), 60);
+}
+
+BOOST_AUTO_TEST_CASE(Reductions) {
+  ap_uint<9> x = 0x1FF;
+  BOOST_REQUIRE(x.and_reduce());
+  BOOST_REQUIRE(x.xor_reduce());
+  BOOST_REQUIRE(!x.nor_reduce());
+  x.clear(4);
+  BOOST_REQUIRE(!x.and_reduce());
+  BOOST_REQUIRE(x.nand_reduce());
+  BOOST_REQUIRE(x.xnor_reduce());
+  BOOST_REQUIRE(x.or_reduce());
+  BOOST_REQUIRE(ap_uint<9> { 0 }.nor_reduce());
+}
+
+BOOST_AUTO_TEST_CASE(Conversions) {
+  ap_int<70> const big = ap_int<70> { "-0x20000000000000001" };
+  BOOST_REQUIRE_EQUAL(big.to_string(16), "-0x20000000000000001");
+  BOOST_REQUIRE_EQUAL(big.to_string(10), "-36893488147419103233");
+  BOOST_REQUIRE_EQUAL(big.to_int64(), -1);
+  BOOST_REQUIRE_CLOSE(big.to_double(), -36893488147419103233.0, 1e-12);
+  BOOST_REQUIRE_EQUAL(ap_uint<4> { 5 }.to_string(), "0b101");
+  BOOST_REQUIRE_EQUAL(ap_int<4> { -3 }.to_string(2, false), "0b1101");
+  BOOST_REQUIRE_EQUAL(ap_uint<8> { "255" }.to_int(), 255);
+  BOOST_REQUIRE_EQUAL((ap_uint<8> { "ff", 16 }).to_int(), 255);
+  BOOST_REQUIRE_THROW(ap_uint<8> { "256" }, out_of_range);
+  BOOST_REQUIRE_THROW(ap_uint<8> { "12a" }, invalid_argument);
+  BOOST_REQUIRE_EQUAL(ap_int<8> { "127" }.to_int(), 127);
+  BOOST_REQUIRE_EQUAL(ap_int<8> { "-128" }.to_int(), -128);
+  BOOST_REQUIRE_EQUAL(ap_int<8> { "-0x80" }.to_int(), -128);
+  BOOST_REQUIRE_THROW(ap_int<8> { "128" }, out_of_range);
+  BOOST_REQUIRE_THROW(ap_int<8> { "200" }, out_of_range);
+  BOOST_REQUIRE_THROW(ap_int<8> { "-200" }, out_of_range);
+  BOOST_REQUIRE_THROW(ap_int<8> { "-129" }, out_of_range);
+  BOOST_REQUIRE_THROW(ap_uint<8> { "-1" }, invalid_argument);
+
+  ostringstream out;
+  out << ap_int<20> { -123456 } << " " << hex << ap_uint<20> { 0xBEEF };
+  BOOST_REQUIRE_EQUAL(out.str(), "-123456 beef");
+
+  Value<12, true> value = ap_int<10> { -5 };
+  BOOST_REQUIRE_EQUAL(getAs<int>(value), -5);
+  ap_uint<6> fromValue = Value<9, false> { 300 };
+  BOOST_REQUIRE_EQUAL(fromValue.to_int(), 300 % 64);
+}
@@ -0,0 +1,81 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ConstantTime
+
+#include <cstdint>
+#include <iostream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+
+using namespace std;
+
+using namespace apintext;
+
+template <uint32_t wA, bool sA, uint32_t wB, bool sB> bool testAllOps() {
+  constexpr uint32_t aUpperBound = 1 << wA;
+  constexpr uint32_t bUpperBound = 1 << wB;
+  for (uint32_t aRepr = 0; aRepr < aUpperBound; ++aRepr) {
+    Value<wA, sA> a { aRepr };
+    for (uint32_t bRepr = 0; bRepr < bUpperBound; ++bRepr) {
+      Value<wB, sB> b { bRepr };
+      bool ok = (ct::prod(a, b).compute() == (a * b).compute()) &&
+                (getAs<int>(ct::lessThan(a, b)) == (a < b)) &&
+                (getAs<int>(ct::lessEqual(a, b)) == (a <= b)) &&
+                (getAs<int>(ct::greaterThan(a, b)) == (a > b)) &&
+                (getAs<int>(ct::greaterEqual(a, b)) == (a >= b)) &&
+                (getAs<int>(ct::equal(a, b)) == (a == b)) &&
+                (getAs<int>(ct::notEqual(a, b)) == (a != b));
+      if (bRepr != 0) {
+        ok = ok && (ct::div(a, b).compute() == (a / b).compute()) &&
+             (ct::mod(a, b).compute() == (a % b).compute());
+      }
+      if (!ok) {
+        cerr << "Error for " << wA << " (" << sA << ") op " << wB << " (" << sB
+             << "), operands " << aRepr << ", " << bRepr << "\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(ExhaustiveNarrow) {
+  BOOST_REQUIRE((testAllOps<1, false, 1, false>()));
+  BOOST_REQUIRE((testAllOps<1, true, 1, true>()));
+  BOOST_REQUIRE((testAllOps<1, true, 4, false>()));
+  BOOST_REQUIRE((testAllOps<5, false, 5, false>()));
+  BOOST_REQUIRE((testAllOps<5, true, 5, true>()));
+  BOOST_REQUIRE((testAllOps<5, true, 8, false>()));
+  BOOST_REQUIRE((testAllOps<8, false, 5, true>()));
+  BOOST_REQUIRE((testAllOps<8, true, 8, true>()));
+}
+
+BOOST_AUTO_TEST_CASE(Wide) {
+  uint64_t state = 0x9E3779B97F4A7C15;
+  auto next = [&state]() {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    return Value<64, false> { state };
+  };
+  for (int i = 0; i < 200; ++i) {
+    Value<200, true> a = next() * next() * next() * next();
+    Value<130, false> b = next() * next() * next();
+    if (i % 4 == 0)
+      b = slice<60, 0>(b);
+    BOOST_REQUIRE(ct::prod(a, b).compute() == (a * b).compute());
+    BOOST_REQUIRE(ct::div(a, b).compute() == (a / b).compute());
+    BOOST_REQUIRE(ct::mod(a, b).compute() == (a % b).compute());
+    BOOST_REQUIRE(ct::div(b, a).compute() == (b / a).compute());
+    BOOST_REQUIRE(getAs<int>(ct::lessThan(a, b)) == (a < b));
+    BOOST_REQUIRE(getAs<int>(ct::equal(a, a)) == 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StaticConstantTime) {
+  constexpr Value<9, true> a { -200 };
+  constexpr Value<4, false> b { 7 };
+  static_assert(getAs<int>(ct::div(a, b)) == -28);
+  static_assert(getAs<int>(ct::mod(a, b)) == -4);
+  static_assert(getAs<int>(ct::prod(a, b)) == -1400);
+  static_assert(getAs<int>(ct::lessThan(a, b)) == 1);
+}
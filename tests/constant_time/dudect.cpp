@@ -0,0 +1,168 @@
+// Timing leakage detection for the constant-time kernels, following the
+// methodology of dudect (Reparaz, Balasch, Verbauwhede, "Dude, is my code
+// constant time?", DATE 2017): execution times for a fixed input class and a
+// random input class are collected in random interleaved order, cropped at
+// several percentiles, and compared with Welch's t-test.
+//
+// A |t| above 10 is considered a definite leak. The exit status is non zero
+// when one of the constant-time kernels leaks; the generic kernels are
+// measured too, for reference.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "apintext.hpp"
+
+using namespace apintext;
+
+namespace {
+constexpr double leakThreshold = 10.;
+constexpr std::size_t measurementCount = 200000;
+constexpr std::array<double, 4> cropPercentiles { 1., 0.9, 0.75, 0.5 };
+
+/// Online mean and variance (Welford)
+class WelchAccumulator {
+  double mean[2] = { 0., 0. };
+  double m2[2] = { 0., 0. };
+  double count[2] = { 0., 0. };
+
+ public:
+  void push(double x, int cls) {
+    count[cls] += 1.;
+    double delta = x - mean[cls];
+    mean[cls] += delta / count[cls];
+    m2[cls] += delta * (x - mean[cls]);
+  }
+
+  double t() const {
+    if (count[0] < 2 || count[1] < 2)
+      return 0.;
+    double var0 = m2[0] / (count[0] - 1);
+    double var1 = m2[1] / (count[1] - 1);
+    double den = std::sqrt(var0 / count[0] + var1 / count[1]);
+    return (den == 0.) ? 0. : (mean[0] - mean[1]) / den;
+  }
+};
+
+template <typename T> void doNotOptimize(T const& value) {
+  asm volatile("" : : "m"(value) : "memory");
+}
+
+/// Run f on inputs of the fixed class (0) or the random class (1) and return
+/// the largest |t| statistic over all the percentile crops.
+template <typename Input, typename Gen, typename F>
+double measure(Input const& fixed, Gen&& randomInput, F&& f) {
+  std::mt19937_64 rng { 0xD0DEC7 };
+  std::vector<int> classes(measurementCount);
+  std::vector<Input> inputs;
+  inputs.reserve(measurementCount);
+  for (auto& cls : classes) {
+    cls = static_cast<int>(rng() & 1);
+    inputs.push_back(cls ? randomInput(rng) : fixed);
+  }
+
+  std::vector<double> times(measurementCount);
+  for (std::size_t i = 0; i < measurementCount; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    doNotOptimize(f(inputs[i]));
+    auto end = std::chrono::steady_clock::now();
+    times[i] = std::chrono::duration<double, std::nano>(end - start).count();
+  }
+
+  std::vector<double> sorted = times;
+  std::sort(sorted.begin(), sorted.end());
+  double maxT = 0.;
+  for (double percentile : cropPercentiles) {
+    double threshold = sorted[static_cast<std::size_t>(
+        percentile * static_cast<double>(measurementCount - 1))];
+    WelchAccumulator acc;
+    for (std::size_t i = 0; i < measurementCount; ++i) {
+      if (times[i] <= threshold)
+        acc.push(times[i], classes[i]);
+    }
+    maxT = std::max(maxT, std::abs(acc.t()));
+  }
+  return maxT;
+}
+
+using WideSigned = Value<256, true>;
+
+template <typename V> V randomValue(std::mt19937_64& rng) {
+  return Value<64, false> { rng() } * Value<64, false> { rng() } *
+         Value<64, false> { rng() } * Value<64, false> { rng() };
+}
+
+struct Operands {
+  WideSigned left;
+  Value<128, true> right;
+};
+
+Operands randomOperands(std::mt19937_64& rng) {
+  return { randomValue<WideSigned>(rng),
+           Value<64, true> { static_cast<int64_t>(rng()) } *
+               Value<64, false> { rng() } };
+}
+
+bool report(char const* name, double t, bool mustPass) {
+  bool leaks = t > leakThreshold;
+  std::cout << name << ": max |t| = " << t
+            << (leaks ? " (leakage detected)" : "") << "\n";
+  return !(mustPass && leaks);
+}
+} // namespace
+
+int main() {
+  Operands const fixed { WideSigned { 0 }, Value<128, true> { 1 } };
+  bool ok = true;
+
+  ok &= report(
+      "ct::prod",
+      measure(fixed, randomOperands,
+              [](Operands const& op) {
+                return ct::prod(op.left, op.right).compute();
+              }),
+      true);
+  ok &= report(
+      "ct::div",
+      measure(fixed, randomOperands,
+              [](Operands const& op) {
+                return ct::div(op.left, op.right).compute();
+              }),
+      true);
+  ok &= report(
+      "ct::mod",
+      measure(fixed, randomOperands,
+              [](Operands const& op) {
+                return ct::mod(op.left, op.right).compute();
+              }),
+      true);
+  ok &= report(
+      "ct::lessThan",
+      measure(fixed, randomOperands,
+              [](Operands const& op) {
+                return ct::lessThan(op.left, op.right).compute();
+              }),
+      true);
+  ok &= report(
+      "ct::equal",
+      measure(fixed, randomOperands,
+              [](Operands const& op) {
+                return ct::equal(op.left, op.right).compute();
+              }),
+      true);
+
+  report("generic division (reference)",
+         measure(fixed, randomOperands,
+                 [](Operands const& op) {
+                   return (op.left / op.right).compute();
+                 }),
+         false);
+
+  return ok ? 0 : 1;
+}
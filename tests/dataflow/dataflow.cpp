@@ -0,0 +1,122 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Dataflow
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+
+using namespace std;
+
+using namespace apintext;
+
+BOOST_AUTO_TEST_CASE(StreamFifo) {
+  Stream<Value<12, true>> stream { 5 };
+  BOOST_REQUIRE_EQUAL(stream.depth(), 8);
+  vector<Value<12, true>> values(20), out(20);
+  for (int i = 0; i < 20; ++i)
+    values[i] = Value<12, true> { i - 10 };
+  // Wrap around the ring buffer several times
+  for (int round = 0; round < 3; ++round) {
+    BOOST_REQUIRE_EQUAL(stream.tryPush(span { values }), 8);
+    BOOST_REQUIRE(stream.full());
+    BOOST_REQUIRE(!stream.tryPush(values[8]));
+    BOOST_REQUIRE_EQUAL(stream.tryPop(span { out }.first(5)), 5);
+    BOOST_REQUIRE_EQUAL(stream.tryPush(span { values }.subspan(8, 3)), 3);
+    BOOST_REQUIRE_EQUAL(stream.tryPop(span { out }.subspan(5)), 6);
+    BOOST_REQUIRE(stream.empty());
+    for (int i = 0; i < 11; ++i)
+      BOOST_REQUIRE((out[i] == values[i]));
+  }
+  Value<12, true> value;
+  BOOST_REQUIRE(!stream.tryPop(value));
+}
+
+/// Source, transform and sink stages, moving values one by one and by
+/// batches, should produce what the sequential computation does
+BOOST_AUTO_TEST_CASE(Pipeline) {
+  constexpr size_t count = 100000;
+  Stream<Value<12, true>> inputs { 64 };
+  Stream<Value<25, false>> outputs { 16 };
+  vector<Value<25, false>> results(count);
+
+  Dataflow flow;
+  flow.addStage([&] {
+    for (size_t i = 0; i < count; ++i)
+      inputs.push(Value<12, true> { static_cast<int64_t>(i % 4096) - 2048 });
+  });
+  flow.addStage([&] {
+    vector<Value<12, true>> batch(100);
+    vector<Value<25, false>> squares(100);
+    for (size_t done = 0; done < count; done += batch.size()) {
+      inputs.pop(span { batch });
+      for (size_t i = 0; i < batch.size(); ++i)
+        squares[i] = Value<25, false> { static_cast<ap_repr<25, false>>(
+            (batch[i] * batch[i] + Value<1, false> { 1 }).compute()) };
+      outputs.push(span<Value<25, false> const> { squares });
+    }
+  });
+  flow.addStage([&] {
+    for (auto& result : results)
+      result = outputs.pop();
+  });
+  flow.run();
+
+  for (size_t i = 0; i < count; ++i) {
+    int64_t const v = static_cast<int64_t>(i % 4096) - 2048;
+    BOOST_REQUIRE((results[i] == Value<25, false> { v * v + 1 }));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DeadlockDetection) {
+  // The consumer pops one value more than the producer pushes
+  {
+    Stream<Value<8, false>> stream { 4 };
+    Dataflow flow;
+    flow.addStage([&] {
+      for (uint32_t i = 0; i < 10; ++i)
+        stream.push(Value<8, false> { i });
+    });
+    flow.addStage([&] {
+      for (int i = 0; i < 11; ++i)
+        stream.pop();
+    });
+    BOOST_REQUIRE_THROW(flow.run(), DeadlockError);
+  }
+  // Two stages both wait for the other one first
+  {
+    Stream<Value<8, false>> forward { 4 }, backward { 4 };
+    Dataflow flow;
+    flow.addStage([&] {
+      forward.push(backward.pop());
+    });
+    flow.addStage([&] {
+      backward.push(forward.pop());
+    });
+    try {
+      flow.run();
+      BOOST_FAIL("Deadlock not detected");
+    } catch (DeadlockError const& e) {
+      BOOST_REQUIRE_EQUAL(string { e.what() },
+                          "Dataflow deadlock: stage 0 waits to pop, stage 1 "
+                          "waits to pop");
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StageExceptionIsRethrown) {
+  Stream<Value<8, false>> stream { 4 };
+  Dataflow flow;
+  flow.addStage([&] {
+    stream.push(Value<8, false> { 1 });
+    throw invalid_argument("Stage failure");
+  });
+  flow.addStage([&] {
+    while (true)
+      stream.pop();
+  });
+  BOOST_REQUIRE_THROW(flow.run(), invalid_argument);
+}
@@ -0,0 +1,124 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE DynInt
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+/// Dynamic integer of the format and value of expr
+template <ExprType ET> ApIntDyn dyn(ET const& expr) {
+  return ApIntDyn { Value<ET::width, ET::signedness> { expr } };
+}
+
+void checkSame(ApIntDyn const& res, ApIntDyn const& expected) {
+  BOOST_REQUIRE(res.format() == expected.format());
+  BOOST_REQUIRE(res == expected);
+  BOOST_REQUIRE(vector<uint64_t>(res.limbs().begin(), res.limbs().end()) ==
+                vector<uint64_t>(expected.limbs().begin(),
+                                 expected.limbs().end()));
+}
+
+template <uint32_t w1, bool s1, uint32_t w2, bool s2> void checkFormats() {
+  for (int i = 0; i < 200; ++i) {
+    ArenaBatch const batch;
+    auto const a = randomValue<w1, s1>();
+    auto const b = randomValue<w2, s2>();
+    ApIntDyn const da { a };
+    ApIntDyn const db { b };
+    checkSame(da + db, dyn(a + b));
+    checkSame(da - db, dyn(a - b));
+    checkSame(da * db, dyn(a * b));
+    if (b != Value<1, false> { 0 }) {
+      checkSame(da / db, dyn(a / b));
+      checkSame(da % db, dyn(a % b));
+    }
+    BOOST_REQUIRE((da < db) == (a < b));
+    BOOST_REQUIRE((da >= db) == (a >= b));
+    BOOST_REQUIRE((da == db) == (a == b));
+    checkSame(da.slice(w1 - 1, w1 / 2), dyn(slice<w1 - 1, w1 / 2>(a)));
+    checkSame(da.adapt({ w2, s2 }), dyn(Value<w2, s2> { a }));
+    Value<w2, false> const ub { b };
+    checkSame(~ApIntDyn { ub }, dyn(~ub));
+    BOOST_REQUIRE((da.toValue<w1, s1>() == a));
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(MatchesValue) {
+  checkFormats<32, true, 17, false>();
+  checkFormats<64, false, 64, true>();
+  checkFormats<100, true, 100, true>();
+  checkFormats<200, true, 150, false>();
+  checkFormats<150, false, 300, true>();
+  checkFormats<129, true, 7, true>();
+}
+
+BOOST_AUTO_TEST_CASE(Arena) {
+  auto& arena = DynArena::local();
+  auto const start = arena.mark();
+  {
+    // Values up to 128 bits are stored inline
+    ApIntDyn const a { { 64, true }, -3 };
+    ApIntDyn const b { { 60, false }, 12 };
+    checkSame(a * b, ApIntDyn { { 124, true }, -36 });
+    checkSame((a * b) / b, ApIntDyn { { 124, true }, -3 });
+    BOOST_REQUIRE((arena.mark() == start));
+  }
+
+  std::size_t capacity = 0;
+  for (int i = 0; i < 100; ++i) {
+    ArenaBatch const batch;
+    ApIntDyn acc { { 1000, false }, 1 };
+    for (int j = 0; j < 50; ++j)
+      acc = (acc * ApIntDyn { { 1000, false }, 3 }).adapt({ 1000, false });
+    BOOST_REQUIRE(!acc.isNegative());
+    if (i == 0)
+      capacity = arena.capacity();
+    // The arena does not grow once warmed up
+    BOOST_REQUIRE(arena.capacity() == capacity);
+  }
+  BOOST_REQUIRE((arena.mark() == start));
+}
+
+BOOST_AUTO_TEST_CASE(MovedFromValues) {
+  ArenaBatch const batch;
+  ApIntDyn const c { { 300, true }, -7 };
+  ApIntDyn const expected { { 300, true }, 42 };
+  ApIntDyn a = expected;
+  ApIntDyn b { { 300, true } };
+  b = std::move(a);
+  // a does not share the storage of b any more
+  a = c;
+  checkSame(b, expected);
+  checkSame(a, c);
+
+  ApIntDyn moved { std::move(b) };
+  b = c;
+  checkSame(moved, expected);
+  checkSame(b, c);
+}
+
+BOOST_AUTO_TEST_CASE(Errors) {
+  ApIntDyn const a { { 8, false }, 5 };
+  ApIntDyn const b { { 9, false }, 5 };
+  BOOST_REQUIRE(a == b);
+  BOOST_REQUIRE_THROW(a & b, invalid_argument);
+  BOOST_REQUIRE_THROW(a.slice(8, 0), out_of_range);
+  BOOST_REQUIRE_THROW((a.toValue<8, true>()), invalid_argument);
+  BOOST_REQUIRE_THROW((ApIntDyn { { 0, false } }), invalid_argument);
+
+  ApIntDyn const zero { { 8, true }, 0 };
+  checkSame(a / zero, ApIntDyn { { 9, true }, -1 });
+  checkSame(a % zero, ApIntDyn { { 8, false }, 5 });
+}
@@ -0,0 +1,79 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE DynSlice
+
+#include <cstdint>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+template <uint32_t w, bool s> auto bitsOf(Value<w, s> const& value) {
+  return detail::toLimbs<w>(static_cast<ap_repr<w, false>>(value.compute()));
+}
+
+/// Bits [low, low + 32) of bits, zero past w
+template <uint32_t w, typename Limbs>
+uint64_t expectedSlice(Limbs const& bits, uint32_t low) {
+  uint64_t res = 0;
+  for (uint32_t b = 0; b < 32; ++b) {
+    uint32_t const idx = low + b;
+    if (idx < w)
+      res |= ((bits[idx / 64] >> (idx % 64)) & 1) << b;
+  }
+  return res;
+}
+
+constexpr Value<100, false> constantValue() {
+  Value<100, false> value { 0 };
+  sliceRef<79, 40>(value) = Value<40, false> { 0xABCDEF0122 };
+  bitRef<99>(value) = true;
+  return value;
+}
+} // namespace
+
+static_assert(StoredExpr<Value<200, true>>);
+static_assert(!StoredExpr<decltype(Value<8, false> {} + Value<8, false> {})>);
+
+BOOST_AUTO_TEST_CASE(StoredSources) {
+  for (int i = 0; i < 100; ++i) {
+    auto const value = uniformValue<4096, false>();
+    auto const signedValue = uniformValue<200, true>();
+    auto const bits = bitsOf(value);
+    auto const signedBits = bitsOf(signedValue);
+    for (uint32_t low = 0; low < 4200; low += 1 + next() % 97) {
+      uint64_t const expected = expectedSlice<4096>(bits, low);
+      BOOST_REQUIRE(getAs<uint64_t>(dynSlice<32>(value, low)) == expected);
+      BOOST_REQUIRE(getAs<uint64_t>(dynSlice<32>(signedValue, low)) ==
+                    expectedSlice<200>(signedBits, low));
+      BOOST_REQUIRE(getAs<uint64_t>(dynGetBit(value, low)) == (expected & 1));
+    }
+  }
+  static_assert(getAs<uint64_t>(dynSlice<70>(constantValue(), 40)) ==
+                0x80000ABCDEF0122);
+  Value<16, true> const narrow { -2 };
+  BOOST_REQUIRE(getAs<int>(dynSlice<8>(narrow, 4)) == 0xFF);
+  BOOST_REQUIRE(getAs<int>(dynSlice<8>(narrow, 12)) == 0xF);
+  BOOST_REQUIRE(getAs<int>(dynGetBit(narrow, 0)) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(ComputedSources) {
+  for (int i = 0; i < 100; ++i) {
+    auto const a = uniformValue<300, false>();
+    auto const b = uniformValue<300, false>();
+    Value<300, false> const expected { a ^ b };
+    auto const bits = bitsOf(expected);
+    for (uint32_t low = 0; low < 320; low += 1 + next() % 13)
+      BOOST_REQUIRE(getAs<uint64_t>(dynSlice<32>(a ^ b, low)) ==
+                    expectedSlice<300>(bits, low));
+  }
+  Value<20, true> const narrow { -1000 };
+  BOOST_REQUIRE(getAs<int>(dynSlice<8>(narrow + Value<2, false> { 1 }, 16)) ==
+                0x1F);
+}
@@ -0,0 +1,164 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Float
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+/// Random encoding of T, biased towards subnormals, extreme exponents and
+/// specials; with a reference, an encoding of a close magnitude, so that
+/// sums cancel
+template <typename T> T randomFloat(T const* close = nullptr) {
+  using bits_t = conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+  constexpr int fracBits = numeric_limits<T>::digits - 1;
+  constexpr int expBits = 8 * sizeof(T) - 1 - fracBits;
+  constexpr bits_t expMax = (bits_t { 1 } << expBits) - 1;
+  bits_t bits = static_cast<bits_t>(next());
+  bits_t exp = (bits >> fracBits) & expMax;
+  switch (next() % 8) {
+  case 0:
+    exp = 0;
+    break;
+  case 1:
+    exp = (next() % 2) ? expMax : expMax - 1 - next() % 2;
+    break;
+  case 2:
+    exp = 1 + next() % 2;
+    break;
+  case 3:
+    if (close != nullptr) {
+      bits_t const ref = bit_cast<bits_t>(*close);
+      exp = ((ref >> fracBits) & expMax) + next() % 3;
+      exp = (exp > 0) ? min(exp - 1, expMax) : 0;
+      if (next() % 2)
+        bits = ref ^ (bits & 0xFF);
+    }
+    break;
+  }
+  if (next() % 2)
+    bits &= ~bits_t { 0 } << (next() % fracBits);
+  bits = (bits & ~(expMax << fracBits)) | (exp << fracBits);
+  return bit_cast<T>(bits);
+}
+
+template <typename T> auto encodingOf(T value) {
+  using bits_t = conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+  return bit_cast<bits_t>(value);
+}
+
+/// Same encoding, or both NaNs
+template <typename T, uint32_t e, uint32_t m>
+bool sameFloat(T expected, Float<e, m> const& res) {
+  if (isnan(expected))
+    return res.isNaN();
+  return ap_repr<1 + e + m, false> { encodingOf(expected) } == res.bits();
+}
+
+template <typename T, uint32_t e, uint32_t m> void checkAgainstHardware() {
+  using F = Float<e, m>;
+  auto const asFloat = [](T value) {
+    return F::fromBits(ap_repr<1 + e + m, false> { encodingOf(value) });
+  };
+  for (int i = 0; i < 200000; ++i) {
+    T const a = randomFloat<T>();
+    T const b = randomFloat<T>(&a);
+    T const c = randomFloat<T>(&a);
+    F const fa = asFloat(a), fb = asFloat(b), fc = asFloat(c);
+    BOOST_REQUIRE(sameFloat(a + b, fa + fb));
+    BOOST_REQUIRE(sameFloat(a - b, fa - fb));
+    BOOST_REQUIRE(sameFloat(a * b, fa * fb));
+    BOOST_REQUIRE(sameFloat(std::fma(a, b, c), fma(fa, fb, fc)));
+    BOOST_REQUIRE(sameFloat(std::fma(a, c, -a * c), fma(fa, fc, -(fa * fc))));
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Binary32) { checkAgainstHardware<float, 8, 23>(); }
+
+BOOST_AUTO_TEST_CASE(Binary64) { checkAgainstHardware<double, 11, 52>(); }
+
+/// Binary16 operations, whose exact results are doubles, rounded from the
+/// double ones
+BOOST_AUTO_TEST_CASE(Binary16) {
+  using Half = Float<5, 10>;
+  static_assert(Half { 65504.0 }.bits() == ap_repr<16, false> { 0x7BFF },
+                "Wrong largest half");
+  static_assert(Half { 65520.0 }.bits() == ap_repr<16, false> { 0x7C00 },
+                "Halves should round to infinity from 65520 on");
+  static_assert(Half { 0x1p-24 }.bits() == ap_repr<16, false> { 1 },
+                "Wrong smallest subnormal half");
+  static_assert(Half { 0x1p-25 }.bits() == ap_repr<16, false> { 0 },
+                "Ties should round to even");
+  static_assert(Half { 1.0 / 3 }.bits() == ap_repr<16, false> { 0x3555 },
+                "Wrong rounding of a third");
+  for (uint32_t i = 0; i < (1 << 16); i += 1 + next() % 7) {
+    for (int j = 0; j < 16; ++j) {
+      Half const a = Half::fromBits(ap_repr<16, false> { i });
+      Half const b = Half::fromBits(ap_repr<16, false> {
+          static_cast<uint16_t>((j < 8) ? next() : i ^ (next() % 64)) });
+      double const da = static_cast<double>(a), db = static_cast<double>(b);
+      BOOST_REQUIRE(sameFloat(static_cast<double>(Half { da + db }),
+                              Float<11, 52> { a + b }));
+      BOOST_REQUIRE(sameFloat(static_cast<double>(Half { da * db }),
+                              Float<11, 52> { a * b }));
+    }
+  }
+}
+
+#if defined(__SIZEOF_FLOAT128__)
+/// Binary128 against the software floating-point of the compiler
+BOOST_AUTO_TEST_CASE(Binary128) {
+  using Quad = Float<15, 112>;
+  auto const toQuad = [](__float128 value) {
+    auto const limbs = bit_cast<detail::limbs_t<2>>(value);
+    return Quad::fromBits(detail::fromLimbs<128>(limbs));
+  };
+  for (int i = 0; i < 20000; ++i) {
+    double const a = randomFloat<double>();
+    double const b = randomFloat<double>(&a);
+    __float128 const qa = static_cast<__float128>(a) / 3;
+    __float128 const qb = static_cast<__float128>(b) * 7;
+    Quad const fa = toQuad(qa), fb = toQuad(qb);
+    if (isnan(a) || isnan(b))
+      continue;
+    BOOST_REQUIRE((toQuad(qa + qb).bits() == (fa + fb).bits() ||
+                   (fa + fb).isNaN()));
+    BOOST_REQUIRE((toQuad(qa * qb).bits() == (fa * fb).bits() ||
+                   (fa * fb).isNaN()));
+  }
+}
+#endif
+
+/// Float operations are expressions on encodings, which evaluate in batch
+BOOST_AUTO_TEST_CASE(BatchEvaluation) {
+  Placeholder<0, 32, false> a;
+  Placeholder<1, 32, false> b;
+  auto const shape = floatFma<8, 23>(a, b, floatAdd<8, 23>(a, b));
+  size_t const count = 1000;
+  vector<uint32_t> as(count), bs(count);
+  vector<float> expected(count);
+  for (size_t i = 0; i < count; ++i) {
+    float const fa = randomFloat<float>();
+    float const fb = randomFloat<float>(&fa);
+    as[i] = bit_cast<uint32_t>(fa);
+    bs[i] = bit_cast<uint32_t>(fb);
+    expected[i] = std::fma(fa, fb, fa + fb);
+  }
+  vector<Value<32, false>> out(count);
+  evaluate(shape, as, bs, out);
+  for (size_t i = 0; i < count; ++i)
+    BOOST_REQUIRE(sameFloat(expected[i], Float<8, 23>::fromBits(
+                                             out[i].compute())));
+}
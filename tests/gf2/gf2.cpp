@@ -0,0 +1,110 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE GF2
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <string_view>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+/// Bits of the value of expr, zero extended to n bits
+template <size_t n, ExprType ET> bitset<n> bitsOf(ET const& expr) {
+  auto const limbs = detail::toLimbs<ET::width>(
+      static_cast<ap_repr<ET::width, false>>(expr.compute()));
+  bitset<n> res;
+  for (uint32_t i = 0; i < ET::width; ++i)
+    res[i] = (limbs[i / 64] >> (i % 64)) & 1;
+  return res;
+}
+
+template <uint32_t wa, uint32_t wb> void checkClmul() {
+  constexpr uint32_t w = wa + wb - 1;
+  for (int i = 0; i < 200; ++i) {
+    auto const a = randomValue<wa, false>();
+    auto const b = randomValue<wb, true>();
+    auto const aBits = bitsOf<w>(a);
+    auto const bBits = bitsOf<w>(b);
+    bitset<w> expected;
+    for (uint32_t j = 0; j < wb; ++j)
+      if (bBits[j])
+        expected ^= aBits << j;
+    BOOST_REQUIRE(bitsOf<w>(clmul(a, b)) == expected);
+  }
+}
+
+/// polyMod should match the bit-serial long division
+template <typename Poly, uint32_t w> void checkPolyMod() {
+  constexpr uint32_t d = Poly::degree;
+  constexpr size_t n = max(w, d + 1);
+  bitset<n> poly;
+  poly[d] = true;
+  for (uint32_t i = 0; i < d; ++i)
+    poly[i] = (Poly::low[i / 64] >> (i % 64)) & 1;
+  for (int i = 0; i < 200; ++i) {
+    auto const x = randomValue<w, false>();
+    auto expected = bitsOf<n>(x);
+    for (uint32_t j = w; j-- > d;)
+      if (expected[j])
+        expected ^= poly << (j - d);
+    BOOST_REQUIRE(bitsOf<n>(polyMod<Poly>(x)) == expected);
+  }
+}
+
+using Crc32 = Polynomial<32, 26, 23, 22, 16, 12, 11, 10, 8, 7, 5, 4, 2, 1, 0>;
+using Ghash = Polynomial<128, 7, 2, 1, 0>;
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Clmul) {
+  constexpr auto prod =
+      clmul(Value<4, false> { 0b1011 }, Value<3, false> { 0b110 });
+  static_assert(decltype(prod)::width == 6 && !decltype(prod)::signedness,
+                "Error in carry-less product format");
+  static_assert(prod.compute() == ap_repr<6, false> { 0b111010 },
+                "Unexpected carry-less product");
+  checkClmul<1, 1>();
+  checkClmul<7, 9>();
+  checkClmul<64, 64>();
+  checkClmul<100, 37>();
+  checkClmul<300, 200>();
+}
+
+BOOST_AUTO_TEST_CASE(PolyMod) {
+  static_assert(polyMod<Polynomial<1, 0>>(Value<9, false> { 0b100110111 })
+                        .compute() == ap_repr<1, false> { 0 },
+                "Reduction modulo x + 1 should be the parity");
+  checkPolyMod<Polynomial<1, 0>, 9>();
+  checkPolyMod<Crc32, 20>();
+  checkPolyMod<Crc32, 32>();
+  checkPolyMod<Crc32, 64>();
+  checkPolyMod<Crc32, 1000>();
+  checkPolyMod<Polynomial<64, 4, 3, 1, 0>, 500>();
+  checkPolyMod<Ghash, 255>();
+  checkPolyMod<Ghash, 1024>();
+}
+
+/// CRC-32/BZIP2 of "123456789": the message shifted by the degree, with
+/// the initial register added to its top, reduced, then inverted
+BOOST_AUTO_TEST_CASE(Crc) {
+  string_view const text = "123456789";
+  detail::limbs_t<2> limbs {};
+  for (size_t i = 0; i < text.size(); ++i) {
+    uint32_t const bit = 32 + 8 * static_cast<uint32_t>(text.size() - 1 - i);
+    limbs[bit / 64] |= uint64_t { static_cast<uint8_t>(text[i]) } << (bit % 64);
+  }
+  for (uint32_t bit = 72; bit < 104; ++bit)
+    limbs[bit / 64] ^= uint64_t { 1 } << (bit % 64);
+  Value<104, false> const shifted { detail::fromLimbs<104>(limbs) };
+  Value<32, false> const crc =
+      polyMod<Crc32>(shifted) ^ Value<32, false> { 0xFFFFFFFFu };
+  BOOST_REQUIRE((crc == Value<32, false> { 0xFC891918u }));
+}
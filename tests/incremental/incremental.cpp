@@ -0,0 +1,74 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Incremental
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+
+using namespace std;
+
+using namespace apintext;
+
+BOOST_AUTO_TEST_CASE(Values) {
+  SignalGraph graph;
+  auto a = graph.input<32, false>("a", 7);
+  auto b = graph.input<32, true>("b", -3);
+  auto sum = graph.define("sum", a + b);
+  auto prod = graph.define("prod", sum * a);
+  auto out = graph.define("out", prod - Value<8, false> { 1 });
+  BOOST_REQUIRE(graph.size() == 5);
+  BOOST_REQUIRE(getAs<int64_t>(out) == 27);
+  a.set(10);
+  BOOST_REQUIRE(getAs<int64_t>(out) == 69);
+  b.set(Value<32, true> { -20 });
+  BOOST_REQUIRE(getAs<int64_t>(out) == -101);
+  BOOST_REQUIRE(getAs<int64_t>(graph.find<33, true>("sum")) == -10);
+  BOOST_REQUIRE_THROW((graph.find<32, true>("sum")), invalid_argument);
+  BOOST_REQUIRE_THROW((graph.find<33, true>("none")), out_of_range);
+  BOOST_REQUIRE_THROW((graph.define("sum", a + a)), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(OnlyChangesAreRecomputed) {
+  SignalGraph graph;
+  auto a = graph.input<64, false>("a", 1);
+  auto b = graph.input<64, false>("b", 2);
+  auto c = graph.input<64, false>("c", 3);
+  auto ab = graph.define("ab", a * b);
+  auto bc = graph.define("bc", b * c);
+  auto top = graph.define("top", ab + bc);
+  auto lowBit = graph.define("lowBit", getBit<0>(c));
+  auto gated = graph.define("gated", lowBit + top);
+  graph.settle();
+  BOOST_REQUIRE(graph.evaluations() == 5);
+  BOOST_REQUIRE(getAs<uint64_t>(gated) == 9);
+
+  // Setting an input to its current value does not invalidate anything
+  a.set(1);
+  graph.settle();
+  BOOST_REQUIRE(graph.evaluations() == 5);
+
+  // Only the cone of a is recomputed
+  a.set(5);
+  BOOST_REQUIRE(getAs<uint64_t>(gated) == 17);
+  BOOST_REQUIRE(graph.evaluations() == 8);
+
+  // lowBit does not change, so gated is recomputed because of top only
+  c.set(5);
+  BOOST_REQUIRE(getAs<uint64_t>(lowBit) == 1);
+  BOOST_REQUIRE(graph.evaluations() == 9);
+  graph.settle();
+  BOOST_REQUIRE(graph.evaluations() == 12);
+  BOOST_REQUIRE(getAs<uint64_t>(gated) == 21);
+
+  // ab and bc change, but neither their sum nor lowBit: gated is not
+  // recomputed
+  b.set(1);
+  c.set(7);
+  a.set(13);
+  graph.settle();
+  BOOST_REQUIRE(getAs<uint64_t>(top) == 20);
+  BOOST_REQUIRE(graph.evaluations() == 16);
+}
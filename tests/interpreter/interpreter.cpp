@@ -0,0 +1,175 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Interpreter
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+#include "apintext/interpreter.hpp"
+#include "apintext/runtime_ir.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+/// Limbs of the value of expr, extended to the limb boundary
+template <ExprType ET> vector<uint64_t> limbsOf(ET const& expr) {
+  constexpr uint32_t bits = 64 * detail::limbCount(ET::width);
+  Value<bits, ET::signedness> const extended { expr };
+  auto const limbs = detail::toLimbs<bits>(
+      static_cast<ap_repr<bits, false>>(extended.compute()));
+  return { limbs.begin(), limbs.end() };
+}
+
+/// Limbs computed by f, or none when the divisor is zero, as template
+/// division by zero is undefined
+template <ExprType ET, typename F>
+vector<uint64_t> unlessZero(ET const& divisor, F const& f) {
+  if (divisor == Value<1, false> { 0 })
+    return {};
+  return f();
+}
+
+/// Run an interpreted program on the given inputs, returning the output
+/// limbs
+vector<vector<uint64_t>> run(ir::Program const& program,
+                             ir::Interpreter& interpreter,
+                             vector<vector<uint64_t>> const& inputs) {
+  vector<uint64_t const*> inputPtrs;
+  for (auto const& input : inputs)
+    inputPtrs.push_back(input.data());
+  vector<vector<uint64_t>> outputs;
+  vector<uint64_t*> outputPtrs;
+  for (uint32_t id : program.outputs())
+    outputs.emplace_back(
+        detail::limbCount(program.nodes()[id].format.width));
+  for (auto& output : outputs)
+    outputPtrs.push_back(output.data());
+  interpreter(inputPtrs.data(), outputPtrs.data());
+  return outputs;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(MatchesTemplates) {
+  ir::Program program;
+  auto a = program.input({ 32, true });
+  auto b = program.input({ 17, false });
+  auto c = program.input({ 200, true });
+  auto d = program.input({ 150, false });
+  auto e = program.input({ 64, false });
+  auto ab = program.sum(program.prod(a, b), a);
+  auto diff = program.sub(b, a);
+  program.output(ab);
+  program.output(program.div(ab, diff));
+  program.output(program.mod(ab, diff));
+  program.output(program.div(c, d));
+  program.output(program.mod(c, d));
+  program.output(program.div(d, c));
+  program.output(program.div(d, e));
+  program.output(program.mod(e, b));
+  program.output(program.prod(c, d));
+  program.output(program.slice(c, 170, 40));
+  program.output(program.dynSlice(c, 32, 150));
+  program.output(program.xorReduce(d));
+  program.output(program.andReduce(program.slice(a, 3, 0)));
+  program.output(program.norReduce(e));
+  program.output(program.orReduce(b));
+  program.output(program.less(c, d));
+  program.output(program.greaterEqual(a, b));
+  program.output(program.equal(d, d));
+  program.output(
+      program.bitwiseXor(program.bitInvert(d), program.slice(c, 149, 0)));
+  program.output(program.zeroExtend(c, 300));
+  program.output(program.signExtend(c, 300));
+  program.output(program.adapt(c, { 70, false }));
+
+  ir::Interpreter interpreter { program };
+  for (int i = 0; i < 300; ++i) {
+    auto const va = randomValue<32, true>();
+    auto const vb = randomValue<17, false>();
+    auto const vc = randomValue<200, true>();
+    auto const vd = randomValue<150, false>();
+    auto const ve = randomValue<64, false>();
+    auto const outputs =
+        run(program, interpreter,
+            { limbsOf(va), limbsOf(vb), limbsOf(vc), limbsOf(vd),
+              limbsOf(ve) });
+    auto const vab = va * vb + va;
+    auto const vdiff = vb - va;
+    vector<vector<uint64_t>> const expected {
+      limbsOf(vab),
+      unlessZero(vdiff, [&] { return limbsOf(vab / vdiff); }),
+      unlessZero(vdiff, [&] { return limbsOf(vab % vdiff); }),
+      unlessZero(vd, [&] { return limbsOf(vc / vd); }),
+      unlessZero(vd, [&] { return limbsOf(vc % vd); }),
+      unlessZero(vc, [&] { return limbsOf(vd / vc); }),
+      unlessZero(ve, [&] { return limbsOf(vd / ve); }),
+      unlessZero(vb, [&] { return limbsOf(ve % vb); }),
+      limbsOf(vc * vd),
+      limbsOf(slice<170, 40>(vc)),
+      limbsOf(dynSlice<32>(vc, 150)),
+      limbsOf(xorReduce(vd)),
+      limbsOf(andReduce(slice<3, 0>(va))),
+      limbsOf(norReduce(ve)),
+      limbsOf(orReduce(vb)),
+      { vc < vd },
+      { va >= vb },
+      { 1 },
+      limbsOf(~vd ^ slice<149, 0>(vc)),
+      limbsOf(zeroExtendToWidth<300>(vc)),
+      limbsOf(signExtendToWidth<300>(vc)),
+      limbsOf(Value<70, false> { vc })
+    };
+    for (size_t j = 0; j < expected.size(); ++j) {
+      if (expected[j].empty())
+        continue;
+      BOOST_TEST_CONTEXT("output " << j) {
+        BOOST_REQUIRE(outputs[j] == expected[j]);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DivisionByZero) {
+  ir::Program program;
+  auto a = program.input({ 64, false });
+  auto b = program.input({ 8, true });
+  auto c = program.input({ 200, true });
+  auto zero = program.constant({ 8, false }, 0);
+  program.output(program.div(a, zero));
+  program.output(program.mod(a, zero));
+  program.output(program.div(b, program.constant({ 8, true }, 0)));
+  program.output(program.div(c, zero));
+  program.output(program.mod(c, zero));
+
+  ir::Interpreter interpreter { program };
+  auto const outputs = run(
+      program, interpreter,
+      { { 1234 }, { uint64_t(-5) }, { uint64_t(-7), ~0ull, ~0ull, ~0ull } });
+  BOOST_REQUIRE(outputs[0] == (vector<uint64_t> { ~0ull }));
+  BOOST_REQUIRE(outputs[1] == (vector<uint64_t> { 1234 % 256 }));
+  BOOST_REQUIRE(outputs[2] == (vector<uint64_t> { ~0ull }));
+  BOOST_REQUIRE(outputs[3] == (vector<uint64_t>(4, ~0ull)));
+  BOOST_REQUIRE(outputs[4] == (vector<uint64_t> { uint64_t(-7) }));
+}
+
+BOOST_AUTO_TEST_CASE(RegisterReuse) {
+  ir::Program program;
+  auto a = program.input({ 256, false });
+  auto acc = a;
+  for (int i = 0; i < 16; ++i)
+    acc = program.slice(program.sum(acc, a), 255, 0);
+  program.output(acc);
+  // Unused nodes are not evaluated
+  program.prod(a, a);
+
+  ir::Interpreter interpreter { program };
+  BOOST_REQUIRE(interpreter.arenaSize() <= 4 * 4);
+  auto const outputs = run(program, interpreter, { { 3, 0, 0, 1 } });
+  BOOST_REQUIRE(outputs[0] == (vector<uint64_t> { 51, 0, 0, 17 }));
+}
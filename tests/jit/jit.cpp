@@ -0,0 +1,306 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Jit
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+#include "apintext/interpreter.hpp"
+#include "apintext/jit.hpp"
+#include "apintext/runtime_ir.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+/// Limbs of the value of expr, extended to the limb boundary
+template <ExprType ET> vector<uint64_t> limbsOf(ET const& expr) {
+  constexpr uint32_t bits = 64 * detail::limbCount(ET::width);
+  Value<bits, ET::signedness> const extended { expr };
+  auto const limbs = detail::toLimbs<bits>(
+      static_cast<ap_repr<bits, false>>(extended.compute()));
+  return { limbs.begin(), limbs.end() };
+}
+
+/// Limbs computed by f, or none when the divisor is zero, as template
+/// division by zero is undefined
+template <ExprType ET, typename F>
+vector<uint64_t> unlessZero(ET const& divisor, F const& f) {
+  if (divisor == Value<1, false> { 0 })
+    return {};
+  return f();
+}
+
+/// Run a compiled program on the given inputs, returning the output limbs
+vector<vector<uint64_t>> run(ir::Program const& program,
+                             ir::CompiledProgram const& compiled,
+                             vector<vector<uint64_t>> const& inputs) {
+  vector<uint64_t const*> inputPtrs;
+  for (auto const& input : inputs)
+    inputPtrs.push_back(input.data());
+  vector<vector<uint64_t>> outputs;
+  vector<uint64_t*> outputPtrs;
+  for (uint32_t id : program.outputs())
+    outputs.emplace_back(
+        detail::limbCount(program.nodes()[id].format.width));
+  for (auto& output : outputs)
+    outputPtrs.push_back(output.data());
+  compiled(inputPtrs.data(), outputPtrs.data());
+  return outputs;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(MatchesTemplates) {
+  ir::Program program;
+  auto a = program.input({ 32, true });
+  auto b = program.input({ 17, false });
+  auto c = program.input({ 200, true });
+  auto d = program.input({ 150, false });
+  auto e = program.input({ 64, false });
+  auto ab = program.sum(program.prod(a, b), a);
+  auto diff = program.sub(b, a);
+  program.output(ab);
+  program.output(program.div(ab, diff));
+  program.output(program.mod(ab, diff));
+  program.output(program.div(c, d));
+  program.output(program.mod(c, d));
+  program.output(program.div(d, c));
+  program.output(program.div(d, e));
+  program.output(program.mod(e, b));
+  program.output(program.prod(c, d));
+  program.output(program.slice(c, 170, 40));
+  program.output(program.dynSlice(c, 32, 150));
+  program.output(program.xorReduce(d));
+  program.output(program.andReduce(program.slice(a, 3, 0)));
+  program.output(program.norReduce(e));
+  program.output(program.orReduce(b));
+  program.output(program.less(c, d));
+  program.output(program.greaterEqual(a, b));
+  program.output(program.equal(d, d));
+  program.output(
+      program.bitwiseXor(program.bitInvert(d), program.slice(c, 149, 0)));
+  program.output(program.zeroExtend(c, 300));
+  program.output(program.signExtend(c, 300));
+  program.output(program.adapt(c, { 70, false }));
+
+  ir::Jit jit;
+  auto const compiled = jit.compile(program);
+  for (int i = 0; i < 300; ++i) {
+    auto const va = randomValue<32, true>();
+    auto const vb = randomValue<17, false>();
+    auto const vc = randomValue<200, true>();
+    auto const vd = randomValue<150, false>();
+    auto const ve = randomValue<64, false>();
+    auto const outputs =
+        run(program, compiled,
+            { limbsOf(va), limbsOf(vb), limbsOf(vc), limbsOf(vd),
+              limbsOf(ve) });
+    auto const vab = va * vb + va;
+    auto const vdiff = vb - va;
+    vector<vector<uint64_t>> const expected {
+      limbsOf(vab),
+      unlessZero(vdiff, [&] { return limbsOf(vab / vdiff); }),
+      unlessZero(vdiff, [&] { return limbsOf(vab % vdiff); }),
+      unlessZero(vd, [&] { return limbsOf(vc / vd); }),
+      unlessZero(vd, [&] { return limbsOf(vc % vd); }),
+      unlessZero(vc, [&] { return limbsOf(vd / vc); }),
+      unlessZero(ve, [&] { return limbsOf(vd / ve); }),
+      unlessZero(vb, [&] { return limbsOf(ve % vb); }),
+      limbsOf(vc * vd),
+      limbsOf(slice<170, 40>(vc)),
+      limbsOf(dynSlice<32>(vc, 150)),
+      limbsOf(xorReduce(vd)),
+      limbsOf(andReduce(slice<3, 0>(va))),
+      limbsOf(norReduce(ve)),
+      limbsOf(orReduce(vb)),
+      { vc < vd },
+      { va >= vb },
+      { 1 },
+      limbsOf(~vd ^ slice<149, 0>(vc)),
+      limbsOf(zeroExtendToWidth<300>(vc)),
+      limbsOf(signExtendToWidth<300>(vc)),
+      limbsOf(Value<70, false> { vc })
+    };
+    for (size_t j = 0; j < expected.size(); ++j) {
+      if (expected[j].empty())
+        continue;
+      BOOST_TEST_CONTEXT("output " << j) {
+        BOOST_REQUIRE(outputs[j] == expected[j]);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DivisionByZero) {
+  ir::Program program;
+  auto a = program.input({ 64, false });
+  auto b = program.input({ 8, true });
+  auto c = program.input({ 200, true });
+  auto zero = program.constant({ 8, false }, 0);
+  program.output(program.div(a, zero));
+  program.output(program.mod(a, zero));
+  program.output(program.div(b, program.constant({ 8, true }, 0)));
+  program.output(program.div(c, zero));
+  program.output(program.mod(c, zero));
+
+  ir::Jit jit;
+  auto const outputs = run(
+      program, jit.compile(program),
+      { { 1234 }, { uint64_t(-5) }, { uint64_t(-7), ~0ull, ~0ull, ~0ull } });
+  BOOST_REQUIRE(outputs[0] == (vector<uint64_t> { ~0ull }));
+  BOOST_REQUIRE(outputs[1] == (vector<uint64_t> { 1234 % 256 }));
+  BOOST_REQUIRE(outputs[2] == (vector<uint64_t> { ~0ull }));
+  BOOST_REQUIRE(outputs[3] == (vector<uint64_t>(4, ~0ull)));
+  BOOST_REQUIRE(outputs[4] == (vector<uint64_t> { uint64_t(-7) }));
+}
+
+BOOST_AUTO_TEST_CASE(MidWidthDivision) {
+  // Native divisions of 65 to 128 bits call the compiler runtime, which the
+  // JIT does not link
+  ir::Program program;
+  auto a = program.input({ 100, true });
+  auto b = program.input({ 65, false });
+  auto c = program.input({ 128, false });
+  program.output(program.div(a, b));
+  program.output(program.mod(a, b));
+  program.output(program.div(c, b));
+  program.output(program.mod(c, a));
+
+  ir::Jit jit;
+  auto const compiled = jit.compile(program);
+  for (int i = 0; i < 300; ++i) {
+    auto const va = randomValue<100, true>();
+    auto const vb = randomValue<65, false>();
+    auto const vc = randomValue<128, false>();
+    if (va == Value<1, false> { 0 } || vb == Value<1, false> { 0 })
+      continue;
+    auto const outputs =
+        run(program, compiled, { limbsOf(va), limbsOf(vb), limbsOf(vc) });
+    vector<vector<uint64_t>> const expected { limbsOf(va / vb),
+                                              limbsOf(va % vb),
+                                              limbsOf(vc / vb),
+                                              limbsOf(vc % va) };
+    BOOST_REQUIRE(outputs == expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StructuralCache) {
+  auto build = [](uint32_t width) {
+    ir::Program program;
+    auto a = program.input({ width, false });
+    auto b = program.input({ 16, true });
+    program.output(program.prod(program.sum(a, b), program.sum(a, b)));
+    return program;
+  };
+  ir::Jit jit;
+  auto const first = build(40);
+  auto const second = build(40);
+  auto const third = build(41);
+  BOOST_REQUIRE(first == second);
+  BOOST_REQUIRE(first.structuralHash() == second.structuralHash());
+  BOOST_REQUIRE(first.nodes().size() == 4);
+  jit.compile(first);
+  jit.compile(second);
+  BOOST_REQUIRE(jit.compiledPrograms() == 1);
+  jit.compile(third);
+  BOOST_REQUIRE(jit.compiledPrograms() == 2);
+
+  ir::Program invalid;
+  auto a = invalid.input({ 8, false });
+  auto b = invalid.input({ 9, false });
+  BOOST_REQUIRE_THROW(invalid.bitwiseAnd(a, b), invalid_argument);
+  BOOST_REQUIRE_THROW(invalid.slice(a, 8, 0), invalid_argument);
+  BOOST_REQUIRE_THROW(invalid.zeroExtend(b, 9), invalid_argument);
+  BOOST_REQUIRE_THROW(invalid.input({ 0, false }), invalid_argument);
+  BOOST_REQUIRE_THROW(invalid.output({ 5 }), out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(RandomProgramsMatchInterpreter) {
+  for (int p = 0; p < 40; ++p) {
+    ir::Program program;
+    vector<ir::NodeRef> nodes;
+    vector<vector<uint64_t>> inputs;
+    for (int i = 0; i < 4; ++i) {
+      uint32_t const width = static_cast<uint32_t>(1 + next() % 260);
+      nodes.push_back(program.input({ width, (next() & 1) != 0 }));
+      inputs.emplace_back(detail::limbCount(width));
+    }
+    for (int i = 0; i < 30; ++i) {
+      auto const lhs = nodes[next() % nodes.size()];
+      auto const rhs = nodes[next() % nodes.size()];
+      auto const lf = program.format(lhs);
+      ir::NodeRef res;
+      switch (next() % 10) {
+      case 0:
+        res = program.sum(lhs, rhs);
+        break;
+      case 1:
+        res = program.sub(lhs, rhs);
+        break;
+      case 2:
+        res = program.prod(lhs, rhs);
+        break;
+      case 3:
+        res = program.div(lhs, rhs);
+        break;
+      case 4:
+        res = program.mod(lhs, rhs);
+        break;
+      case 5:
+        res = program.less(lhs, rhs);
+        break;
+      case 6:
+        res = program.adapt(rhs, lf);
+        res = program.bitwiseXor(lhs, program.bitInvert(res));
+        break;
+      case 7:
+        res = program.dynSlice(lhs, static_cast<uint32_t>(1 + next() % 100),
+                               static_cast<uint32_t>(next() % 300));
+        break;
+      case 8:
+        res = program.xorReduce(lhs);
+        break;
+      default: {
+        uint32_t const width = static_cast<uint32_t>(1 + next() % 300);
+        res = program.adapt(lhs, { width, (next() & 1) != 0 });
+        break;
+      }
+      }
+      // Keep the widths bounded
+      if (program.format(res).width > 600)
+        res = program.slice(res, 599, 0);
+      nodes.push_back(res);
+    }
+    for (size_t i = 4; i < nodes.size(); i += 3)
+      program.output(nodes[i]);
+
+    ir::Jit jit;
+    auto const compiled = jit.compile(program);
+    ir::Interpreter interpreter { program };
+    vector<uint64_t const*> inputPtrs;
+    for (auto& input : inputs)
+      inputPtrs.push_back(input.data());
+    vector<vector<uint64_t>> outputs;
+    for (uint32_t id : program.outputs())
+      outputs.emplace_back(
+          detail::limbCount(program.nodes()[id].format.width));
+    for (int r = 0; r < 20; ++r) {
+      for (auto& input : inputs)
+        for (auto& limb : input)
+          limb = (r % 4 == 0) ? next() % 3 : next();
+      auto const expected = run(program, compiled, inputs);
+      vector<uint64_t*> outputPtrs;
+      for (auto& output : outputs)
+        outputPtrs.push_back(output.data());
+      interpreter(inputPtrs.data(), outputPtrs.data());
+      BOOST_TEST_CONTEXT("program " << p << " run " << r) {
+        BOOST_REQUIRE(outputs == expected);
+      }
+    }
+  }
+}
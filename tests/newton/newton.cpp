@@ -0,0 +1,112 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Newton
+
+#include <cstdint>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+/// r should be the floor of the root of x: r^2 <= x < (r + 1)^2
+template <uint32_t w> void checkIsqrt(Value<w, false> const& x) {
+  auto const root = isqrt(x);
+  Value<decltype(root)::width, false> const r { root.compute() };
+  auto const next = r + Value<1, false> { 1 };
+  BOOST_REQUIRE(!(x < r * r));
+  BOOST_REQUIRE((x < next * next));
+}
+
+/// q should be the floor of 2^f / x: q * x <= 2^f < (q + 1) * x
+template <uint32_t f, uint32_t w> void checkRecip(Value<w, false> const& x) {
+  auto const inverse = recip<f>(x);
+  Value<f + 1, false> const q { inverse.compute() };
+  auto limbs = detail::limbs_t<detail::limbCount(f + 1)> {};
+  limbs[f / 64] = uint64_t { 1 } << (f % 64);
+  Value<f + 1, false> const one { detail::fromLimbs<f + 1>(limbs) };
+  BOOST_REQUIRE(!(one < q * x));
+  BOOST_REQUIRE((one < (q + Value<1, false> { 1 }) * x));
+}
+
+/// Random values, as well as squares, powers of two and their neighbours
+template <uint32_t w> void checkWidth() {
+  for (int i = 0; i < 300; ++i) {
+    auto const x = randomValue<w, false>();
+    checkIsqrt<w>(x);
+    if (!(x == Value<1, false> { 0 })) {
+      checkRecip<w, w>(x);
+      checkRecip<w / 2 + 3, w>(x);
+      checkRecip<2 * w, w>(x);
+    }
+    auto const half = randomValue<w / 2, false>();
+    Value<w, false> const sq { static_cast<ap_repr<w, false>>(
+        (half * half).compute()) };
+    checkIsqrt<w>(sq);
+    checkIsqrt<w>(Value<w, false> { static_cast<ap_repr<w, false>>(
+        (sq - Value<1, false> { 1 }).compute()) });
+  }
+  for (uint32_t bit = 0; bit < w; ++bit) {
+    auto const pow = Value<w, false> { ap_repr<w, false> { 1 } << bit };
+    checkIsqrt<w>(pow);
+    checkRecip<w, w>(pow);
+    checkRecip<w + 7, w>(pow);
+    if (bit > 0) {
+      auto const below = Value<w, false> { (ap_repr<w, false> { 1 } << bit) -
+                                           ap_repr<w, false> { 1 } };
+      checkIsqrt<w>(below);
+      checkRecip<w, w>(below);
+    }
+  }
+  auto const ones = Value<w, false> { ~ap_repr<w, false> { 0 } };
+  checkIsqrt<w>(ones);
+  checkRecip<w, w>(ones);
+  checkRecip<w - 1, w>(ones);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Formats) {
+  using root_t = decltype(isqrt(Value<33, false> { 0 }));
+  static_assert(root_t::width == 17 && !root_t::signedness,
+                "Roots should be half as wide as their operand");
+  static_assert(isqrt(Value<16, false> { 65535 }).compute() ==
+                    ap_repr<8, false> { 255 },
+                "Wrong square root");
+  static_assert(recip<8>(Value<8, false> { 3 }).compute() ==
+                    ap_repr<9, false> { 85 },
+                "Wrong reciprocal");
+  static_assert(recip<8>(Value<8, false> { 0 }).compute() ==
+                    ap_repr<9, false> { 511 },
+                "Reciprocal of 0 should be all ones");
+}
+
+BOOST_AUTO_TEST_CASE(ExhaustiveNarrow) {
+  for (uint32_t i = 0; i < (1 << 16); ++i) {
+    Value<16, false> const x { i };
+    checkIsqrt<16>(x);
+    if (i != 0) {
+      checkRecip<16, 16>(x);
+      checkRecip<5, 16>(x);
+      checkRecip<24, 16>(x);
+    }
+  }
+  for (uint32_t i = 0; i < 8; ++i) {
+    checkIsqrt<3>(Value<3, false> { i });
+    if (i != 0)
+      checkRecip<1, 3>(Value<3, false> { i });
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Wide) {
+  checkWidth<32>();
+  checkWidth<64>();
+  checkWidth<65>();
+  checkWidth<128>();
+  checkWidth<200>();
+  checkWidth<256>();
+}
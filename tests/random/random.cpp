@@ -0,0 +1,172 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Random
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+
+using namespace std;
+
+using namespace apintext;
+
+namespace {
+/// Bits set in each position over the values
+template <uint32_t w, bool s>
+array<size_t, w> bitCounts(vector<Value<w, s>> const& values) {
+  array<size_t, w> res {};
+  for (auto const& value : values) {
+    auto const limbs =
+        detail::toLimbs<w>(static_cast<ap_repr<w, false>>(value.compute()));
+    for (uint32_t i = 0; i < w; ++i)
+      res[i] += (limbs[i / 64] >> (i % 64)) & 1;
+  }
+  return res;
+}
+
+template <uint32_t w, bool s> void checkBalancedBits() {
+  vector<Value<w, s>> values(100000);
+  randomFill(values, 42);
+  for (size_t count : bitCounts(values))
+    BOOST_REQUIRE(count > 48500 && count < 51500);
+}
+
+/// Edge cases of the format, as EdgeBiased draws them
+template <uint32_t w, bool s> set<Value<w, s>> edgeCases() {
+  using u_t = ap_repr<w, false>;
+  set<u_t> patterns { u_t { 0 }, u_t { 1 }, ~u_t { 0 } };
+  patterns.insert(s ? u_t { 1 } << (w - 1) : u_t { 0 });
+  patterns.insert(s ? ~u_t { 0 } >> 1 : ~u_t { 0 });
+  for (uint32_t i = 0; i < w; ++i)
+    patterns.insert(u_t { 1 } << i);
+  set<Value<w, s>> res;
+  for (auto const& pattern : patterns)
+    res.insert(Value<w, s> { static_cast<ap_repr<w, s>>(pattern) });
+  return res;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PhiloxKnownAnswers) {
+  using block_t = array<uint32_t, 4>;
+  BOOST_REQUIRE((detail::philox4x32({ 0, 0, 0, 0 }, 0) ==
+                 block_t { 0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8 }));
+  BOOST_REQUIRE(
+      (detail::philox4x32({ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+                          0xFFFFFFFFFFFFFFFF) ==
+       block_t { 0x408F276D, 0x41C83B0E, 0xA20BC7C6, 0x6D5451FD }));
+  BOOST_REQUIRE(
+      (detail::philox4x32({ 0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344 },
+                          0x299F31D0A4093822) ==
+       block_t { 0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1 }));
+}
+
+BOOST_AUTO_TEST_CASE(UniformBits) {
+  checkBalancedBits<13, true>();
+  checkBalancedBits<64, false>();
+  checkBalancedBits<200, true>();
+
+  vector<Value<200, true>> values(1000), others(1000);
+  randomFill(values, 1);
+  randomFill(others, 2);
+  BOOST_REQUIRE(values != others);
+}
+
+BOOST_AUTO_TEST_CASE(ReproducibleAcrossThreadCounts) {
+  vector<Value<77, true>> expected(100003);
+  randomFill(expected, 7, EdgeBiased {});
+  for (size_t threads : { 1, 3, 4 }) {
+    ThreadPool pool { threads };
+    vector<Value<77, true>> values(expected.size());
+    randomFill(pool, values, 7, EdgeBiased {});
+    BOOST_REQUIRE(values == expected);
+  }
+
+  // Filling the halves separately gives the same sequence
+  vector<Value<77, true>> first(45678), second(expected.size() - 45678);
+  randomFill(first, 7, EdgeBiased {});
+  randomFill(second, 7, EdgeBiased {}, first.size());
+  first.insert(first.end(), second.begin(), second.end());
+  BOOST_REQUIRE(first == expected);
+}
+
+BOOST_AUTO_TEST_CASE(UniformRange) {
+  vector<Value<16, true>> values(100000);
+  randomFill(values, 3, UniformIn<16, true> { -300, 1000 });
+  vector<size_t> hits(1301, 0);
+  for (auto const& value : values) {
+    auto const v = static_cast<int64_t>(value);
+    BOOST_REQUIRE(v >= -300 && v <= 1000);
+    ++hits[v + 300];
+  }
+  for (size_t count : hits)
+    BOOST_REQUIRE(count > 30 && count < 130);
+
+  // Full range, and a small range of a wide format
+  randomFill(values, 4,
+             UniformIn<16, true> { Value<16, true> { -32768 },
+                                   Value<16, true> { 32767 } });
+  BOOST_REQUIRE((values != vector<Value<16, true>>(values.size())));
+  Value<100, false> const low { ap_repr<100, false> { 1 } << 90 };
+  vector<Value<100, false>> wide(1000);
+  randomFill(wide, 5,
+             UniformIn<100, false> { low, low + Value<3, false> { 5 } });
+  set<Value<100, false>> seen(wide.begin(), wide.end());
+  BOOST_REQUIRE_EQUAL(seen.size(), 6);
+  BOOST_REQUIRE(*seen.begin() == low);
+
+  BOOST_CHECK_THROW((UniformIn<8, true> { 5, -5 }), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(EdgeBiasedSampling) {
+  auto const edges = edgeCases<64, true>();
+  vector<Value<64, true>> values(100000);
+  randomFill(values, 8, EdgeBiased { 1. });
+  for (auto const& value : values)
+    BOOST_REQUIRE(edges.count(value) == 1);
+  BOOST_REQUIRE_EQUAL(set(values.begin(), values.end()).size(), edges.size());
+
+  randomFill(values, 9, EdgeBiased { 0.5 });
+  size_t edgeCount = 0;
+  for (auto const& value : values)
+    edgeCount += edges.count(value);
+  BOOST_REQUIRE(edgeCount > 49000 && edgeCount < 51000);
+
+  auto const unsignedEdges = edgeCases<5, false>();
+  vector<Value<5, false>> narrow(1000);
+  randomFill(narrow, 10, EdgeBiased { 1. });
+  for (auto const& value : narrow)
+    BOOST_REQUIRE(unsignedEdges.count(value) == 1);
+
+  BOOST_CHECK_THROW(EdgeBiased { 1.5 }, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(PackedFill) {
+  constexpr uint64_t count = 10000;
+  TraceHeader const header { 37, true, count };
+  vector<Value<37, true>> expected(count);
+  randomFill(expected, 11, EdgeBiased {}, 100);
+
+  ThreadPool pool { 4 };
+  vector<uint64_t> words(header.payloadWords()), pooled(words.size());
+  randomFillPacked<37, true>(words, count, 11, EdgeBiased {}, 100);
+  randomFillPacked<37, true>(pool, pooled, count, 11, EdgeBiased {}, 100);
+  BOOST_REQUIRE(words == pooled);
+
+  vector<byte> trace(header.traceSize());
+  auto const encoded = detail::encodeHeader(header);
+  memcpy(trace.data(), encoded.data(), encoded.size());
+  memcpy(trace.data() + TraceHeader::size, words.data(), 8 * words.size());
+  TraceView<37, true> const view { trace };
+  for (uint64_t i = 0; i < count; ++i)
+    BOOST_REQUIRE((Value<37, true> { view[i] } == expected[i]));
+
+  BOOST_CHECK_THROW((randomFillPacked<37, true>(
+                        span { words }.first(10), count, 11)),
+                    std::invalid_argument);
+}
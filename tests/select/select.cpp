@@ -0,0 +1,126 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Select
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+template <ExprType ET> int64_t valueOf(ET const& expr) {
+  return static_cast<int64_t>(expr.compute());
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Formats) {
+  Value<5, true> const a { -3 };
+  Value<4, false> const b { 9 };
+  using select_t = decltype(select(Value<1, false> { 1 }, a, b));
+  static_assert(select_t::width == 6 && select_t::signedness,
+                "Select should produce the tight overset of its operands");
+  using abs_t = decltype(abs(a));
+  static_assert(abs_t::width == 6 && abs_t::signedness,
+                "Absolute value of a signed value should be one bit wider");
+  static_assert(decltype(abs(b))::width == 4,
+                "Absolute value of an unsigned value should keep its width");
+  static_assert(abs(Value<8, true> { -128 }).compute() ==
+                    ap_repr<9, true> { 128 },
+                "Wrong absolute value of the most negative value");
+}
+
+BOOST_AUTO_TEST_CASE(UnqualifiedCalls) {
+  // With using namespace std, operands of the same type should still build
+  // the branch-free nodes instead of calling std::min and std::max
+  Value<8, true> const a { -5 };
+  Value<8, true> const b { 7 };
+  using value_t = Value<8, true>;
+  static_assert(is_same_v<decltype(min(a, b)), ExprMin<value_t, value_t>>);
+  static_assert(is_same_v<decltype(max(a, b)), ExprMax<value_t, value_t>>);
+  static_assert(is_same_v<decltype(abs(a)), ExprAbs<value_t>>);
+  BOOST_REQUIRE_EQUAL(valueOf(min(a, b)), -5);
+  BOOST_REQUIRE_EQUAL(valueOf(max(a, b)), 7);
+  BOOST_REQUIRE_EQUAL(valueOf(abs(a)), 5);
+}
+
+BOOST_AUTO_TEST_CASE(ExhaustiveNarrow) {
+  for (int64_t i = -16; i < 16; ++i) {
+    for (uint64_t j = 0; j < 16; ++j) {
+      Value<5, true> const a { i };
+      Value<4, false> const b { j };
+      int64_t const bVal = static_cast<int64_t>(j);
+      BOOST_REQUIRE_EQUAL(valueOf(min(a, b)), std::min(i, bVal));
+      BOOST_REQUIRE_EQUAL(valueOf(max(a, b)), std::max(i, bVal));
+      BOOST_REQUIRE_EQUAL(valueOf(abs(a)), std::abs(i));
+      BOOST_REQUIRE_EQUAL(valueOf(abs(b)), bVal);
+      BOOST_REQUIRE_EQUAL(valueOf(select(Value<1, false> { 1 }, a, b)), i);
+      BOOST_REQUIRE_EQUAL(valueOf(select(Value<1, false> { 0 }, a, b)), bVal);
+      BOOST_REQUIRE_EQUAL(valueOf(select(ct::lessThan(a, b), b, a)),
+                          std::max(i, bVal));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Wide) {
+  for (int i = 0; i < 500; ++i) {
+    auto const a = randomValue<200, true>();
+    auto const b = randomValue<150, true>();
+    auto const c = randomValue<180, false>();
+    auto const minAB = min(a, b);
+    auto const maxAB = max(a, b);
+    if (a < b)
+      BOOST_REQUIRE((minAB == a && maxAB == b));
+    else
+      BOOST_REQUIRE((minAB == b && maxAB == a));
+    auto const minAC = min(a, c);
+    auto const maxAC = max(c, a);
+    if (a < c)
+      BOOST_REQUIRE((minAC == a && maxAC == c));
+    else
+      BOOST_REQUIRE((minAC == c && maxAC == a));
+    auto const absolute = abs(a);
+    if (a < Value<1, false> { 0 })
+      BOOST_REQUIRE((absolute + a == Value<1, false> { 0 }));
+    else
+      BOOST_REQUIRE((absolute == a));
+    auto const chosen = select(getBit<0>(c), a, c);
+    if (getBit<0>(c) == Value<1, false> { 1 })
+      BOOST_REQUIRE((chosen == a));
+    else
+      BOOST_REQUIRE((chosen == c));
+  }
+}
+
+/// Saturation of a sum to a signed 8-bit range, evaluated in batch
+BOOST_AUTO_TEST_CASE(BatchSaturation) {
+  Placeholder<0, 8, true> a;
+  Placeholder<1, 8, true> b;
+  auto const shape = slice<7, 0>(
+      max(min(a + b, Value<8, true> { 127 }),
+                    Value<8, true> { -128 }));
+  size_t const count = 1000;
+  vector<Value<8, true>> as(count), bs(count);
+  vector<int16_t> expected(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto const aVal = static_cast<int8_t>(next());
+    auto const bVal = static_cast<int8_t>(next());
+    as[i] = Value<8, true> { aVal };
+    bs[i] = Value<8, true> { bVal };
+    expected[i] = std::clamp(aVal + bVal, -128, 127);
+  }
+  vector<res_t<decltype(shape)>> out(count);
+  evaluate(shape, as, bs, out);
+  for (size_t i = 0; i < count; ++i)
+    BOOST_REQUIRE_EQUAL(static_cast<int8_t>(static_cast<uint8_t>(out[i])),
+                        expected[i]);
+}
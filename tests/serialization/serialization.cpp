@@ -0,0 +1,131 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Serialization
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+template <uint32_t w, bool s> vector<Value<w, s>> randomValues(size_t count) {
+  vector<Value<w, s>> res;
+  for (size_t i = 0; i < count; ++i)
+    res.emplace_back(Value<64, false> { next() } * Value<64, false> { next() } *
+                     Value<64, false> { next() } *
+                     Value<64, false> { next() });
+  return res;
+}
+
+vector<byte> toBytes(string const& str) {
+  auto const* data = reinterpret_cast<byte const*>(str.data());
+  return { data, data + str.size() };
+}
+} // namespace
+
+template <uint32_t w, bool s> void checkRoundTrip(size_t count) {
+  auto const values = randomValues<w, s>(count);
+  ostringstream out;
+  {
+    TraceWriter<w, s> writer { out };
+    writer.writeAll(values);
+    BOOST_REQUIRE_EQUAL(writer.size(), count);
+  }
+  auto const bytes = toBytes(out.str());
+  auto const header = readTraceHeader(bytes);
+  BOOST_REQUIRE_EQUAL(header.width, w);
+  BOOST_REQUIRE_EQUAL(header.signedness, s);
+  BOOST_REQUIRE_EQUAL(header.count, count);
+  BOOST_REQUIRE_EQUAL(bytes.size(),
+                      TraceHeader::size + (w * count + 63) / 64 * 8);
+
+  TraceView<w, s> view { bytes };
+  BOOST_REQUIRE_EQUAL(view.size(), count);
+  size_t i = 0;
+  for (auto const& element : view) {
+    static_assert(ExprType<decay_t<decltype(element)>>);
+    BOOST_REQUIRE(element.compute() == values[i].compute());
+    ++i;
+  }
+  BOOST_REQUIRE_EQUAL(i, count);
+}
+
+BOOST_AUTO_TEST_CASE(RoundTrip) {
+  checkRoundTrip<1, false>(1000);
+  checkRoundTrip<7, true>(1000);
+  checkRoundTrip<13, false>(0);
+  checkRoundTrip<13, false>(5);
+  checkRoundTrip<64, true>(3000);
+  checkRoundTrip<65, false>(3000);
+  checkRoundTrip<200, true>(3000);
+}
+
+BOOST_AUTO_TEST_CASE(ElementsAreExpressions) {
+  vector<Value<12, true>> values { -3, 7, 2047, -2048 };
+  ostringstream out;
+  TraceWriter<12, true> writer { out };
+  writer.writeAll(values);
+  writer.close();
+  auto const bytes = toBytes(out.str());
+  TraceView<12, true> view { bytes };
+  Value<13, true> sum = view[0] + view[1];
+  BOOST_REQUIRE_EQUAL(getAs<int>(sum), 4);
+  BOOST_REQUIRE_EQUAL(getAs<int>(view[2] * view[3]), -2047 * 2048);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidTraces) {
+  ostringstream out;
+  {
+    TraceWriter<20, false> writer { out };
+    writer.writeAll(randomValues<20, false>(10));
+  }
+  auto bytes = toBytes(out.str());
+  BOOST_REQUIRE_NO_THROW((TraceView<20, false> { bytes }));
+  BOOST_REQUIRE_THROW((TraceView<21, false> { bytes }), invalid_argument);
+  BOOST_REQUIRE_THROW((TraceView<20, true> { bytes }), invalid_argument);
+  auto truncated = span { bytes }.first(bytes.size() - 1);
+  BOOST_REQUIRE_THROW((TraceView<20, false> { truncated }),
+                      invalid_argument);
+  bytes[0] = byte { 0 };
+  BOOST_REQUIRE_THROW(readTraceHeader(bytes), invalid_argument);
+}
+
+#ifdef APINTEXT_HAS_MMAP
+BOOST_AUTO_TEST_CASE(MappedFile) {
+  auto const values = randomValues<100, true>(5000);
+  string const path = "serialization_test.trace";
+  {
+    ofstream out { path, ios::binary };
+    TraceWriter<100, true> writer { out };
+    for (auto const& value : values)
+      writer.write(value);
+  }
+  {
+    MappedTrace<100, true> trace { path };
+    auto const view = trace.view();
+    BOOST_REQUIRE_EQUAL(view.size(), values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+      BOOST_REQUIRE(view[i].compute() == values[i].compute());
+    BOOST_REQUIRE_THROW((MappedTrace<100, false> { path }.view()),
+                        invalid_argument);
+  }
+  remove(path.c_str());
+  BOOST_REQUIRE_THROW((MappedTrace<100, true> { path }), system_error);
+}
+#endif
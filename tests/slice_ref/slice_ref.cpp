@@ -0,0 +1,128 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SliceRef
+
+#include <cstdint>
+#include <type_traits>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+template <uint32_t w, bool s> auto bitsOf(Value<w, s> const& value) {
+  return detail::toLimbs<w>(static_cast<ap_repr<w, false>>(value.compute()));
+}
+
+/// Assign a random slice [lo, hi] of value, and check it against a bit by
+/// bit update of its limbs
+template <uint32_t hi, uint32_t lo, uint32_t w, bool s>
+void checkSlice(Value<w, s>& value) {
+  auto expected = bitsOf(value);
+  auto const src = uniformValue<hi - lo + 1, false>();
+  auto const srcBits = bitsOf(src);
+  for (uint32_t i = lo; i <= hi; ++i) {
+    uint64_t const bit = (srcBits[(i - lo) / 64] >> ((i - lo) % 64)) & 1;
+    expected[i / 64] &= ~(uint64_t { 1 } << (i % 64));
+    expected[i / 64] |= bit << (i % 64);
+  }
+  sliceRef<hi, lo>(value) = src;
+  BOOST_REQUIRE(bitsOf(value) == expected);
+  BOOST_REQUIRE((sliceRef<hi, lo>(value) == src));
+  Value<w, s> const constValue { value };
+  BOOST_REQUIRE((slice<hi, lo>(value) == slice<hi, lo>(constValue)));
+}
+
+/// Expression built on a view of a local value, which is destroyed
+auto incrementedField(Value<100, false> value) {
+  return sliceRef<79, 40>(value) + Value<1, false> { 1 };
+}
+
+constexpr Value<100, false> constantUpdate() {
+  Value<100, false> value { 0 };
+  sliceRef<79, 40>(value) = Value<40, false> { 0xABCDEF0123 };
+  bitRef<99>(value) = true;
+  bitRef<40>(value) = false;
+  return value;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(NarrowSlices) {
+  Value<32, false> value { 0x12345678 };
+  sliceRef<15, 8>(value) = Value<8, false> { 0xAB };
+  BOOST_REQUIRE(getAs<uint32_t>(value) == 0x1234AB78);
+  sliceRef<31, 28>(value) = 0xF;
+  BOOST_REQUIRE(getAs<uint32_t>(value) == 0xF234AB78);
+  bitRef<0>(value) = true;
+  bitRef<31>(value) = Value<8, false> { 2 };
+  BOOST_REQUIRE(getAs<uint32_t>(value) == 0x7234AB79);
+  BOOST_REQUIRE(getAs<uint32_t>(sliceRef<11, 4>(value)) == 0xB7);
+  BOOST_REQUIRE(getAs<uint32_t>(bitRef<0>(value)) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(WideSlices) {
+  for (int i = 0; i < 100; ++i) {
+    auto value = uniformValue<256, false>();
+    checkSlice<63, 0>(value);
+    checkSlice<127, 64>(value);
+    checkSlice<130, 60>(value);
+    checkSlice<255, 3>(value);
+    checkSlice<200, 200>(value);
+    checkSlice<255, 255>(value);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SignedSlices) {
+  for (int i = 0; i < 100; ++i) {
+    auto value = uniformValue<200, true>();
+    checkSlice<199, 190>(value);
+    checkSlice<199, 0>(value);
+    checkSlice<140, 70>(value);
+    checkSlice<199, 199>(value);
+  }
+  Value<200, true> value { 0 };
+  bitRef<199>(value) = true;
+  BOOST_REQUIRE((value < Value<1, false> { 0 }));
+  sliceRef<199, 150>(value) = Value<50, false> { 0 };
+  BOOST_REQUIRE((value == Value<1, false> { 0 }));
+}
+
+BOOST_AUTO_TEST_CASE(ConstantEvaluation) {
+  constexpr auto value = constantUpdate();
+  static_assert(getAs<uint64_t>(slice<79, 40>(value)) == 0xABCDEF0122);
+  static_assert(getAs<int>(getBit<99>(value)) == 1);
+  BOOST_REQUIRE(getAs<uint64_t>(slice<99, 64>(value)) == 0x80000ABCD);
+}
+
+BOOST_AUTO_TEST_CASE(ViewsAsOperands) {
+  Value<100, false> value { 0x1234 };
+  auto const sum = sliceRef<15, 0>(value) + Value<4, false> { 1 };
+  auto const flipped = ~bitRef<4>(value);
+  static_assert(
+      is_same_v<decay_t<decltype(sum)>,
+                ExprSum<SliceExpr<15, 0, Value<100, false>>, Value<4, false>>>);
+  value = Value<100, false> { 0 };
+  // The operands are slices of a copy of the value
+  BOOST_REQUIRE(getAs<uint32_t>(sum) == 0x1235);
+  BOOST_REQUIRE(getAs<uint32_t>(flipped) == 0);
+
+  Value<100, false> field { 0 };
+  sliceRef<79, 40>(field) = Value<40, false> { 41 };
+  BOOST_REQUIRE(getAs<uint32_t>(incrementedField(field)) == 42);
+}
+
+BOOST_AUTO_TEST_CASE(SlicesCopyTheirSource) {
+  // slice() of a non-const value still reads a copy of it
+  Value<16, false> value { 0x1234 };
+  auto const low = slice<7, 0>(value);
+  auto const top = getBit<12>(value);
+  value = Value<16, false> { 0xABCD };
+  BOOST_REQUIRE(getAs<uint32_t>(low) == 0x34);
+  BOOST_REQUIRE(getAs<uint32_t>(top) == 1);
+  BOOST_REQUIRE(getAs<uint32_t>(sliceRef<7, 0>(value)) == 0xCD);
+}
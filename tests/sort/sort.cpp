@@ -0,0 +1,165 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Sort
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+struct Record {
+  Value<128, false> bits;
+  uint32_t idx;
+};
+
+constexpr auto fieldKey = [](Record const& record) {
+  return slice<100, 37>(record.bits);
+};
+
+vector<Record> randomRecords(size_t count) {
+  vector<Record> res(count);
+  for (size_t i = 0; i < count; ++i) {
+    // Few distinct keys, to check that equal keys keep their order
+    res[i].bits = randomValue<128, false>();
+    if (next() % 2 == 0)
+      res[i].bits = slice<127, 0>(res[i].bits) & Value<128, false> { 0xF };
+    res[i].idx = static_cast<uint32_t>(i);
+  }
+  return res;
+}
+
+vector<Record> stableSorted(vector<Record> records) {
+  stable_sort(records.begin(), records.end(),
+              [](Record const& a, Record const& b) {
+                return fieldKey(a) < fieldKey(b);
+              });
+  return records;
+}
+
+bool sameRecords(vector<Record> const& a, vector<Record> const& b) {
+  return equal(a.begin(), a.end(), b.begin(), b.end(),
+               [](Record const& x, Record const& y) {
+                 return x.idx == y.idx && x.bits == y.bits;
+               });
+}
+
+/// By the 0-1 principle, sorting networks sorting all the sequences of
+/// zeros and ones sort all sequences
+template <size_t N> void checkNetwork() {
+  for (uint32_t pattern = 0; pattern < (uint32_t { 1 } << N); ++pattern) {
+    array<Value<1, false>, N> bits;
+    for (size_t i = 0; i < N; ++i)
+      bits[i] = Value<1, false> { (pattern >> i) & 1 };
+    networkSort(bits);
+    auto const ones = static_cast<size_t>(popcount(pattern));
+    for (size_t i = 0; i < N; ++i)
+      BOOST_REQUIRE_EQUAL(static_cast<uint32_t>(bits[i]), i >= N - ones);
+  }
+}
+
+template <size_t N, uint32_t w, bool s> void checkRandomNetwork() {
+  for (int iter = 0; iter < 1000; ++iter) {
+    array<Value<w, s>, N> values;
+    for (auto& value : values)
+      value = randomValue<w, s>();
+    auto expected = values;
+    sort(expected.begin(), expected.end(),
+         [](auto const& a, auto const& b) { return a < b; });
+    networkSort(values);
+    BOOST_REQUIRE((values == expected));
+  }
+}
+
+template <uint32_t digitBits, uint32_t w, bool s> void checkValues() {
+  for (size_t count : { 0, 1, 2, 1000, 50000 }) {
+    vector<Value<w, s>> values(count);
+    for (auto& value : values)
+      value = randomValue<w, s>();
+    auto expected = values;
+    sort(expected.begin(), expected.end(),
+         [](auto const& a, auto const& b) { return a < b; });
+    radixSort<digitBits>(values);
+    BOOST_REQUIRE((values == expected));
+  }
+}
+} // namespace
+
+static_assert(sortingNetwork<8>.size() == 19, "Wrong network size");
+static_assert(sortingNetwork<16>.size() == 63, "Wrong network size");
+
+BOOST_AUTO_TEST_CASE(NetworkSortsAllBinaryInputs) {
+  checkNetwork<1>();
+  checkNetwork<2>();
+  checkNetwork<3>();
+  checkNetwork<5>();
+  checkNetwork<7>();
+  checkNetwork<8>();
+  checkNetwork<12>();
+  checkNetwork<16>();
+}
+
+BOOST_AUTO_TEST_CASE(NetworkSortValues) {
+  checkRandomNetwork<4, 13, true>();
+  checkRandomNetwork<6, 64, false>();
+  checkRandomNetwork<11, 70, true>();
+  checkRandomNetwork<32, 200, true>();
+
+  constexpr auto sorted = [] {
+    array<Value<8, true>, 5> values { Value<8, true> { 3 },
+                                      Value<8, true> { -128 },
+                                      Value<8, true> { 127 },
+                                      Value<8, true> { -1 },
+                                      Value<8, true> { 0 } };
+    networkSort(values);
+    return values;
+  }();
+  static_assert(sorted[0] == Value<8, true> { -128 } &&
+                sorted[4] == Value<8, true> { 127 });
+}
+
+BOOST_AUTO_TEST_CASE(RadixSortValues) {
+  checkValues<8, 7, false>();
+  checkValues<8, 37, true>();
+  checkValues<11, 64, true>();
+  checkValues<12, 64, false>();
+  checkValues<8, 150, true>();
+  checkValues<1, 9, true>();
+}
+
+BOOST_AUTO_TEST_CASE(RadixSortRecordsIsStable) {
+  for (size_t count : { 1, 1000, 100000 }) {
+    auto records = randomRecords(count);
+    auto const expected = stableSorted(records);
+    radixSort(records, fieldKey);
+    BOOST_REQUIRE(sameRecords(records, expected));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParallelRadixSort) {
+  ThreadPool pool { 4 };
+  for (size_t count : { 10, 100000, 500000 }) {
+    auto records = randomRecords(count);
+    auto const expected = stableSorted(records);
+    radixSort<11>(pool, records, fieldKey);
+    BOOST_REQUIRE(sameRecords(records, expected));
+  }
+
+  vector<Value<45, true>> values(300000);
+  for (auto& value : values)
+    value = randomValue<45, true>();
+  auto expected = values;
+  radixSort(expected);
+  radixSort(pool, values);
+  BOOST_REQUIRE(values == expected);
+}
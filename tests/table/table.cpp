@@ -0,0 +1,91 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Table
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "apintext.hpp"
+#include "common/random.hpp"
+
+using namespace std;
+
+using namespace apintext;
+using namespace test;
+
+namespace {
+constexpr Placeholder<0, 5, false> a;
+constexpr Placeholder<1, 4, true> b;
+constexpr auto shape = (a * b + Value<3, false> { 5 }) /
+                       (zeroExtendToWidth<6>(a) + Value<1, false> { 1 });
+constexpr auto table = tabulate(shape);
+constexpr auto packedTable = tabulate<true>(shape);
+
+static_assert(decltype(table)::width == decltype(shape)::width &&
+                  decltype(table)::signedness == decltype(shape)::signedness,
+              "Tables should keep the format of the tabulated expression");
+static_assert(decltype(table)::entryCount == 512, "Wrong table size");
+
+/// Tables should match the tabulated expression on all their inputs
+template <typename Table> void checkExhaustive(Table const& lut) {
+  for (uint32_t i = 0; i < 32; ++i) {
+    for (int32_t j = -8; j < 8; ++j) {
+      Value<5, false> const aVal { i };
+      Value<4, true> const bVal { j };
+      BOOST_REQUIRE((substitute(lut, aVal, bVal).compute() ==
+                     substitute(shape, aVal, bVal).compute()));
+    }
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ConstantTable) {
+  static_assert(substitute(table, Value<5, false> { 19 }, Value<4, true> { -3 })
+                        .compute() ==
+                    substitute(shape, Value<5, false> { 19 },
+                               Value<4, true> { -3 })
+                        .compute(),
+                "Table lookups should be constant expressions");
+  checkExhaustive(table);
+  checkExhaustive(packedTable);
+  BOOST_REQUIRE((table.compute() == shape.compute()));
+}
+
+BOOST_AUTO_TEST_CASE(PackedStorage) {
+  static_assert(sizeof(packedTable) < sizeof(table),
+                "Packed entries should take less space");
+  constexpr Placeholder<0, 3, false> x;
+  constexpr Placeholder<1, 2, false> y;
+  constexpr auto lut = tabulate<true>(x + y);
+  for (uint32_t i = 0; i < 8; ++i) {
+    for (uint32_t j = 0; j < 4; ++j) {
+      auto const sum =
+          substitute(lut, Value<3, false> { i }, Value<2, false> { j });
+      BOOST_REQUIRE((sum.compute() == ap_repr<4, false> { i + j }));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchLookup) {
+  Placeholder<0, 8, false> x;
+  Placeholder<1, 8, true> y;
+  auto const mixed = (x * y - Value<9, true> { 200 }) %
+                     (slice<7, 0>(y) | Value<8, false> { 1 });
+  auto const lut = make_unique<LookupTable<decltype(mixed), true>>(mixed);
+  static_assert(decltype(mixed)::width < 64,
+                "Expression should not need a full word");
+
+  size_t const count = 1000;
+  vector<uint32_t> xs(count);
+  vector<Value<8, true>> ys(count);
+  for (size_t i = 0; i < count; ++i) {
+    xs[i] = static_cast<uint32_t>(next() % 256);
+    ys[i] = uniformValue<8, true>();
+  }
+  vector<res_t<decltype(mixed)>> expected(count), looked(count);
+  evaluate(mixed, xs, ys, expected);
+  evaluate(*lut, xs, ys, looked);
+  BOOST_REQUIRE(looked == expected);
+}